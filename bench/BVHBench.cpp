@@ -0,0 +1,156 @@
+#include <random>
+
+#include "Benchmark.h"
+
+#include "BVH.h"
+#include "FrustumCulling.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// 50k boxes scattered through a 1000 unit cube; the camera at the center sees a few percent of them
+static const size_t BVH_BENCH_OBJECTS = 50000;
+
+static CullingBounds bvhBenchBounds() {
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	CullingBounds bounds;
+	bounds.Resize(BVH_BENCH_OBJECTS);
+	for (size_t i = 0; i < BVH_BENCH_OBJECTS; i++) {
+		glm::vec3 center(position(rng), position(rng), position(rng));
+		glm::vec3 extent(size(rng), size(rng), size(rng));
+		bounds.SetAABB(i, center - extent, center + extent);
+	}
+	return bounds;
+}
+
+static Frustum bvhBenchFrustum() {
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+	return Frustum::FromMatrix(proj * view);
+}
+
+// Moves every object a little, as a frame of a dynamic scene would
+static void driftBounds(CullingBounds& bounds, std::mt19937& rng) {
+	std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+	for (size_t i = 0; i < bounds.Size(); i++) {
+		bounds.centerX[i] += step(rng);
+		bounds.centerY[i] += step(rng);
+		bounds.centerZ[i] += step(rng);
+	}
+}
+
+static void reportTree(BenchmarkRun& run, const BVH& bvh) {
+	run.Counter("objects", (double)BVH_BENCH_OBJECTS);
+	run.Counter("nodes", (double)bvh.stats.nodes);
+	run.Counter("depth", bvh.stats.depth);
+	run.Counter("sah_cost", bvh.stats.cost);
+}
+
+// Full SAH build
+BENCHMARK(bvh_build, 10) {
+	CullingBounds bounds = bvhBenchBounds();
+	BVH bvh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		bvh.Build(bounds);
+		run.End();
+	}
+	reportTree(run, bvh);
+}
+
+// Refit after every object moved
+BENCHMARK(bvh_refit, 20) {
+	CullingBounds bounds = bvhBenchBounds();
+	BVH bvh;
+	bvh.Build(bounds);
+	std::mt19937 rng(1);
+	for (int i = 0; i < run.iterations; i++) {
+		driftBounds(bounds, rng);
+		run.Begin();
+		bvh.Refit(bounds);
+		run.End();
+	}
+	reportTree(run, bvh);
+	run.Counter("cost_growth", bvh.stats.cost / bvh.stats.builtCost);
+}
+
+// Update() over many frames of drifting objects: mostly refits, with a rebuild whenever the tree got
+// too loose
+BENCHMARK(bvh_update_drifting, 100) {
+	CullingBounds bounds = bvhBenchBounds();
+	BVH bvh;
+	bvh.Build(bounds);
+	std::mt19937 rng(1);
+	unsigned int rebuilds = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		driftBounds(bounds, rng);
+		run.Begin();
+		rebuilds += bvh.Update(bounds) ? 1 : 0;
+		run.End();
+	}
+	reportTree(run, bvh);
+	run.Counter("rebuilds", rebuilds);
+}
+
+// Baseline for bvh_cull: FrustumCull() testing every box
+BENCHMARK(bvh_cull_flat, 50) {
+	CullingBounds bounds = bvhBenchBounds();
+	Frustum frustum = bvhBenchFrustum();
+	std::vector<uint32_t> visible(bounds.PaddedSize());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = FrustumCull(frustum, bounds, CullShape::AABB, visible.data());
+		run.End();
+	}
+	run.Counter("objects", (double)BVH_BENCH_OBJECTS);
+	run.Counter("visible", (double)count);
+}
+
+// Frustum culling through the tree
+BENCHMARK(bvh_cull, 50) {
+	CullingBounds bounds = bvhBenchBounds();
+	Frustum frustum = bvhBenchFrustum();
+	BVH bvh;
+	bvh.Build(bounds);
+	std::vector<uint32_t> visible(bounds.Size());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = bvh.Cull(frustum, bounds, visible.data());
+		run.End();
+	}
+	reportTree(run, bvh);
+	run.Counter("visible", (double)count);
+}
+
+// 10k picking rays from random points in random directions
+BENCHMARK(bvh_raycast, 20) {
+	const int rays = 10000;
+	CullingBounds bounds = bvhBenchBounds();
+	BVH bvh;
+	bvh.Build(bounds);
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+	std::vector<glm::vec3> origins, directions;
+	for (int r = 0; r < rays; r++) {
+		origins.push_back(glm::vec3(position(rng), position(rng), position(rng)));
+		directions.push_back(glm::normalize(glm::vec3(direction(rng), direction(rng), direction(rng)) + glm::vec3(0.0f, 0.0f, 1e-3f)));
+	}
+	int hits = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		hits = 0;
+		run.Begin();
+		for (int r = 0; r < rays; r++) {
+			RayHit hit;
+			hits += bvh.Raycast(origins[r], directions[r], bounds, 2000.0f, hit) ? 1 : 0;
+		}
+		run.End();
+	}
+	reportTree(run, bvh);
+	run.Counter("rays", rays);
+	run.Counter("hits", hits);
+	run.Counter("mrays_per_s", rays / (run.timer.Median() * 1000.0));
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "GLState.h"
+#include "HeadlessContext.h"
+
+// Benchmark runner
+// Usage: OpenGLEngineBench [--list] [--filter TEXT] [--iterations N] [--out FILE]
+//                          [--baseline FILE] [--threshold PERCENT] [--no-dsa]
+int main(int argc, char **argv)
+{
+	const char *filter = nullptr;
+	const char *outFile = "bench_results.json";
+	const char *baselineFile = nullptr;
+	double threshold = 10.0;
+	int iterations = 0;
+	bool list = false;
+	bool directStateAccess = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--list") == 0)
+			list = true;
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			iterations = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outFile = argv[++i];
+		else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baselineFile = argv[++i];
+		else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+			threshold = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--no-dsa") == 0)
+			directStateAccess = false;
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--list] [--filter TEXT] [--iterations N] [--out FILE] [--baseline FILE] [--threshold PERCENT] [--no-dsa]" << std::endl;
+			return -1;
+		}
+	}
+
+	if (list)
+	{
+		for (const BenchmarkInfo &info : BenchmarkRegistry())
+			std::cout << info.name << "\n";
+		return 0;
+	}
+
+	// All benchmarks share one offscreen context
+	HeadlessContext context;
+	if (!context.Create(256, 256))
+		return -1;
+	GLState::Get().SetDirectStateAccess(directStateAccess);
+
+	std::vector<BenchmarkResult> results;
+	for (const BenchmarkInfo &info : BenchmarkRegistry())
+	{
+		if (filter && info.name.find(filter) == std::string::npos)
+			continue;
+
+		BenchmarkRun run(iterations > 0 ? iterations : info.iterations);
+		info.function(run);
+		glFinish();
+
+		BenchmarkResult result = SummarizeBenchmark(info.name, run);
+		results.push_back(result);
+
+		std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed << std::setprecision(4)
+				  << " min " << std::setw(10) << result.minMs
+				  << " median " << std::setw(10) << result.medianMs
+				  << " p99 " << std::setw(10) << result.p99Ms << " ms";
+		std::cout.unsetf(std::ios::fixed);
+		for (const std::pair<std::string, double> &counter : result.counters)
+			std::cout << "  " << counter.first << "=" << counter.second;
+		std::cout << std::endl;
+	}
+
+	context.Delete();
+
+	if (!WriteBenchmarkJSON(outFile, results))
+		return -1;
+	std::cout << "Wrote " << outFile << std::endl;
+
+	// Compare against a previously saved report and fail if anything regressed
+	if (baselineFile)
+	{
+		std::vector<BenchmarkResult> baseline;
+		if (!ReadBenchmarkJSON(baselineFile, baseline))
+			return -1;
+		int regressions = CompareBenchmarks(results, baseline, threshold);
+		if (regressions > 0)
+		{
+			std::cout << regressions << " benchmark(s) regressed" << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef BENCH_SCENE_H
+#define BENCH_SCENE_H
+
+#include <glad/glad.h>
+#include <vector>
+
+// The pyramid from main.cpp, shared by benchmarks that need real geometry
+// Format: x, y, z, r, g, b, u, v
+inline GLfloat benchPyramidVertices[] = {
+	-0.5f, 0.0f,  0.5f,  0.83f, 0.70f, 0.44f,  0.0f, 0.0f,
+	-0.5f, 0.0f, -0.5f,  0.83f, 0.70f, 0.44f,  5.0f, 0.0f,
+	 0.5f, 0.0f, -0.5f,  0.83f, 0.70f, 0.44f,  0.0f, 0.0f,
+	 0.5f, 0.0f,  0.5f,  0.83f, 0.70f, 0.44f,  5.0f, 0.0f,
+	 0.0f, 0.8f,  0.0f,  0.92f, 0.86f, 0.76f,  2.5f, 5.0f,
+};
+
+inline GLuint benchPyramidIndices[] = {
+	0, 1, 2,
+	0, 2, 3,
+	0, 1, 4,
+	1, 2, 4,
+	2, 3, 4,
+	3, 0, 4
+};
+
+// Pixels of the 256x256 bench framebuffer not showing the clear color, to check that two
+// submission paths drew the same image
+inline int benchCoveredPixels() {
+	std::vector<unsigned char> pixels(256 * 256 * 4);
+	glReadPixels(0, 0, 256, 256, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	int covered = 0;
+	for (size_t p = 0; p < pixels.size(); p += 4) {
+		covered += pixels[p] | pixels[p + 1] | pixels[p + 2] ? 1 : 0;
+	}
+	return covered;
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+BenchmarkRun::BenchmarkRun(int iterations) {
+	BenchmarkRun::iterations = iterations;
+	timer.samples.reserve(iterations);
+}
+
+// Marks the start of a measured iteration
+void BenchmarkRun::Begin() {
+	timer.Begin();
+}
+
+// Marks the end of a measured iteration
+void BenchmarkRun::End() {
+	timer.End();
+}
+
+// Records (or overwrites) a named counter
+void BenchmarkRun::Counter(const std::string& name, double value) {
+	for (std::pair<std::string, double>& counter : counters) {
+		if (counter.first == name) {
+			counter.second = value;
+			return;
+		}
+	}
+	counters.push_back({ name, value });
+}
+
+// All benchmarks registered in this executable
+std::vector<BenchmarkInfo>& BenchmarkRegistry() {
+	static std::vector<BenchmarkInfo> registry;
+	return registry;
+}
+
+// Adds a benchmark to the registry during static initialization
+BenchmarkRegistrar::BenchmarkRegistrar(const char* name, BenchmarkFunction function, int iterations) {
+	BenchmarkRegistry().push_back({ name, function, iterations });
+}
+
+// Summarizes a finished run
+BenchmarkResult SummarizeBenchmark(const std::string& name, const BenchmarkRun& run) {
+	BenchmarkResult result;
+	result.name = name;
+	result.iterations = (int)run.timer.samples.size();
+	result.minMs = run.timer.Min();
+	result.medianMs = run.timer.Median();
+	result.p99Ms = run.timer.Percentile(99.0);
+	result.meanMs = run.timer.Mean();
+	result.maxMs = run.timer.Max();
+	result.counters = run.counters;
+	return result;
+}
+
+// Writes results as JSON
+bool WriteBenchmarkJSON(const char* filename, const std::vector<BenchmarkResult>& results) {
+	std::ofstream out(filename);
+	if (!out) {
+		std::cerr << "Failed to open benchmark output: " << filename << std::endl;
+		return false;
+	}
+
+	out << std::setprecision(6) << "{\n  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& r = results[i];
+		out << "    {\n"
+			<< "      \"name\": \"" << r.name << "\",\n"
+			<< "      \"iterations\": " << r.iterations << ",\n"
+			<< "      \"min_ms\": " << r.minMs << ",\n"
+			<< "      \"median_ms\": " << r.medianMs << ",\n"
+			<< "      \"p99_ms\": " << r.p99Ms << ",\n"
+			<< "      \"mean_ms\": " << r.meanMs << ",\n"
+			<< "      \"max_ms\": " << r.maxMs << ",\n"
+			<< "      \"counters\": {";
+		for (size_t c = 0; c < r.counters.size(); c++) {
+			out << (c ? ", " : " ") << "\"" << r.counters[c].first << "\": " << r.counters[c].second;
+		}
+		out << (r.counters.empty() ? "}\n" : " }\n")
+			<< "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+	return true;
+}
+
+// Returns the number following "key": inside object, or 0 if missing
+static double readNumber(const std::string& object, const char* key) {
+	size_t pos = object.find(std::string("\"") + key + "\"");
+	if (pos == std::string::npos) {
+		return 0.0;
+	}
+	pos = object.find(':', pos);
+	return pos == std::string::npos ? 0.0 : std::strtod(object.c_str() + pos + 1, NULL);
+}
+
+// Reads name/timing pairs back from a JSON report written by WriteBenchmarkJSON
+bool ReadBenchmarkJSON(const char* filename, std::vector<BenchmarkResult>& results) {
+	std::ifstream in(filename);
+	if (!in) {
+		std::cerr << "Failed to open benchmark baseline: " << filename << std::endl;
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << in.rdbuf();
+	std::string json = buffer.str();
+
+	// Every benchmark object starts with its "name" key; its fields run until the next one
+	const std::string nameKey = "\"name\"";
+	size_t pos = json.find(nameKey);
+	while (pos != std::string::npos) {
+		size_t next = json.find(nameKey, pos + nameKey.size());
+		std::string object = json.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+
+		size_t open = object.find('"', object.find(':'));
+		size_t close = object.find('"', open + 1);
+		if (open == std::string::npos || close == std::string::npos) {
+			return false;
+		}
+
+		BenchmarkResult result;
+		result.name = object.substr(open + 1, close - open - 1);
+		result.iterations = (int)readNumber(object, "iterations");
+		result.minMs = readNumber(object, "min_ms");
+		result.medianMs = readNumber(object, "median_ms");
+		result.p99Ms = readNumber(object, "p99_ms");
+		result.meanMs = readNumber(object, "mean_ms");
+		result.maxMs = readNumber(object, "max_ms");
+		results.push_back(result);
+
+		pos = next;
+	}
+	return true;
+}
+
+// Prints a comparison against a baseline and returns the number of regressions
+int CompareBenchmarks(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent) {
+	int regressions = 0;
+	std::cout << "\nComparison against baseline (threshold " << thresholdPercent << "% on median):\n";
+	for (const BenchmarkResult& result : results) {
+		const BenchmarkResult* base = nullptr;
+		for (const BenchmarkResult& candidate : baseline) {
+			if (candidate.name == result.name) {
+				base = &candidate;
+			}
+		}
+		if (base == nullptr || base->medianMs <= 0.0) {
+			std::cout << "  " << std::left << std::setw(28) << result.name << " (no baseline)\n";
+			continue;
+		}
+
+		double change = (result.medianMs - base->medianMs) / base->medianMs * 100.0;
+		bool regressed = change > thresholdPercent;
+		regressions += regressed;
+		std::cout << "  " << std::left << std::setw(28) << result.name
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << base->medianMs << " ms -> " << std::setw(10) << result.medianMs << " ms  "
+			<< std::showpos << std::setprecision(1) << change << "%" << std::noshowpos
+			<< (regressed ? "  REGRESSION" : "") << "\n";
+		std::cout.unsetf(std::ios::fixed);
+	}
+	std::cout << std::flush;
+	return regressions;
+}
@@ -0,0 +1,82 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "FrameTimer.h"
+
+// State handed to a benchmark: call Begin()/End() around the measured part of every iteration
+class BenchmarkRun {
+public:
+	// Number of measured iterations to run
+	int iterations;
+
+	// Per-iteration timings
+	FrameTimer timer;
+
+	// Extra values reported next to the timings (items processed, state changes, ...)
+	std::vector<std::pair<std::string, double>> counters;
+
+	BenchmarkRun(int iterations);
+
+	// Marks the start of a measured iteration
+	void Begin();
+
+	// Marks the end of a measured iteration
+	void End();
+
+	// Records (or overwrites) a named counter
+	void Counter(const std::string& name, double value);
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkRun& run);
+
+// Named benchmark registered with BENCHMARK()
+struct BenchmarkInfo {
+	std::string name;
+	BenchmarkFunction function;
+	int iterations;
+};
+
+// All benchmarks registered in this executable
+std::vector<BenchmarkInfo>& BenchmarkRegistry();
+
+// Adds a benchmark to the registry during static initialization
+struct BenchmarkRegistrar {
+	BenchmarkRegistrar(const char* name, BenchmarkFunction function, int iterations);
+};
+
+// Declares and registers a benchmark function: BENCHMARK(texture_load, 20) { ... }
+#define BENCHMARK(name, iterations) \
+	static void name(BenchmarkRun& run); \
+	static BenchmarkRegistrar name##_registrar(#name, name, iterations); \
+	static void name(BenchmarkRun& run)
+
+// Result of one benchmark, as written to / read from the JSON report
+struct BenchmarkResult {
+	std::string name;
+	int iterations = 0;
+	double minMs = 0.0;
+	double medianMs = 0.0;
+	double p99Ms = 0.0;
+	double meanMs = 0.0;
+	double maxMs = 0.0;
+	std::vector<std::pair<std::string, double>> counters;
+};
+
+// Summarizes a finished run
+BenchmarkResult SummarizeBenchmark(const std::string& name, const BenchmarkRun& run);
+
+// Writes results as JSON
+bool WriteBenchmarkJSON(const char* filename, const std::vector<BenchmarkResult>& results);
+
+// Reads name/median pairs back from a JSON report written by WriteBenchmarkJSON
+bool ReadBenchmarkJSON(const char* filename, std::vector<BenchmarkResult>& results);
+
+// Prints a comparison against a baseline and returns the number of benchmarks whose median
+// regressed by more than thresholdPercent
+int CompareBenchmarks(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent);
+
+#endif
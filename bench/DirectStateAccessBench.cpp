@@ -0,0 +1,120 @@
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "GLState.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// Selects the object backend for one benchmark and restores the runner's choice afterwards
+struct BackendScope {
+	bool previous;
+
+	BackendScope(bool directStateAccess) : previous(GLState::Get().DirectStateAccess()) {
+		GLState::Get().SetDirectStateAccess(directStateAccess);
+		GLState::Get().ResetStats();
+	}
+	~BackendScope() { GLState::Get().SetDirectStateAccess(previous); }
+};
+
+// Creates, links and deletes 1000 VAO/VBO/EBO sets of the pyramid
+static void createBuffers(BenchmarkRun& run, bool directStateAccess) {
+	const int MESHES = 1000;
+	BackendScope scope(directStateAccess);
+	for (int i = 0; i < run.iterations; i++) {
+		std::vector<VAO> vaos;
+		std::vector<VBO> vbos;
+		std::vector<EBO> ebos;
+		run.Begin();
+		for (int m = 0; m < MESHES; m++) {
+			vaos.emplace_back();
+			vaos.back().Bind();
+			vbos.emplace_back(benchPyramidVertices, sizeof(benchPyramidVertices));
+			ebos.emplace_back(benchPyramidIndices);
+			vaos.back().LinkAttrib(vbos.back(), 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+			vaos.back().LinkAttrib(vbos.back(), 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+			vaos.back().LinkAttrib(vbos.back(), 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		}
+		vaos.back().Unbind();
+		glFinish();
+		run.End();
+		for (int m = 0; m < MESHES; m++) {
+			vaos[m].Delete();
+			vbos[m].Delete();
+			ebos[m].Delete();
+		}
+	}
+	run.Counter("meshes", MESHES);
+	run.Counter("gl_state_calls_per_mesh", (double)GLState::Get().stats.issued / (run.iterations * MESHES));
+}
+
+BENCHMARK(gl_objects_create_bind, 10) {
+	createBuffers(run, false);
+}
+
+BENCHMARK(gl_objects_create_dsa, 10) {
+	run.Counter("dsa", GLState::Get().DirectStateAccess());
+	createBuffers(run, GLState::Get().DirectStateAccess());
+}
+
+// Rewrites 64 bytes in each of 256 buffers, 20 rounds per iteration; bind-to-edit has to re-bind
+// GL_ARRAY_BUFFER before every update since consecutive updates hit different buffers
+static void updateBuffers(BenchmarkRun& run, bool directStateAccess) {
+	const int BUFFERS = 256, ROUNDS = 20;
+	BackendScope scope(directStateAccess);
+	std::vector<unsigned char> zeros(4096, 0);
+	std::vector<VBO> vbos;
+	for (int b = 0; b < BUFFERS; b++) {
+		vbos.emplace_back(zeros.data(), (GLsizeiptr)zeros.size());
+	}
+	float payload[16] = {};
+	GLState::Get().ResetStats();
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int round = 0; round < ROUNDS; round++) {
+			for (int b = 0; b < BUFFERS; b++) {
+				payload[0] = (float)(round + b);
+				vbos[b].Update((GLintptr)((round * 64) % 4096), sizeof(payload), payload);
+			}
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("updates", BUFFERS * ROUNDS);
+	run.Counter("gl_state_calls_per_update", (double)GLState::Get().stats.issued / (run.iterations * BUFFERS * ROUNDS));
+	for (VBO& vbo : vbos) {
+		vbo.Delete();
+	}
+}
+
+BENCHMARK(gl_objects_update_bind, 20) {
+	updateBuffers(run, false);
+}
+
+BENCHMARK(gl_objects_update_dsa, 20) {
+	updateBuffers(run, GLState::Get().DirectStateAccess());
+}
+
+// Loads, uploads and mipmaps a texture (the image decode is the same for both paths)
+static void createTextures(BenchmarkRun& run, bool directStateAccess) {
+	BackendScope scope(directStateAccess);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		Texture texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+		glFinish();
+		run.End();
+		texture.Delete();
+	}
+	run.Counter("gl_state_calls", (double)GLState::Get().stats.issued / run.iterations);
+}
+
+BENCHMARK(gl_objects_texture_bind, 10) {
+	createTextures(run, false);
+}
+
+BENCHMARK(gl_objects_texture_dsa, 10) {
+	createTextures(run, GLState::Get().DirectStateAccess());
+}
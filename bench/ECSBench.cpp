@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <random>
+
+#include "Benchmark.h"
+
+#include "ECS.h"
+#include "FrustumCulling.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Components of a typical scene
+struct Position { glm::vec3 value; };
+struct Velocity { glm::vec3 value; };
+struct Spin { float angle; float rate; };
+struct Transform { glm::mat4 model; };
+struct Bounds { float radius; };
+struct Renderable { uint32_t mesh; uint32_t material; uint32_t visible; };
+struct Selected { uint32_t frame; };
+
+// 100k entities in three archetypes, spread through a 1000 unit cube: half are moving props, 30%
+// static props (no Velocity) and 20% particles that are never drawn
+static const size_t ECS_BENCH_ENTITIES = 100000;
+static const float ECS_BENCH_DT = 1.0f / 60.0f;
+
+static Entity createBenchEntity(EntityWorld& world, size_t i, std::mt19937& rng) {
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	Position p{ glm::vec3(position(rng), position(rng), position(rng)) };
+	Velocity v{ glm::vec3(unit(rng), unit(rng), unit(rng)) };
+	Renderable r{ (uint32_t)(i % 16), (uint32_t)(i % 7), 0 };
+	switch (i % 10) {
+	case 0: case 1: case 2: case 3: case 4:
+		return world.Create(p, v, Spin{ 0.0f, unit(rng) }, Transform{}, Bounds{ 2.0f }, r);
+	case 5: case 6: case 7:
+		return world.Create(p, Spin{ 0.0f, 0.0f }, Transform{}, Bounds{ 2.0f }, r);
+	default:
+		return world.Create(p, v);
+	}
+}
+
+static std::vector<Entity> ecsBenchWorld(EntityWorld& world) {
+	std::mt19937 rng(9);
+	std::vector<Entity> entities;
+	for (size_t i = 0; i < ECS_BENCH_ENTITIES; i++) {
+		entities.push_back(createBenchEntity(world, i, rng));
+	}
+	return entities;
+}
+
+static Frustum ecsBenchFrustum() {
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	return Frustum::FromMatrix(proj * view);
+}
+
+// Movement system: integrates velocities over one chunk
+static void moveChunk(size_t count, const Entity*, Position* positions, const Velocity* velocities) {
+	for (size_t i = 0; i < count; i++) {
+		positions[i].value += velocities[i].value * ECS_BENCH_DT;
+	}
+}
+
+// Transform system: spins every entity about y and rebuilds its model matrix
+static void transformChunk(size_t count, const Entity*, const Position* positions, Spin* spins, Transform* transforms) {
+	for (size_t i = 0; i < count; i++) {
+		spins[i].angle += spins[i].rate * ECS_BENCH_DT;
+		float s = std::sin(spins[i].angle), c = std::cos(spins[i].angle);
+		transforms[i].model = glm::mat4(glm::vec4(c, 0.0f, -s, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f), glm::vec4(s, 0.0f, c, 0.0f),
+			glm::vec4(positions[i].value, 1.0f));
+	}
+}
+
+// Culling system: flags the renderables whose bounding sphere touches the frustum
+static void cullChunk(const Frustum& frustum, size_t count, const Transform* transforms, const Bounds* bounds, Renderable* renderables) {
+	for (size_t i = 0; i < count; i++) {
+		renderables[i].visible = frustum.IntersectsSphere(glm::vec3(transforms[i].model[3]), bounds[i].radius) ? 1 : 0;
+	}
+}
+
+// Render list system: one sort key per visible renderable, mesh and material in the high bits
+static void buildRenderList(EntityWorld& world, std::vector<uint64_t>& renderList) {
+	renderList.clear();
+	world.EachChunk<const Renderable>([&](size_t count, const Entity* entities, const Renderable* renderables) {
+		for (size_t i = 0; i < count; i++) {
+			if (renderables[i].visible) {
+				renderList.push_back((uint64_t)renderables[i].material << 48 | (uint64_t)renderables[i].mesh << 32 | entities[i]);
+			}
+		}
+	});
+}
+
+// The moving props' data as an engine without an ECS would keep it: one object per entity with
+// everything in it, whether a loop needs it or not
+struct GameObject {
+	glm::vec3 position;
+	glm::vec3 velocity;
+	float angle, rate;
+	glm::mat4 model;
+	float radius;
+	uint32_t mesh, material, visible;
+	bool moving;
+	char name[32];
+};
+
+// Movement system over all 70k moving entities (moving props and particles, two archetypes)
+BENCHMARK(ecs_iterate, 100) {
+	EntityWorld world;
+	ecsBenchWorld(world);
+	size_t moved = 0;
+	world.Each<const Velocity>([&](const Velocity&) { moved++; });
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		world.EachChunk<Position, const Velocity>(moveChunk);
+		run.End();
+	}
+	run.Counter("entities", (double)moved);
+	run.Counter("chunks", (double)world.stats.chunks);
+	run.Counter("mentities_per_s", moved / (run.timer.Median() * 1000.0));
+}
+
+// The same through Each(), one call per entity
+BENCHMARK(ecs_iterate_each, 100) {
+	EntityWorld world;
+	ecsBenchWorld(world);
+	size_t moved = 0;
+	world.Each<const Velocity>([&](const Velocity&) { moved++; });
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		world.Each<Position, const Velocity>([](Position& p, const Velocity& v) { p.value += v.value * ECS_BENCH_DT; });
+		run.End();
+	}
+	run.Counter("entities", (double)moved);
+	run.Counter("mentities_per_s", moved / (run.timer.Median() * 1000.0));
+}
+
+// Baseline for ecs_iterate: the same update over an array of GameObjects
+BENCHMARK(ecs_iterate_object_array, 100) {
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::vector<GameObject> objects(ECS_BENCH_ENTITIES);
+	for (size_t i = 0; i < objects.size(); i++) {
+		objects[i].position = glm::vec3(position(rng), position(rng), position(rng));
+		objects[i].velocity = glm::vec3(0.5f);
+		objects[i].moving = i % 10 < 5 || i % 10 > 7;
+	}
+	size_t moved = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		moved = 0;
+		run.Begin();
+		for (GameObject& object : objects) {
+			if (object.moving) {
+				object.position += object.velocity * ECS_BENCH_DT;
+				moved++;
+			}
+		}
+		run.End();
+	}
+	run.Counter("entities", (double)moved);
+	run.Counter("mentities_per_s", moved / (run.timer.Median() * 1000.0));
+}
+
+// ecs_iterate with the chunks spread across a pool
+BENCHMARK(ecs_iterate_parallel, 100) {
+	EntityWorld world;
+	ecsBenchWorld(world);
+	ThreadPool pool;
+	size_t moved = 0;
+	world.Each<const Velocity>([&](const Velocity&) { moved++; });
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		world.ParallelEachChunk<Position, const Velocity>(&pool, moveChunk);
+		run.End();
+	}
+	run.Counter("entities", (double)moved);
+	run.Counter("mentities_per_s", moved / (run.timer.Median() * 1000.0));
+	run.Counter("threads", (double)pool.Size() + 1);
+}
+
+// A frame of systems: movement, transforms, frustum culling and the render list
+static void ecsBenchFrame(BenchmarkRun& run, ThreadPool* pool) {
+	EntityWorld world;
+	ecsBenchWorld(world);
+	Frustum frustum = ecsBenchFrustum();
+	std::vector<uint64_t> renderList;
+	renderList.reserve(ECS_BENCH_ENTITIES);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		world.ParallelEachChunk<Position, const Velocity>(pool, moveChunk);
+		world.ParallelEachChunk<const Position, Spin, Transform>(pool, transformChunk);
+		world.ParallelEachChunk<const Transform, const Bounds, Renderable>(pool, [&](size_t count, const Entity*, const Transform* transforms, const Bounds* bounds, Renderable* renderables) {
+			cullChunk(frustum, count, transforms, bounds, renderables);
+		});
+		buildRenderList(world, renderList);
+		run.End();
+	}
+	run.Counter("entities", (double)world.Size());
+	run.Counter("archetypes", (double)world.stats.archetypes);
+	run.Counter("visible", (double)renderList.size());
+	run.Counter("ns_per_entity", run.timer.Median() * 1e6 / (double)world.Size());
+}
+
+BENCHMARK(ecs_frame_systems, 50) {
+	ecsBenchFrame(run, nullptr);
+}
+
+// The same with every system but the render list on a pool
+BENCHMARK(ecs_frame_systems_parallel, 50) {
+	ThreadPool pool;
+	ecsBenchFrame(run, &pool);
+	run.Counter("threads", (double)pool.Size() + 1);
+}
+
+// Creating the 100k entities into an empty world
+BENCHMARK(ecs_create, 20) {
+	size_t chunks = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		EntityWorld world;
+		run.Begin();
+		ecsBenchWorld(world);
+		run.End();
+		chunks = world.stats.chunks;
+	}
+	run.Counter("entities", (double)ECS_BENCH_ENTITIES);
+	run.Counter("chunks", (double)chunks);
+	run.Counter("mentities_per_s", ECS_BENCH_ENTITIES / (run.timer.Median() * 1000.0));
+}
+
+// Churn: every iteration destroys 10% of the live entities at random and creates as many new ones
+BENCHMARK(ecs_churn, 50) {
+	EntityWorld world;
+	std::vector<Entity> entities = ecsBenchWorld(world);
+	std::mt19937 rng(13);
+	const size_t churn = ECS_BENCH_ENTITIES / 10;
+	size_t next = ECS_BENCH_ENTITIES;
+	for (int i = 0; i < run.iterations; i++) {
+		std::shuffle(entities.begin(), entities.end(), rng);
+		run.Begin();
+		for (size_t e = entities.size() - churn; e < entities.size(); e++) {
+			world.Destroy(entities[e]);
+		}
+		for (size_t e = entities.size() - churn; e < entities.size(); e++) {
+			entities[e] = createBenchEntity(world, next++, rng);
+		}
+		run.End();
+	}
+	run.Counter("entities", (double)world.Size());
+	run.Counter("churned", (double)churn);
+	run.Counter("chunks", (double)world.stats.chunks);
+	run.Counter("free_chunks", (double)world.stats.freeChunks);
+	run.Counter("mops_per_s", 2.0 * churn / (run.timer.Median() * 1000.0));
+}
+
+// Adding and then removing a component on 10k entities, each moving to another archetype and back
+BENCHMARK(ecs_add_remove, 50) {
+	EntityWorld world;
+	std::vector<Entity> entities = ecsBenchWorld(world);
+	entities.resize(ECS_BENCH_ENTITIES / 10);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (Entity entity : entities) {
+			world.Add(entity, Selected{ (uint32_t)i });
+		}
+		for (Entity entity : entities) {
+			world.Remove<Selected>(entity);
+		}
+		run.End();
+	}
+	run.Counter("entities", (double)entities.size());
+	run.Counter("archetypes", (double)world.stats.archetypes);
+	run.Counter("mmoves_per_s", 2.0 * entities.size() / (run.timer.Median() * 1000.0));
+}
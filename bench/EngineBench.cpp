@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "ShaderClass.h"
+#include "ProgramCache.h"
+#include "TextureClass.h"
+#include "TextureLoader.h"
+#include "CookedTexture.h"
+#include "BCnEncoder.h"
+#include "MipChain.h"
+#include "ThreadPool.h"
+#include "CameraClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// Decode + upload + mipmap of the demo texture
+BENCHMARK(texture_load, 20) {
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		Texture texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+		glFinish();
+		run.End();
+		texture.Delete();
+	}
+}
+
+// Encodes the demo texture to BC1 and BC7 on all cores
+BENCHMARK(bc_encode, 10) {
+	int width, height, channels;
+	unsigned char* rgba = stbi_load("textures/tao.png", &width, &height, &channels, STBI_rgb_alpha);
+	std::vector<unsigned char> bc1(BCImageBytes(BCFormat::BC1, width, height));
+	std::vector<unsigned char> bc7(BCImageBytes(BCFormat::BC7, width, height));
+	ThreadPool pool;
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		EncodeBCImage(BCFormat::BC1, rgba, width, height, bc1.data(), &pool);
+		EncodeBCImage(BCFormat::BC7, rgba, width, height, bc7.data(), &pool);
+		run.End();
+	}
+	run.Counter("megapixels", 2.0 * width * height / 1e6);
+	run.Counter("threads", pool.Size() + 1);
+	stbi_image_free(rgba);
+}
+
+// Largest per-channel difference between an RGBA8 image and its BCn encoding as decoded by the driver
+static int bcRoundTripError(GLenum glFormat, const unsigned char* rgba, const std::vector<unsigned char>& blocks, int width, int height) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glCompressedTexImage2D(GL_TEXTURE_2D, 0, glFormat, width, height, 0, (GLsizei)blocks.size(), blocks.data());
+	std::vector<unsigned char> decoded((size_t)width * height * 4);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.data());
+	glDeleteTextures(1, &texture);
+
+	int worst = 0;
+	int channels = glFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 3 : 4;
+	for (int i = 0; i < width * height; i++) {
+		for (int c = 0; c < channels; c++) {
+			worst = std::max(worst, std::abs((int)decoded[i * 4 + c] - (int)rgba[i * 4 + c]));
+		}
+	}
+	return worst;
+}
+
+// Two-color checker blocks whose channels are anti-correlated (red/green, blue/yellow, ...), which a
+// principal axis fit can miss entirely; the error counters are the worst channel after decoding
+BENCHMARK(bc_encode_checkers, 1000) {
+	static const unsigned char colors[4][2][4] = {
+		{ { 255, 0, 0, 255 }, { 0, 255, 0, 255 } },
+		{ { 255, 0, 255, 255 }, { 0, 255, 0, 255 } },
+		{ { 0, 0, 255, 255 }, { 255, 255, 0, 255 } },
+		{ { 255, 0, 0, 0 }, { 0, 255, 255, 255 } }
+	};
+	const int width = 16, height = 4;
+	unsigned char rgba[width * height * 4];
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			std::memcpy(rgba + (y * width + x) * 4, colors[x / 4][(x + y) & 1], 4);
+		}
+	}
+	std::vector<unsigned char> bc1(BCImageBytes(BCFormat::BC1, width, height));
+	std::vector<unsigned char> bc7(BCImageBytes(BCFormat::BC7, width, height));
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		EncodeBCImage(BCFormat::BC1, rgba, width, height, bc1.data());
+		EncodeBCImage(BCFormat::BC7, rgba, width, height, bc7.data());
+		run.End();
+	}
+	run.Counter("bc1_max_error", bcRoundTripError(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, rgba, bc1, width, height));
+	run.Counter("bc7_max_error", bcRoundTripError(GL_COMPRESSED_RGBA_BPTC_UNORM, rgba, bc7, width, height));
+}
+
+// Loads a BC1-cooked version of the demo texture through Texture (glCompressedTexImage2D, no decode)
+BENCHMARK(texture_load_cooked, 20) {
+	// Cook the file once, outside of the measured iterations
+	int width, height, channels;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* rgba = stbi_load("textures/tao.png", &width, &height, &channels, STBI_rgb_alpha);
+	MipChain chain = BuildMipChain(rgba, width, height);
+	stbi_image_free(rgba);
+
+	std::vector<CookedTextureLevel> levels;
+	std::vector<std::vector<unsigned char>> levelData;
+	for (const MipChain::Level& level : chain.levels) {
+		levelData.emplace_back(BCImageBytes(BCFormat::BC1, level.width, level.height));
+		EncodeBCImage(BCFormat::BC1, chain.pixels.data() + level.offset, level.width, level.height, levelData.back().data());
+		levels.push_back({ (uint32_t)level.width, (uint32_t)level.height, 0, 0 });
+	}
+	WriteCookedTexture("bench_tao.ctex", GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, levels, levelData);
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		Texture texture("bench_tao.ctex", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+		glFinish();
+		run.End();
+		texture.Delete();
+	}
+}
+
+// Read, compile and link of the default shader program (program cache disabled)
+BENCHMARK(shader_build, 20) {
+	ProgramCache::Get().SetDirectory("");
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		Shader shader("shaders/default.vert", "shaders/default.frag");
+		glFinish();
+		run.End();
+		shader.Delete();
+	}
+}
+
+// Read of the default shader sources and load from a warm program binary cache
+BENCHMARK(shader_build_cached, 20) {
+	ProgramCache& cache = ProgramCache::Get();
+	cache.SetDirectory("bench_shader_cache");
+
+	// Populate the cache outside of the measured iterations
+	Shader warmup("shaders/default.vert", "shaders/default.frag");
+	warmup.Delete();
+
+	unsigned int hitsBefore = cache.hits;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		Shader shader("shaders/default.vert", "shaders/default.frag");
+		glFinish();
+		run.End();
+		shader.Delete();
+	}
+	run.Counter("cache_hits", cache.hits - hitsBefore);
+	cache.SetDirectory("");
+}
+
+// 1000 individual draws of the pyramid, one state setup each like main.cpp does for its single object
+BENCHMARK(draw_submission, 50) {
+	const int drawsPerIteration = 1000;
+
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	Texture texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+	texture.texUnit(shader, "tex0", 0);
+
+	VAO vao;
+	vao.Bind();
+	VBO vbo(benchPyramidVertices, sizeof(benchPyramidVertices));
+	EBO ebo(benchPyramidIndices);
+	vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+	vao.LinkAttrib(vbo, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	vao.LinkAttrib(vbo, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	vao.Unbind();
+
+	Camera camera(256, 256, glm::vec3(0.0f, 0.0f, 2.0f));
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		for (int d = 0; d < drawsPerIteration; d++) {
+			shader.Activate();
+			camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix");
+			texture.Bind();
+			vao.Bind();
+			ebo.Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("draws", drawsPerIteration);
+
+	vao.Delete();
+	vbo.Delete();
+	ebo.Delete();
+	texture.Delete();
+	shader.Delete();
+}
+
+// 10000 camera matrix rebuilds + uploads
+BENCHMARK(camera_update, 50) {
+	const int updatesPerIteration = 10000;
+
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	shader.Activate();
+	Camera camera(256, 256, glm::vec3(0.0f, 0.0f, 2.0f));
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int u = 0; u < updatesPerIteration; u++) {
+			camera.Position.x = 0.0001f * u;
+			camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix");
+		}
+		run.End();
+	}
+	run.Counter("updates", updatesPerIteration);
+
+	shader.Delete();
+}
+
+// 100000 uniform location lookups through the reflected table
+BENCHMARK(uniform_lookup, 50) {
+	const int lookupsPerIteration = 100000;
+
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	unsigned int fallbacksBefore = Shader::fallbackLookups;
+	GLint sum = 0;
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int l = 0; l < lookupsPerIteration; l++) {
+			sum += shader.UniformLocation((l & 1) ? "cameraMatrix"_uniform : "tex0"_uniform);
+		}
+		run.End();
+	}
+	run.Counter("lookups", lookupsPerIteration);
+	run.Counter("fallbacks", Shader::fallbackLookups - fallbacksBefore);
+	run.Counter("checksum", sum != 0);
+
+	shader.Delete();
+}
+
+// 100000 uniform location lookups through the driver, for comparison
+BENCHMARK(uniform_lookup_driver, 50) {
+	const int lookupsPerIteration = 100000;
+
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	GLint sum = 0;
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int l = 0; l < lookupsPerIteration; l++) {
+			sum += glGetUniformLocation(shader.ID, (l & 1) ? "cameraMatrix" : "tex0");
+		}
+		run.End();
+	}
+	run.Counter("lookups", lookupsPerIteration);
+	run.Counter("checksum", sum != 0);
+
+	shader.Delete();
+}
+
+// Streams 16 textures through the async loader; each sample is the loader's share of one ~4 ms frame
+BENCHMARK(texture_load_async, 1) {
+	const int textureCount = 16;
+
+	TextureLoader loader;
+	std::vector<TextureHandle> textures;
+	for (int i = 0; i < textureCount; i++) {
+		textures.push_back(loader.Load(i & 1 ? "textures/miles.jpg" : "textures/tao.png"));
+	}
+
+	int frames = 0;
+	while (loader.IsBusy()) {
+		run.Begin();
+		loader.Update();
+		glFinish();
+		run.End();
+		frames++;
+
+		// The rest of the frame, during which workers keep decoding
+		std::this_thread::sleep_for(std::chrono::milliseconds(4));
+	}
+	run.Counter("textures", loader.completed);
+	run.Counter("frames", frames);
+	run.Counter("uploaded_mb", loader.bytesUploadedTotal / (1024.0 * 1024.0));
+
+	for (TextureHandle& texture : textures) {
+		if (texture->IsResident()) {
+			texture->texture.Delete();
+		}
+	}
+	loader.Delete();
+}
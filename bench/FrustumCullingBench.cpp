@@ -0,0 +1,110 @@
+#include <random>
+
+#include "Benchmark.h"
+
+#include "FrustumCulling.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// One million objects scattered through a 400 unit cube around a camera looking down -z, about a
+// fifth of which end up inside the frustum; even entries are boxes, odd ones spheres
+static const size_t CULL_BENCH_OBJECTS = 1000000;
+
+static CullingBounds benchBounds() {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> size(0.25f, 4.0f);
+	CullingBounds bounds;
+	bounds.Resize(CULL_BENCH_OBJECTS);
+	for (size_t i = 0; i < CULL_BENCH_OBJECTS; i++) {
+		glm::vec3 center(position(rng), position(rng), position(rng));
+		if (i % 2 == 0) {
+			glm::vec3 extent(size(rng), size(rng), size(rng));
+			bounds.SetAABB(i, center - extent, center + extent);
+		}
+		else {
+			bounds.SetSphere(i, center, size(rng));
+		}
+	}
+	return bounds;
+}
+
+static Frustum benchFrustum() {
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 100.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+	return Frustum::FromMatrix(proj * view);
+}
+
+static void reportCull(BenchmarkRun& run, size_t visible) {
+	run.Counter("objects", (double)CULL_BENCH_OBJECTS);
+	run.Counter("visible", (double)visible);
+	run.Counter("mobjects_per_s", CULL_BENCH_OBJECTS / (run.timer.Median() * 1000.0));
+}
+
+// Baseline: Frustum::IntersectsAABB() on one object at a time, reading the same SoA arrays
+BENCHMARK(frustum_cull_scalar_aabb, 20) {
+	CullingBounds bounds = benchBounds();
+	Frustum frustum = benchFrustum();
+	std::vector<uint32_t> visible(bounds.PaddedSize());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = 0;
+		for (size_t b = 0; b < bounds.Size(); b++) {
+			glm::vec3 center(bounds.centerX[b], bounds.centerY[b], bounds.centerZ[b]);
+			glm::vec3 extent(bounds.extentX[b], bounds.extentY[b], bounds.extentZ[b]);
+			if (frustum.IntersectsAABB(center, extent)) {
+				visible[count++] = (uint32_t)b;
+			}
+		}
+		run.End();
+	}
+	reportCull(run, count);
+}
+
+// FrustumCull() on spheres, 4 (SSE2) or 8 (AVX) at a time
+BENCHMARK(frustum_cull_simd_sphere, 20) {
+	CullingBounds bounds = benchBounds();
+	Frustum frustum = benchFrustum();
+	std::vector<uint32_t> visible(bounds.PaddedSize());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = FrustumCull(frustum, bounds, CullShape::Sphere, visible.data());
+		run.End();
+	}
+	reportCull(run, count);
+	run.Counter("lanes", (double)FrustumCullLanes());
+}
+
+// FrustumCull() on boxes
+BENCHMARK(frustum_cull_simd_aabb, 20) {
+	CullingBounds bounds = benchBounds();
+	Frustum frustum = benchFrustum();
+	std::vector<uint32_t> visible(bounds.PaddedSize());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = FrustumCull(frustum, bounds, CullShape::AABB, visible.data());
+		run.End();
+	}
+	reportCull(run, count);
+	run.Counter("lanes", (double)FrustumCullLanes());
+}
+
+// FrustumCull() on boxes with the array split across a pool (one worker per hardware thread)
+BENCHMARK(frustum_cull_simd_aabb_parallel, 20) {
+	CullingBounds bounds = benchBounds();
+	Frustum frustum = benchFrustum();
+	std::vector<uint32_t> visible(bounds.PaddedSize());
+	ThreadPool pool;
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = FrustumCull(frustum, bounds, CullShape::AABB, visible.data(), &pool);
+		run.End();
+	}
+	reportCull(run, count);
+	run.Counter("threads", (double)pool.Size() + 1);
+}
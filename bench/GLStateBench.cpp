@@ -0,0 +1,91 @@
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "GLState.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// Wrapper-style submission (every draw re-binds program, texture and VAO) where only every
+// 16th draw actually changes anything; rasterization is discarded so the driver calls dominate
+struct BindScene {
+	static const int DRAWS = 20000;
+
+	Shader shader;
+	Texture textures[2];
+	VAO vaos[2];
+	VBO vbo;
+	EBO ebo;
+
+	BindScene()
+		: shader("shaders/default.vert", "shaders/default.frag"),
+		  textures{ Texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE),
+					Texture("textures/miles.jpg", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE) },
+		  vbo(benchPyramidVertices, sizeof(benchPyramidVertices)),
+		  ebo(benchPyramidIndices) {
+		for (VAO& vao : vaos) {
+			vao.Bind();
+			vbo.Bind();
+			ebo.Bind();
+			vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+			vao.LinkAttrib(vbo, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+			vao.LinkAttrib(vbo, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		}
+		vaos[0].Unbind();
+		glEnable(GL_RASTERIZER_DISCARD);
+	}
+
+	~BindScene() {
+		glDisable(GL_RASTERIZER_DISCARD);
+		for (VAO& vao : vaos) vao.Delete();
+		for (Texture& texture : textures) texture.Delete();
+		vbo.Delete();
+		ebo.Delete();
+		shader.Delete();
+	}
+};
+
+// Straight GL calls, the way the wrappers behaved before the state cache
+BENCHMARK(binds_uncached, 30) {
+	BindScene scene;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int d = 0; d < BindScene::DRAWS; d++) {
+			int variant = (d / 16) & 1;
+			glUseProgram(scene.shader.ID);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, scene.textures[variant].ID);
+			glBindVertexArray(scene.vaos[variant].ID);
+			scene.ebo.Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	GLState::Get().Reset();
+	run.Counter("draws", BindScene::DRAWS);
+}
+
+// Same sequence through GLState
+BENCHMARK(binds_cached, 30) {
+	BindScene scene;
+	GLState& state = GLState::Get();
+	state.ResetStats();
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (int d = 0; d < BindScene::DRAWS; d++) {
+			int variant = (d / 16) & 1;
+			scene.shader.Activate();
+			state.ActiveTexture(GL_TEXTURE0);
+			scene.textures[variant].Bind();
+			scene.vaos[variant].Bind();
+			scene.ebo.Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("draws", BindScene::DRAWS);
+	run.Counter("calls_issued", state.stats.issued);
+	run.Counter("calls_skipped", state.stats.skipped);
+}
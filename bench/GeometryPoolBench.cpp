@@ -0,0 +1,146 @@
+#include <random>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "GeometryPool.h"
+#include "RangeAllocator.h"
+#include "ShaderClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+static const int POOL_MESHES = 2000;
+
+// Draws 2000 meshes, each with its own VAO/VBO/EBO (one VAO switch per draw)
+BENCHMARK(meshes_separate_buffers, 30) {
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	std::vector<VAO> vaos(POOL_MESHES);
+	std::vector<VBO> vbos;
+	std::vector<EBO> ebos;
+	for (VAO& vao : vaos) {
+		vao.Bind();
+		vbos.emplace_back(benchPyramidVertices, sizeof(benchPyramidVertices));
+		ebos.emplace_back(benchPyramidIndices);
+		vao.LinkAttrib(vbos.back(), 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+		vao.LinkAttrib(vbos.back(), 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		vao.LinkAttrib(vbos.back(), 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	}
+	shader.Activate();
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (size_t m = 0; m < vaos.size(); m++) {
+			vaos[m].Bind();
+			ebos[m].Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("draws", POOL_MESHES);
+	run.Counter("buffers", 2.0 * POOL_MESHES);
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	for (size_t m = 0; m < vaos.size(); m++) {
+		vaos[m].Delete();
+		vbos[m].Delete();
+		ebos[m].Delete();
+	}
+	shader.Delete();
+}
+
+// Same meshes sub-allocated from a GeometryPool: one VAO, glDrawElementsBaseVertex per mesh
+BENCHMARK(meshes_geometry_pool, 30) {
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	GeometryPool pool(VertexFormat::PositionColorUV(), 1024, 4096);
+	std::vector<MeshHandle> meshes;
+	for (int m = 0; m < POOL_MESHES; m++) {
+		meshes.push_back(pool.Allocate(benchPyramidVertices, 5, benchPyramidIndices, 18));
+	}
+	shader.Activate();
+	pool.Bind();
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		pool.Bind();
+		for (MeshHandle mesh : meshes) {
+			pool.Draw(mesh);
+		}
+		glFinish();
+		run.End();
+	}
+	GeometryPool::Stats stats = pool.GetStats();
+	run.Counter("draws", POOL_MESHES);
+	run.Counter("buffers", 2);
+	run.Counter("grows", stats.grows);
+	run.Counter("vertex_utilization", (double)stats.verticesUsed / stats.vertexCapacity);
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	pool.Delete();
+	shader.Delete();
+}
+
+// Random allocate/free churn against the pool; reports fragmentation and compactions
+BENCHMARK(geometry_pool_churn, 10) {
+	std::mt19937 random(7);
+	for (int i = 0; i < run.iterations; i++) {
+		GeometryPool pool(VertexFormat::PositionColorUV(), 1 << 14, 1 << 15);
+		std::vector<MeshHandle> live;
+		std::vector<GLfloat> vertices(64 * 8, 0.5f);
+		std::vector<GLuint> indices(192, 0);
+
+		run.Begin();
+		for (int step = 0; step < 20000; step++) {
+			if (live.empty() || random() % 3 != 0) {
+				uint32_t vertexCount = 4 + random() % 60;
+				live.push_back(pool.Allocate(vertices.data(), vertexCount, indices.data(), vertexCount * 3));
+			}
+			else {
+				size_t victim = random() % live.size();
+				pool.Free(live[victim]);
+				live[victim] = live.back();
+				live.pop_back();
+			}
+		}
+		glFinish();
+		run.End();
+
+		GeometryPool::Stats stats = pool.GetStats();
+		run.Counter("meshes", stats.meshes);
+		run.Counter("vertex_utilization", (double)stats.verticesUsed / stats.vertexCapacity);
+		run.Counter("vertex_fragmentation", stats.vertexFragmentation);
+		run.Counter("defragmentations", stats.defragmentations);
+		run.Counter("grows", stats.grows);
+		pool.Delete();
+	}
+}
+
+// Best-fit allocation and coalescing cost of the range allocator alone
+BENCHMARK(range_allocator, 20) {
+	std::mt19937 random(11);
+	for (int i = 0; i < run.iterations; i++) {
+		RangeAllocator allocator(1 << 24);
+		std::vector<std::pair<uint32_t, uint32_t>> live;
+		run.Begin();
+		for (int step = 0; step < 100000; step++) {
+			if (live.empty() || random() % 2 == 0) {
+				uint32_t size = 1 + random() % 256;
+				uint32_t offset = allocator.Allocate(size);
+				if (offset != RangeAllocator::INVALID) {
+					live.emplace_back(offset, size);
+				}
+			}
+			else {
+				size_t victim = random() % live.size();
+				allocator.Free(live[victim].first, live[victim].second);
+				live[victim] = live.back();
+				live.pop_back();
+			}
+		}
+		run.End();
+		run.Counter("free_ranges", (double)allocator.FreeRanges());
+		run.Counter("fragmentation", allocator.Fragmentation());
+	}
+}
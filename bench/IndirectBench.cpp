@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cmath>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "CameraClass.h"
+#include "IndirectBatch.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// 10000 draws of 4 differently sized pyramids packed into one vertex and one index buffer
+struct IndirectScene {
+	static const int DRAWS = 10000;
+	static const int MESHES = 4;
+	static const int MESH_VERTICES = 5;
+	static const int MESH_INDICES = 18;
+
+	Shader shader;
+	Texture texture;
+	VAO vao;
+	VBO* vbo;
+	EBO* ebo;
+	IndirectBatch batch;
+	Camera camera;
+
+	IndirectScene(IndirectBatch::Mode mode)
+		: shader("shaders/instanced.vert", "shaders/instanced.frag"),
+		  texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE),
+		  batch(mode),
+		  camera(256, 256, glm::vec3(0.0f, 40.0f, 0.01f)) {
+		// Mesh m is the pyramid scaled by 1 + m / 2; every mesh reuses the same local indices
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		for (int m = 0; m < MESHES; m++) {
+			for (int v = 0; v < MESH_VERTICES; v++) {
+				for (int c = 0; c < 8; c++) {
+					GLfloat value = benchPyramidVertices[v * 8 + c];
+					vertices.push_back(c < 3 ? value * (1.0f + m * 0.5f) : value);
+				}
+			}
+			indices.insert(indices.end(), benchPyramidIndices, benchPyramidIndices + MESH_INDICES);
+		}
+
+		vao.Bind();
+		vbo = new VBO(vertices.data(), vertices.size() * sizeof(GLfloat));
+		ebo = new EBO(indices);
+		vao.LinkAttrib(*vbo, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+		vao.LinkAttrib(*vbo, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		vao.LinkAttrib(*vbo, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		batch.Attach(vao);
+
+		int side = (int)std::ceil(std::sqrt((float)DRAWS));
+		for (int i = 0; i < DRAWS; i++) {
+			int mesh = i % MESHES;
+			glm::vec3 position((i % side - side * 0.5f) * 0.5f, 0.0f, (i / side - side * 0.5f) * 0.5f);
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.2f));
+			batch.Add(MESH_INDICES, mesh * MESH_INDICES, mesh * MESH_VERTICES, InstanceData::Make(model));
+		}
+
+		camera.Orientation = glm::vec3(0.0f, -1.0f, 0.0f);
+		camera.UpVector = glm::vec3(0.0f, 0.0f, -1.0f);
+		shader.Activate();
+		texture.texUnit(shader, "tex0", 0);
+		camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix");
+		texture.Bind();
+	}
+
+	// Times the submission (CPU side) and the whole frame of one batch draw
+	void Frame(BenchmarkRun& run, double& frameMs) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		run.Begin();
+		batch.Draw(ebo->type);
+		run.End();
+		glFinish();
+		frameMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	~IndirectScene() {
+		batch.Delete();
+		vao.Delete();
+		vbo->Delete();
+		ebo->Delete();
+		delete vbo;
+		delete ebo;
+		texture.Delete();
+		shader.Delete();
+	}
+};
+
+// One glMultiDrawElementsIndirect for all draws (commands uploaded once)
+BENCHMARK(indirect_multidraw, 30) {
+	if (IndirectBatch::BestMode() != IndirectBatch::Mode::MultiDrawIndirect) {
+		run.Counter("unsupported", 1);
+		return;
+	}
+	IndirectScene scene(IndirectBatch::Mode::MultiDrawIndirect);
+	double frameMs = 0.0;
+	for (int i = 0; i < run.iterations; i++) {
+		scene.Frame(run, frameMs);
+	}
+	run.Counter("draws", IndirectScene::DRAWS);
+	run.Counter("frame_mean_ms", frameMs / run.iterations);
+	run.Counter("covered_pixels", benchCoveredPixels());
+}
+
+// Fallback: a glDrawElementsBaseVertex loop with per-draw constant attributes
+BENCHMARK(indirect_draw_loop, 30) {
+	IndirectScene scene(IndirectBatch::Mode::DrawLoop);
+	double frameMs = 0.0;
+	for (int i = 0; i < run.iterations; i++) {
+		scene.Frame(run, frameMs);
+	}
+	run.Counter("draws", IndirectScene::DRAWS);
+	run.Counter("frame_mean_ms", frameMs / run.iterations);
+	run.Counter("covered_pixels", benchCoveredPixels());
+}
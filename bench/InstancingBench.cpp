@@ -0,0 +1,111 @@
+#include <cmath>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "CameraClass.h"
+#include "InstanceBuffer.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// 100k small pyramids on a grid, seen from above
+struct InstancingScene {
+	static const int INSTANCES = 100000;
+
+	Shader shader;
+	Texture texture;
+	VAO vao;
+	VBO vbo;
+	EBO ebo;
+	InstanceBuffer instanceBuffer;
+	Camera camera;
+	std::vector<InstanceData> instances;
+
+	InstancingScene()
+		: shader("shaders/instanced.vert", "shaders/instanced.frag"),
+		  texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE),
+		  vbo(benchPyramidVertices, sizeof(benchPyramidVertices)),
+		  ebo(benchPyramidIndices),
+		  instanceBuffer(INSTANCES),
+		  camera(256, 256, glm::vec3(0.0f, 60.0f, 0.01f)) {
+		vao.Bind();
+		ebo.Bind();
+		vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+		vao.LinkAttrib(vbo, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		vao.LinkAttrib(vbo, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		instanceBuffer.Attach(vao);
+		vao.Unbind();
+
+		int side = (int)std::ceil(std::sqrt((float)INSTANCES));
+		for (int i = 0; i < INSTANCES; i++) {
+			glm::vec3 position((i % side - side * 0.5f) * 0.3f, 0.0f, (i / side - side * 0.5f) * 0.3f);
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.25f));
+			instances.push_back(InstanceData::Make(model, glm::vec4(1.0f)));
+		}
+		instanceBuffer.Update(instances);
+
+		camera.Orientation = glm::vec3(0.0f, -1.0f, 0.0f);
+		camera.UpVector = glm::vec3(0.0f, 0.0f, -1.0f);
+		shader.Activate();
+		texture.texUnit(shader, "tex0", 0);
+		camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix");
+		texture.Bind();
+	}
+
+	~InstancingScene() {
+		vao.Delete();
+		vbo.Delete();
+		ebo.Delete();
+		instanceBuffer.Delete();
+		texture.Delete();
+		shader.Delete();
+	}
+};
+
+// One glDrawElements per pyramid, its transform set through constant attribute values
+BENCHMARK(instances_naive, 5) {
+	InstancingScene scene;
+	scene.vao.Bind();
+	for (GLuint location = 3; location < 7; location++) {
+		glDisableVertexAttribArray(location);
+	}
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		for (const InstanceData& instance : scene.instances) {
+			glVertexAttrib4fv(3, &instance.rows[0].x);
+			glVertexAttrib4fv(4, &instance.rows[1].x);
+			glVertexAttrib4fv(5, &instance.rows[2].x);
+			glVertexAttrib4fv(6, &instance.data.x);
+			scene.ebo.Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("covered_pixels", benchCoveredPixels());
+	for (GLuint location = 3; location < 7; location++) {
+		glEnableVertexAttribArray(location);
+	}
+	run.Counter("instances", InstancingScene::INSTANCES);
+	run.Counter("draws", InstancingScene::INSTANCES);
+}
+
+// All pyramids in one glDrawElementsInstanced, including the per-frame instance upload
+BENCHMARK(instances_instanced, 20) {
+	InstancingScene scene;
+	scene.vao.Bind();
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		scene.instanceBuffer.Update(scene.instances);
+		scene.ebo.DrawInstanced(scene.instanceBuffer.Count());
+		glFinish();
+		run.End();
+	}
+	run.Counter("covered_pixels", benchCoveredPixels());
+	run.Counter("instances", InstancingScene::INSTANCES);
+	run.Counter("draws", 1);
+}
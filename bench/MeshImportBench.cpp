@@ -0,0 +1,266 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "CookedMesh.h"
+#include "EBO.h"
+#include "GlbFile.h"
+#include "MappedFile.h"
+#include "ObjFile.h"
+#include "ThreadPool.h"
+#include "VAO.h"
+#include "VBO.h"
+
+// A 1000x500 grid of quads with positions, UVs and normals: 1M triangles, an 80 MB .obj
+static const int IMPORT_GRID_X = 1000;
+static const int IMPORT_GRID_Y = 500;
+static const char* IMPORT_OBJ = "bench_grid.obj";
+static const char* IMPORT_GLB = "bench_grid.glb";
+static const char* IMPORT_CMESH = "bench_grid.cmesh";
+
+// Writes the grid as .obj the way common exporters do (v, vt, vn blocks, then v/vt/vn faces)
+static void writeGridObj() {
+	FILE* file = std::fopen(IMPORT_OBJ, "w");
+	for (int y = 0; y <= IMPORT_GRID_Y; y++) {
+		for (int x = 0; x <= IMPORT_GRID_X; x++) {
+			std::fprintf(file, "v %f %f %f\n", x * 0.01f, y * 0.01f, 0.001f * ((x * 7 + y * 13) % 17));
+		}
+	}
+	for (int y = 0; y <= IMPORT_GRID_Y; y++) {
+		for (int x = 0; x <= IMPORT_GRID_X; x++) {
+			std::fprintf(file, "vt %f %f\n", (float)x / IMPORT_GRID_X, (float)y / IMPORT_GRID_Y);
+		}
+	}
+	std::fprintf(file, "vn 0.000000 0.000000 1.000000\n");
+	for (int y = 0; y < IMPORT_GRID_Y; y++) {
+		for (int x = 0; x < IMPORT_GRID_X; x++) {
+			int a = y * (IMPORT_GRID_X + 1) + x + 1;
+			int b = a + IMPORT_GRID_X + 1;
+			std::fprintf(file, "f %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, a + 1, a + 1, b, b);
+			std::fprintf(file, "f %d/%d/1 %d/%d/1 %d/%d/1\n", a + 1, a + 1, b + 1, b + 1, b, b);
+		}
+	}
+	std::fclose(file);
+}
+
+// Writes the same grid as .glb (float positions, normals and UVs, 32-bit indices)
+static void writeGridGlb() {
+	uint32_t vertexCount = (IMPORT_GRID_X + 1) * (IMPORT_GRID_Y + 1);
+	std::vector<float> positions, normals, uvs;
+	for (int y = 0; y <= IMPORT_GRID_Y; y++) {
+		for (int x = 0; x <= IMPORT_GRID_X; x++) {
+			positions.insert(positions.end(), { x * 0.01f, y * 0.01f, 0.001f * ((x * 7 + y * 13) % 17) });
+			normals.insert(normals.end(), { 0.0f, 0.0f, 1.0f });
+			uvs.insert(uvs.end(), { (float)x / IMPORT_GRID_X, (float)y / IMPORT_GRID_Y });
+		}
+	}
+	std::vector<uint32_t> indices;
+	for (int y = 0; y < IMPORT_GRID_Y; y++) {
+		for (int x = 0; x < IMPORT_GRID_X; x++) {
+			uint32_t a = y * (IMPORT_GRID_X + 1) + x;
+			uint32_t b = a + IMPORT_GRID_X + 1;
+			indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+		}
+	}
+
+	size_t positionBytes = positions.size() * 4, normalBytes = normals.size() * 4, uvBytes = uvs.size() * 4, indexBytes = indices.size() * 4;
+	char json[2048];
+	std::snprintf(json, sizeof(json),
+		"{\"asset\":{\"version\":\"2.0\"},\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+		"\"buffers\":[{\"byteLength\":%zu}],\"bufferViews\":["
+		"{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+		"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],\"accessors\":["
+		"{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},{\"bufferView\":1,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+		"{\"bufferView\":2,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},{\"bufferView\":3,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}]}",
+		positionBytes + normalBytes + uvBytes + indexBytes, positionBytes, positionBytes, normalBytes, positionBytes + normalBytes, uvBytes,
+		positionBytes + normalBytes + uvBytes, indexBytes, vertexCount, vertexCount, vertexCount, indices.size());
+	std::string jsonChunk = json;
+	jsonChunk.resize((jsonChunk.size() + 3) & ~(size_t)3, ' ');
+	uint32_t binLength = (uint32_t)(positionBytes + normalBytes + uvBytes + indexBytes);
+	uint32_t header[5] = { 0x46546C67, 2, (uint32_t)(12 + 8 + jsonChunk.size() + 8 + binLength), (uint32_t)jsonChunk.size(), 0x4E4F534A };
+	uint32_t binHeader[2] = { binLength, 0x004E4942 };
+
+	FILE* file = std::fopen(IMPORT_GLB, "wb");
+	std::fwrite(header, sizeof(header), 1, file);
+	std::fwrite(jsonChunk.data(), jsonChunk.size(), 1, file);
+	std::fwrite(binHeader, sizeof(binHeader), 1, file);
+	std::fwrite(positions.data(), positionBytes, 1, file);
+	std::fwrite(normals.data(), normalBytes, 1, file);
+	std::fwrite(uvs.data(), uvBytes, 1, file);
+	std::fwrite(indices.data(), indexBytes, 1, file);
+	std::fclose(file);
+}
+
+// Size of a file in MB
+static double fileMegabytes(const char* path) {
+	MappedFile file;
+	return file.Open(path) ? file.Size() / (1024.0 * 1024.0) : 0.0;
+}
+
+// Reads every byte of the mapped .obj: what parsing would cost if it were free (from the page cache)
+BENCHMARK(mesh_import_read_baseline, 5) {
+	writeGridObj();
+	uint64_t sum = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		MappedFile file;
+		file.Open(IMPORT_OBJ);
+		const unsigned char* data = file.Data();
+		for (size_t b = 0; b < file.Size(); b += 64) {
+			sum += data[b];
+		}
+		run.End();
+	}
+	double megabytes = fileMegabytes(IMPORT_OBJ);
+	run.Counter("file_mb", megabytes);
+	run.Counter("mb_per_s", megabytes / (run.timer.Median() / 1000.0));
+	run.Counter("checksum", (double)(sum & 0xFF));
+}
+
+// Loads the .obj on the calling thread
+BENCHMARK(mesh_import_obj_serial, 5) {
+	writeGridObj();
+	MeshData mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		LoadObj(IMPORT_OBJ, mesh);
+		run.End();
+	}
+	run.Counter("triangles", mesh.indices.size() / 3.0);
+	run.Counter("vertices", (double)mesh.vertices.size());
+	run.Counter("mb_per_s", fileMegabytes(IMPORT_OBJ) / (run.timer.Median() / 1000.0));
+}
+
+// Loads the .obj with chunks parsed and welded on every hardware thread
+BENCHMARK(mesh_import_obj_parallel, 5) {
+	writeGridObj();
+	ThreadPool pool;
+	MeshData mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		LoadObj(IMPORT_OBJ, mesh, &pool);
+		run.End();
+	}
+	run.Counter("threads", pool.Size() + 1);
+	run.Counter("triangles", mesh.indices.size() / 3.0);
+	run.Counter("vertices", (double)mesh.vertices.size());
+	run.Counter("mb_per_s", fileMegabytes(IMPORT_OBJ) / (run.timer.Median() / 1000.0));
+	std::remove(IMPORT_OBJ);
+}
+
+// Loads the same grid from a .glb, reading accessors straight from the mapping
+BENCHMARK(mesh_import_glb, 5) {
+	writeGridGlb();
+	MeshData mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		LoadGlb(IMPORT_GLB, mesh);
+		run.End();
+	}
+	run.Counter("triangles", mesh.indices.size() / 3.0);
+	run.Counter("vertices", (double)mesh.vertices.size());
+	run.Counter("mb_per_s", fileMegabytes(IMPORT_GLB) / (run.timer.Median() / 1000.0));
+	std::remove(IMPORT_GLB);
+}
+
+// Cooks the grid into a .cmesh with float vertices and meshlets
+static void writeGridCooked() {
+	writeGridGlb();
+	MeshData mesh;
+	LoadGlb(IMPORT_GLB, mesh);
+	std::remove(IMPORT_GLB);
+	MeshletData meshlets = BuildMeshlets(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position.x, mesh.vertices.size(), sizeof(MeshVertex));
+
+	CookedMeshContents contents;
+	contents.vertices = mesh.vertices.data();
+	contents.vertexCount = (uint32_t)mesh.vertices.size();
+	contents.format = VertexFormatOf<MeshVertex>();
+	contents.indices = mesh.indices.data();
+	contents.indexCount = (uint32_t)mesh.indices.size();
+	contents.meshlets = &meshlets;
+	WriteCookedMesh(IMPORT_CMESH, contents);
+}
+
+// Creates a VAO for the uploaded buffers and waits for the driver to consume them
+static void finishUpload(VBO& vbo, EBO& ebo, const VertexFormat& format) {
+	VAO vao;
+	vao.Bind();
+	ebo.Bind();
+	vao.LinkFormat(format, vbo);
+	glFinish();
+	vao.Delete();
+	vbo.Delete();
+	ebo.Delete();
+}
+
+// Scene load floor: uploads the grid from memory that is already parsed
+BENCHMARK(mesh_load_upload_only, 5) {
+	writeGridGlb();
+	MeshData mesh;
+	LoadGlb(IMPORT_GLB, mesh);
+	std::remove(IMPORT_GLB);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		VBO vbo(mesh.vertices);
+		EBO ebo(mesh.indices);
+		finishUpload(vbo, ebo, VertexFormatOf<MeshVertex>());
+		run.End();
+	}
+	run.Counter("triangles", mesh.indices.size() / 3.0);
+}
+
+// Imports the .glb and uploads it
+BENCHMARK(mesh_load_glb, 5) {
+	writeGridGlb();
+	MeshData mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		LoadGlb(IMPORT_GLB, mesh);
+		VBO vbo(mesh.vertices);
+		EBO ebo(mesh.indices);
+		finishUpload(vbo, ebo, VertexFormatOf<MeshVertex>());
+		run.End();
+	}
+	run.Counter("triangles", mesh.indices.size() / 3.0);
+	run.Counter("file_mb", fileMegabytes(IMPORT_GLB));
+	std::remove(IMPORT_GLB);
+}
+
+// Maps the .cmesh, validates its header and section table, and uploads the sections in place
+BENCHMARK(mesh_load_cooked, 5) {
+	writeGridCooked();
+	CookedMesh mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		mesh.Open(IMPORT_CMESH);
+		VBO vbo(mesh.Vertices(), mesh.VertexBytes());
+		EBO ebo(mesh.Indices(), (GLsizei)mesh.Header().indexCount, mesh.Header().indexType);
+		finishUpload(vbo, ebo, mesh.Format());
+		run.End();
+	}
+	run.Counter("triangles", mesh.Header().indexCount / 3.0);
+	run.Counter("meshlets", (double)mesh.MeshletCount());
+	run.Counter("file_mb", fileMegabytes(IMPORT_CMESH));
+	mesh.Close();
+}
+
+// Same, hashing the whole file against the stored checksum first
+BENCHMARK(mesh_load_cooked_checksum, 5) {
+	writeGridCooked();
+	CookedMesh mesh;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		mesh.Open(IMPORT_CMESH, true);
+		VBO vbo(mesh.Vertices(), mesh.VertexBytes());
+		EBO ebo(mesh.Indices(), (GLsizei)mesh.Header().indexCount, mesh.Header().indexType);
+		finishUpload(vbo, ebo, mesh.Format());
+		run.End();
+	}
+	run.Counter("file_mb", fileMegabytes(IMPORT_CMESH));
+	mesh.Close();
+	std::remove(IMPORT_CMESH);
+}
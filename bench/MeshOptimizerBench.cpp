@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "CameraClass.h"
+#include "MeshOptimizer.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// A 200x400 UV sphere (80k vertices, 160k triangles) with its triangles shuffled, the worst case
+// for the post-transform cache
+static MeshData shuffledSphere() {
+	const int rings = 200, segments = 400;
+	const float pi = 3.14159265f;
+	MeshData mesh;
+	for (int ring = 0; ring <= rings; ring++) {
+		float theta = pi * ring / rings;
+		for (int segment = 0; segment <= segments; segment++) {
+			float phi = 2.0f * pi * segment / segments;
+			glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			mesh.vertices.push_back({ normal * 0.9f, normal, glm::vec4(1.0f), glm::vec2(4.0f * segment / segments, 2.0f * ring / rings) });
+		}
+	}
+	std::vector<glm::uvec3> triangles;
+	for (int ring = 0; ring < rings; ring++) {
+		for (int segment = 0; segment < segments; segment++) {
+			GLuint a = ring * (segments + 1) + segment;
+			GLuint b = a + segments + 1;
+			triangles.push_back(glm::uvec3(a, b, a + 1));
+			triangles.push_back(glm::uvec3(a + 1, b, b + 1));
+		}
+	}
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+	for (const glm::uvec3& triangle : triangles) {
+		mesh.indices.insert(mesh.indices.end(), { triangle.x, triangle.y, triangle.z });
+	}
+	return mesh;
+}
+
+// Time OptimizeMesh() takes on the shuffled sphere
+BENCHMARK(mesh_optimize, 10) {
+	MeshData source = shuffledSphere();
+	MeshOptimizationReport report;
+	for (int i = 0; i < run.iterations; i++) {
+		MeshData mesh = source;
+		run.Begin();
+		report = OptimizeMesh(mesh);
+		run.End();
+	}
+	run.Counter("triangles", report.after.triangles);
+	run.Counter("acmr_before", report.before.acmr);
+	run.Counter("acmr_after", report.after.acmr);
+	run.Counter("atvr_before", report.before.atvr);
+	run.Counter("atvr_after", report.after.atvr);
+	run.Counter("clusters", report.clusters);
+}
+
+// Draws a mesh 8 times a frame
+static void drawMesh(BenchmarkRun& run, const MeshData& mesh) {
+	Shader shader("shaders/mesh.vert", "shaders/default.frag");
+	Texture texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+	Camera camera(256, 256, glm::vec3(0.0f, 0.0f, 2.5f));
+	VAO vao;
+	VBO vbo(mesh.vertices);
+	EBO ebo(mesh.indices);
+	vao.Bind();
+	ebo.Bind();
+	vao.LinkVertex<MeshVertex>(vbo);
+	shader.Activate();
+	texture.texUnit(shader, "tex0"_uniform, 0);
+	texture.Bind();
+	camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix"_uniform);
+
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		for (int draw = 0; draw < 8; draw++) {
+			ebo.Draw();
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("acmr", AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size()).acmr);
+	run.Counter("covered_pixels", benchCoveredPixels());
+
+	vao.Delete();
+	vbo.Delete();
+	ebo.Delete();
+	texture.Delete();
+	shader.Delete();
+}
+
+// The shuffled sphere as is
+BENCHMARK(mesh_draw_unoptimized, 20) {
+	drawMesh(run, shuffledSphere());
+}
+
+// The same sphere after OptimizeMesh()
+BENCHMARK(mesh_draw_optimized, 20) {
+	MeshData mesh = shuffledSphere();
+	OptimizeMesh(mesh);
+	drawMesh(run, mesh);
+}
@@ -0,0 +1,131 @@
+#include <random>
+
+#include "Benchmark.h"
+
+#include "FrustumCulling.h"
+#include "OcclusionCulling.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// A 16x16 city: buildings 40 units wide and 20 to 60 tall on 50 unit blocks, with 50k props
+// (crates, lamps, cars) scattered over it, seen from street level looking down a street
+static const size_t OCCLUSION_BENCH_PROPS = 50000;
+
+struct OcclusionScene {
+	std::vector<glm::vec3> positions;   // building corners
+	std::vector<GLuint> indices;
+	CullingBounds props;
+	glm::mat4 viewProjection;
+	std::vector<uint32_t> candidates;   // props inside the frustum
+};
+
+static OcclusionScene occlusionScene() {
+	OcclusionScene scene;
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> height(20.0f, 60.0f);
+	const GLuint boxIndices[36] = { 0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6, 0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 3, 7, 1, 7, 5 };
+	for (int bz = -8; bz < 8; bz++) {
+		for (int bx = -8; bx < 8; bx++) {
+			glm::vec3 min(bx * 50.0f + 5.0f, 0.0f, bz * 50.0f + 5.0f);
+			glm::vec3 max(min.x + 40.0f, height(rng), min.z + 40.0f);
+			GLuint base = (GLuint)scene.positions.size();
+			for (int corner = 0; corner < 8; corner++) {
+				scene.positions.push_back(glm::vec3(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z));
+			}
+			for (GLuint index : boxIndices) {
+				scene.indices.push_back(base + index);
+			}
+		}
+	}
+
+	std::uniform_real_distribution<float> position(-400.0f, 400.0f);
+	std::uniform_real_distribution<float> size(0.5f, 1.5f);
+	scene.props.Resize(OCCLUSION_BENCH_PROPS);
+	for (size_t i = 0; i < OCCLUSION_BENCH_PROPS; i++) {
+		glm::vec3 extent(size(rng));
+		glm::vec3 center(position(rng), extent.y, position(rng));
+		scene.props.SetAABB(i, center - extent, center + extent);
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 420.0f), glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	scene.viewProjection = proj * view;
+	scene.candidates.resize(scene.props.PaddedSize());
+	scene.candidates.resize(FrustumCull(Frustum::FromMatrix(scene.viewProjection), scene.props, CullShape::AABB, scene.candidates.data()));
+	return scene;
+}
+
+static void drawOccluders(OcclusionBuffer& occlusion, const OcclusionScene& scene, ThreadPool* pool) {
+	occlusion.Begin(scene.viewProjection);
+	occlusion.AddOccluder(&scene.positions[0].x, scene.positions.size(), sizeof(glm::vec3), scene.indices.data(), scene.indices.size());
+	occlusion.Rasterize(pool);
+}
+
+static void reportRasterize(BenchmarkRun& run, const OcclusionBuffer& occlusion) {
+	run.Counter("triangles", occlusion.stats.occluderTriangles);
+	run.Counter("rasterized", occlusion.stats.rasterizedTriangles);
+	run.Counter("pixels", (double)occlusion.Width() * occlusion.Height());
+}
+
+// Setup and rasterization of the 256 buildings (3072 triangles) into a 256x128 buffer
+BENCHMARK(occlusion_rasterize, 50) {
+	OcclusionScene scene = occlusionScene();
+	OcclusionBuffer occlusion;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		drawOccluders(occlusion, scene, nullptr);
+		run.End();
+	}
+	reportRasterize(run, occlusion);
+}
+
+// The same with one tile per job on a pool
+BENCHMARK(occlusion_rasterize_parallel, 50) {
+	OcclusionScene scene = occlusionScene();
+	OcclusionBuffer occlusion;
+	ThreadPool pool;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		drawOccluders(occlusion, scene, &pool);
+		run.End();
+	}
+	reportRasterize(run, occlusion);
+	run.Counter("threads", (double)pool.Size() + 1);
+}
+
+// Testing the props that survived frustum culling against the buildings
+BENCHMARK(occlusion_test, 50) {
+	OcclusionScene scene = occlusionScene();
+	OcclusionBuffer occlusion;
+	drawOccluders(occlusion, scene, nullptr);
+	std::vector<uint32_t> visible(scene.candidates.size());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = occlusion.Cull(scene.props, scene.candidates.data(), scene.candidates.size(), visible.data());
+		run.End();
+	}
+	run.Counter("tested", (double)scene.candidates.size());
+	run.Counter("visible", (double)count);
+	run.Counter("culled", (double)(scene.candidates.size() - count));
+}
+
+// The same split across a pool
+BENCHMARK(occlusion_test_parallel, 50) {
+	OcclusionScene scene = occlusionScene();
+	OcclusionBuffer occlusion;
+	ThreadPool pool;
+	drawOccluders(occlusion, scene, &pool);
+	std::vector<uint32_t> visible(scene.candidates.size());
+	size_t count = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		count = occlusion.Cull(scene.props, scene.candidates.data(), scene.candidates.size(), visible.data(), &pool);
+		run.End();
+	}
+	run.Counter("tested", (double)scene.candidates.size());
+	run.Counter("visible", (double)count);
+	run.Counter("culled", (double)(scene.candidates.size() - count));
+	run.Counter("threads", (double)pool.Size() + 1);
+}
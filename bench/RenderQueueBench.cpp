@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <random>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "RenderQueue.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// Scene of 4 programs x 8 textures x 4 VAOs drawn 2000 times in random order
+struct RenderQueueScene {
+	std::vector<Shader> shaders;
+	std::vector<Texture> textures;
+	std::vector<VAO> vaos;
+	std::vector<VBO> vbos;
+	std::vector<EBO> ebos;
+	std::vector<DrawCommand> draws;
+
+	RenderQueueScene(int drawCount) {
+		for (int i = 0; i < 4; i++) {
+			shaders.emplace_back("shaders/default.vert", "shaders/default.frag");
+		}
+		for (int i = 0; i < 8; i++) {
+			textures.emplace_back(i & 1 ? "textures/miles.jpg" : "textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+		}
+		for (int i = 0; i < 4; i++) {
+			vaos.emplace_back();
+			vaos.back().Bind();
+			vbos.emplace_back(benchPyramidVertices, sizeof(benchPyramidVertices));
+			ebos.emplace_back(benchPyramidIndices);
+			vaos.back().LinkAttrib(vbos.back(), 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+			vaos.back().LinkAttrib(vbos.back(), 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+			vaos.back().LinkAttrib(vbos.back(), 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+			vaos.back().Unbind();
+		}
+
+		std::mt19937 random(1234);
+		for (int i = 0; i < drawCount; i++) {
+			draws.push_back({ &shaders[random() % shaders.size()], &textures[random() % textures.size()], &vaos[random() % vaos.size()],
+				ebos[0].count, ebos[0].type, 0 });
+		}
+	}
+
+	~RenderQueueScene() {
+		for (Shader& shader : shaders) shader.Delete();
+		for (Texture& texture : textures) texture.Delete();
+		for (VAO& vao : vaos) vao.Delete();
+		for (VBO& vbo : vbos) vbo.Delete();
+		for (EBO& ebo : ebos) ebo.Delete();
+	}
+};
+
+// Submission in arrival order, binding everything for every draw
+BENCHMARK(draw_unsorted, 30) {
+	RenderQueueScene scene(2000);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (const DrawCommand& draw : scene.draws) {
+			draw.shader->Activate();
+			draw.texture->Bind();
+			draw.vao->Bind();
+			glDrawElements(GL_TRIANGLES, draw.count, draw.indexType, (const void*)draw.firstIndex);
+		}
+		glFinish();
+		run.End();
+	}
+	run.Counter("draws", (double)scene.draws.size());
+	run.Counter("state_changes", 3.0 * scene.draws.size());
+}
+
+// Same draws through the render queue (key build + radix sort + redundant bind elision)
+BENCHMARK(draw_render_queue, 30) {
+	RenderQueueScene scene(2000);
+	RenderQueue queue;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		for (const DrawCommand& draw : scene.draws) {
+			queue.Submit(draw);
+		}
+		queue.Flush();
+		glFinish();
+		run.End();
+	}
+	run.Counter("draws", queue.stats.draws);
+	run.Counter("state_changes", queue.stats.shaderChanges + queue.stats.textureChanges + queue.stats.vaoChanges);
+	run.Counter("state_changes_saved", queue.stats.stateChangesSaved);
+}
+
+// Radix sort of 100000 random keys
+BENCHMARK(radix_sort, 50) {
+	std::mt19937_64 random(42);
+	std::vector<uint64_t> source(100000);
+	for (uint64_t& key : source) {
+		key = random();
+	}
+
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> values(source.size());
+	for (int i = 0; i < run.iterations; i++) {
+		keys = source;
+		for (uint32_t v = 0; v < values.size(); v++) {
+			values[v] = v;
+		}
+		run.Begin();
+		RenderQueue::RadixSort(keys, values);
+		run.End();
+	}
+	run.Counter("keys", (double)keys.size());
+	run.Counter("sorted", std::is_sorted(keys.begin(), keys.end()));
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <random>
+
+#include "Benchmark.h"
+
+#include "SceneGraph.h"
+
+// 1000 roots with 10 children each and 9 grandchildren under every child: 101k nodes
+static const int SCENE_BENCH_ROOTS = 1000;
+static const int SCENE_BENCH_CHILDREN = 10;
+static const int SCENE_BENCH_GRANDCHILDREN = 9;
+
+static std::vector<SceneNode> sceneBenchGraph(SceneGraph& scene) {
+	std::vector<SceneNode> nodes;
+	for (int r = 0; r < SCENE_BENCH_ROOTS; r++) {
+		SceneNode root = scene.Create(INVALID_NODE, glm::vec3((float)(r % 32) * 10.0f, 0.0f, (float)(r / 32) * 10.0f));
+		nodes.push_back(root);
+		for (int c = 0; c < SCENE_BENCH_CHILDREN; c++) {
+			SceneNode child = scene.Create(root, glm::vec3((float)c, 1.0f, 0.0f));
+			nodes.push_back(child);
+			for (int g = 0; g < SCENE_BENCH_GRANDCHILDREN; g++) {
+				nodes.push_back(scene.Create(child, glm::vec3(0.0f, 0.5f, (float)g * 0.1f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.25f)));
+			}
+		}
+	}
+	scene.Update();
+	return nodes;
+}
+
+// Every iteration a different random fraction of the nodes, at any depth, gets a new rotation before
+// Update(); reports how many world matrices that cost
+static void sceneBenchMovers(BenchmarkRun& run, double fraction) {
+	SceneGraph scene;
+	std::vector<SceneNode> nodes = sceneBenchGraph(scene);
+	size_t moving = (size_t)(nodes.size() * fraction);
+	std::mt19937 rng(5);
+	std::vector<SceneNode> movers(moving);
+	size_t updated = 0;
+	unsigned int fullPasses = scene.stats.fullPasses;
+	for (int i = 0; i < run.iterations; i++) {
+		std::sample(nodes.begin(), nodes.end(), movers.begin(), moving, rng);
+		glm::quat rotation = glm::angleAxis(0.01f * (float)(i + 1), glm::vec3(0.0f, 1.0f, 0.0f));
+		run.Begin();
+		for (SceneNode node : movers) {
+			scene.SetRotation(node, rotation);
+		}
+		scene.Update();
+		run.End();
+		updated = scene.stats.updated;
+	}
+	run.Counter("nodes", (double)scene.stats.nodes);
+	run.Counter("moved", (double)moving);
+	run.Counter("updated", (double)updated);
+	run.Counter("ns_per_updated", updated ? run.timer.Median() * 1e6 / (double)updated : 0.0);
+	run.Counter("full_passes", scene.stats.fullPasses - fullPasses);
+}
+
+// Building the 101k nodes and their first world matrices
+BENCHMARK(scene_graph_create, 10) {
+	size_t nodes = 0;
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		SceneGraph scene;
+		nodes = sceneBenchGraph(scene).size();
+		run.End();
+	}
+	run.Counter("nodes", (double)nodes);
+}
+
+// Nothing moved: Update() has nothing to do
+BENCHMARK(scene_graph_update_static, 100) {
+	sceneBenchMovers(run, 0.0);
+}
+
+// 1% of the nodes moved
+BENCHMARK(scene_graph_update_1pct, 100) {
+	sceneBenchMovers(run, 0.01);
+}
+
+// 10% of the nodes moved
+BENCHMARK(scene_graph_update_10pct, 50) {
+	sceneBenchMovers(run, 0.10);
+}
+
+// Baseline: every node moved, recomputed in the single linear pass
+BENCHMARK(scene_graph_update_all, 50) {
+	sceneBenchMovers(run, 1.0);
+}
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "CameraClass.h"
+#include "InstanceBuffer.h"
+#include "ShaderClass.h"
+#include "StreamBuffer.h"
+#include "TextureClass.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// 20000 pyramids whose transforms change every frame, drawn in one instanced call
+struct StreamingScene {
+	static const int INSTANCES = 20000;
+
+	Shader shader;
+	Texture texture;
+	VAO vao;
+	VBO vbo;
+	EBO ebo;
+	Camera camera;
+
+	StreamingScene()
+		: shader("shaders/instanced.vert", "shaders/instanced.frag"),
+		  texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE),
+		  vbo(benchPyramidVertices, sizeof(benchPyramidVertices)),
+		  ebo(benchPyramidIndices),
+		  camera(256, 256, glm::vec3(0.0f, 40.0f, 0.01f)) {
+		vao.Bind();
+		ebo.Bind();
+		vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, 8 * sizeof(float), (void*)0);
+		vao.LinkAttrib(vbo, 1, 3, GL_FLOAT, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		vao.LinkAttrib(vbo, 2, 2, GL_FLOAT, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+
+		camera.Orientation = glm::vec3(0.0f, -1.0f, 0.0f);
+		camera.UpVector = glm::vec3(0.0f, 0.0f, -1.0f);
+		shader.Activate();
+		texture.texUnit(shader, "tex0", 0);
+		camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix");
+		texture.Bind();
+	}
+
+	// Writes this frame's transforms
+	static void Write(InstanceData* instances, int frame) {
+		int side = (int)std::ceil(std::sqrt((float)INSTANCES));
+		for (int i = 0; i < INSTANCES; i++) {
+			glm::vec3 position((i % side - side * 0.5f) * 0.3f, 0.0f, (i / side - side * 0.5f) * 0.3f);
+			glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), position), frame * 0.1f + i, glm::vec3(0.0f, 1.0f, 0.0f));
+			instances[i] = InstanceData::Make(glm::scale(model, glm::vec3(0.2f)));
+		}
+	}
+
+	void Draw() {
+		ebo.DrawInstanced(INSTANCES);
+	}
+
+	~StreamingScene() {
+		vao.Delete();
+		vbo.Delete();
+		ebo.Delete();
+		texture.Delete();
+		shader.Delete();
+	}
+};
+
+// Transforms built in a CPU array, then uploaded with InstanceBuffer::Update (orphan + glBufferSubData)
+BENCHMARK(stream_buffer_subdata, 60) {
+	StreamingScene scene;
+	InstanceBuffer buffer(StreamingScene::INSTANCES);
+	buffer.Attach(scene.vao);
+	std::vector<InstanceData> instances(StreamingScene::INSTANCES);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		StreamingScene::Write(instances.data(), i);
+		buffer.Update(instances);
+		scene.Draw();
+		run.End();
+	}
+	glFinish();
+	run.Counter("instances", StreamingScene::INSTANCES);
+	run.Counter("covered_pixels", benchCoveredPixels());
+	buffer.Delete();
+}
+
+// Transforms written straight into a StreamBuffer section in the given mode
+static void streamBufferFrames(BenchmarkRun& run, StreamBuffer::Mode mode) {
+	StreamingScene scene;
+	StreamBuffer stream(GL_ARRAY_BUFFER, StreamingScene::INSTANCES * sizeof(InstanceData), 3, mode);
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		stream.BeginFrame();
+		StreamBuffer::Allocation allocation = stream.Allocate(StreamingScene::INSTANCES * sizeof(InstanceData), sizeof(InstanceData));
+		StreamingScene::Write((InstanceData*)allocation.data, i);
+		InstanceBuffer::Link(allocation.buffer, allocation.offset);
+		stream.Flush();
+		scene.Draw();
+		stream.EndFrame();
+		run.End();
+	}
+	glFinish();
+	run.Counter("instances", StreamingScene::INSTANCES);
+	run.Counter("covered_pixels", benchCoveredPixels());
+	run.Counter("fence_waits", stream.stats.fenceWaits);
+	run.Counter("fence_wait_ms", stream.stats.fenceWaitMs);
+	run.Counter("mb_streamed", stream.stats.bytesAllocated / (1024.0 * 1024.0));
+	stream.Delete();
+}
+
+// Persistent, coherent mapping with 3 fenced sections
+BENCHMARK(stream_buffer_persistent, 60) {
+	if (StreamBuffer::BestMode() != StreamBuffer::Mode::Persistent) {
+		run.Counter("unsupported", 1);
+		return;
+	}
+	streamBufferFrames(run, StreamBuffer::Mode::Persistent);
+}
+
+// The GL 3.3 fallback: CPU shadow copy uploaded into orphaned storage
+BENCHMARK(stream_buffer_orphaning, 60) {
+	streamBufferFrames(run, StreamBuffer::Mode::Orphaning);
+}
+
+// Uniform blocks streamed from a ring whose section size (1000 bytes) isn't a multiple of the
+// uniform offset alignment: every range bound has to stay aligned, in every section
+BENCHMARK(stream_buffer_uniform_ranges, 60) {
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	StreamBuffer stream(GL_UNIFORM_BUFFER, 1000, 3);
+	unsigned int misaligned = 0, errors = 0;
+	while (glGetError() != GL_NO_ERROR) {
+	}
+	for (int i = 0; i < run.iterations; i++) {
+		run.Begin();
+		stream.BeginFrame();
+		for (int block = 0; block < 3; block++) {
+			StreamBuffer::Allocation allocation = stream.Allocate(64, alignment);
+			if (!allocation.data) {
+				continue;
+			}
+			std::memset(allocation.data, block, 64);
+			misaligned += allocation.offset % alignment != 0 ? 1 : 0;
+			stream.BindRange(0, allocation);
+			errors += glGetError() != GL_NO_ERROR ? 1 : 0;
+		}
+		stream.EndFrame();
+		run.End();
+	}
+	run.Counter("alignment", alignment);
+	run.Counter("allocations", stream.stats.allocations);
+	run.Counter("failed", stream.stats.failedAllocations);
+	run.Counter("misaligned", misaligned);
+	run.Counter("gl_errors", errors);
+	stream.Delete();
+}
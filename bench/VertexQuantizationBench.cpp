@@ -0,0 +1,125 @@
+#include <cmath>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchScene.h"
+
+#include "CameraClass.h"
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VertexQuantization.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+
+// A dense UV sphere (about 130k vertices, 780k indices) drawn 8 times a frame, so vertex fetch
+// dominates; the three benchmarks only differ in the bytes per vertex they read
+struct QuantizationScene {
+	static const int RINGS = 256;
+	static const int SEGMENTS = 512;
+	static const int DRAWS = 8;
+
+	std::vector<MeshVertex> vertices;
+	std::vector<GLuint> indices;
+	Texture texture;
+	Camera camera;
+
+	QuantizationScene()
+		: texture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE),
+		  camera(256, 256, glm::vec3(0.3f, 0.2f, 2.5f)) {
+		const float pi = 3.14159265f;
+		for (int ring = 0; ring <= RINGS; ring++) {
+			float theta = pi * ring / RINGS;
+			for (int segment = 0; segment <= SEGMENTS; segment++) {
+				float phi = 2.0f * pi * segment / SEGMENTS;
+				glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				MeshVertex vertex;
+				vertex.position = normal * 0.9f + glm::vec3(0.1f, -0.2f, 0.0f);
+				vertex.normal = normal;
+				vertex.color = glm::vec4(normal * 0.5f + 0.5f, 1.0f);
+				vertex.uv = glm::vec2(4.0f * segment / SEGMENTS, 2.0f * ring / RINGS);
+				vertices.push_back(vertex);
+			}
+		}
+		for (int ring = 0; ring < RINGS; ring++) {
+			for (int segment = 0; segment < SEGMENTS; segment++) {
+				GLuint a = ring * (SEGMENTS + 1) + segment;
+				GLuint b = a + SEGMENTS + 1;
+				indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+		texture.Bind();
+	}
+
+	~QuantizationScene() {
+		texture.Delete();
+	}
+
+	// Draws the bound mesh DRAWS times with the given shader
+	template <typename Vertex>
+	void Run(BenchmarkRun& run, Shader& shader, const std::vector<Vertex>& meshVertices, const QuantizedMesh* quantized) {
+		VAO vao;
+		VBO vbo(meshVertices);
+		EBO ebo(indices);
+		vao.Bind();
+		ebo.Bind();
+		vao.LinkVertex<Vertex>(vbo);
+
+		shader.Activate();
+		texture.texUnit(shader, "tex0"_uniform, 0);
+		camera.Matrix(45.0f, 0.1f, 100.0f, shader, "cameraMatrix"_uniform);
+		if (quantized) {
+			quantized->SetUniforms(shader);
+		}
+
+		for (int i = 0; i < run.iterations; i++) {
+			run.Begin();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			for (int draw = 0; draw < DRAWS; draw++) {
+				ebo.Draw();
+			}
+			glFinish();
+			run.End();
+		}
+		run.Counter("vertices", (double)meshVertices.size());
+		run.Counter("bytes_per_vertex", sizeof(Vertex));
+		run.Counter("vertex_mb_per_frame", DRAWS * meshVertices.size() * sizeof(Vertex) / (1024.0 * 1024.0));
+		run.Counter("covered_pixels", benchCoveredPixels());
+
+		vao.Delete();
+		vbo.Delete();
+		ebo.Delete();
+	}
+};
+
+// MeshVertex: float position, normal, color and UV (48 bytes)
+BENCHMARK(vertex_format_float, 20) {
+	QuantizationScene scene;
+	Shader shader("shaders/mesh.vert", "shaders/default.frag");
+	scene.Run(run, shader, scene.vertices, nullptr);
+	shader.Delete();
+}
+
+// The demo layout: float position, color and UV, no normal (32 bytes)
+BENCHMARK(vertex_format_position_color_uv, 20) {
+	QuantizationScene scene;
+	std::vector<PositionColorUVVertex> vertices;
+	for (const MeshVertex& vertex : scene.vertices) {
+		vertices.push_back({ vertex.position, glm::vec3(vertex.color), vertex.uv });
+	}
+	Shader shader("shaders/default.vert", "shaders/default.frag");
+	scene.Run(run, shader, vertices, nullptr);
+	shader.Delete();
+}
+
+// QuantizedVertex: unorm16 position, octahedral snorm16 normal, unorm8 color, half UV (20 bytes)
+BENCHMARK(vertex_format_quantized, 20) {
+	QuantizationScene scene;
+	QuantizedMesh mesh = QuantizeMesh(scene.vertices);
+	Shader shader("shaders/quantized.vert", "shaders/default.frag");
+	scene.Run(run, shader, mesh.vertices, &mesh);
+	run.Counter("max_position_error", mesh.error.maxPosition);
+	run.Counter("max_normal_degrees", mesh.error.maxNormalDegrees);
+	run.Counter("max_uv_error", mesh.error.maxUV);
+	shader.Delete();
+}
@@ -0,0 +1,22 @@
+// Fragment shader for instanced draws
+#version 330 core
+
+// Outputs colors in RGBA format
+out vec4 FragColor;
+
+// Inputs the color from the Vertex Shader
+in vec3 color;
+
+// Inputs the texture coordinates from the Vertex Shader
+in vec2 texCoord;
+
+// Inputs the instance tint from the Vertex Shader
+in vec4 tint;
+
+// Gets the Texture Unit from the main function
+uniform sampler2D tex0;
+
+void main()
+{
+   FragColor = texture(tex0, texCoord) * tint;
+}
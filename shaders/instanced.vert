@@ -0,0 +1,41 @@
+// Vertex shader for instanced draws (the default shader plus a per-instance model transform)
+#version 330 core
+
+// Positions
+layout (location = 0) in vec3 aPos;
+
+// Colors
+layout (location = 1) in vec3 aColor;
+
+// Texture coordinates
+layout (location = 2) in vec2 aTex;
+
+// Per-instance model transform, the rows of a 3x4 matrix (advance once per instance)
+layout (location = 3) in vec4 aModelRow0;
+layout (location = 4) in vec4 aModelRow1;
+layout (location = 5) in vec4 aModelRow2;
+
+// Per-instance tint
+layout (location = 6) in vec4 aTint;
+
+// Outputs colors to the Fragment Shader
+out vec3 color;
+
+// Outputs texture coordinates to the Fragment Shader
+out vec2 texCoord;
+
+// Outputs the instance tint to the Fragment Shader
+out vec4 tint;
+
+// Imports the camera matrix from the main function
+uniform mat4 cameraMatrix;
+
+void main()
+{
+   vec4 position = vec4(aPos, 1.0);
+   vec3 world = vec3(dot(aModelRow0, position), dot(aModelRow1, position), dot(aModelRow2, position));
+   gl_Position = cameraMatrix * vec4(world, 1.0);
+   color = aColor;
+   texCoord = aTex;
+   tint = aTint;
+}
@@ -0,0 +1,37 @@
+// Vertex shader for full-precision meshes (MeshVertex)
+#version 330 core
+
+// Positions
+layout (location = 0) in vec3 aPos;
+
+// Colors
+layout (location = 1) in vec4 aColor;
+
+// Texture coordinates
+layout (location = 2) in vec2 aTex;
+
+// Normals
+layout (location = 7) in vec3 aNormal;
+
+// Outputs colors to the Fragment Shader
+out vec3 color;
+
+// Outputs texture coordinates to the Fragment Shader
+out vec2 texCoord;
+
+// Outputs normals to the Fragment Shader
+out vec3 normal;
+
+// Imports the camera matrix from the main function
+uniform mat4 cameraMatrix;
+
+// Places the mesh in the world (identity unless set)
+uniform mat4 model = mat4(1.0);
+
+void main()
+{
+   gl_Position = cameraMatrix * model * vec4(aPos, 1.0);
+   color = aColor.rgb;
+   texCoord = aTex;
+   normal = aNormal;
+}
@@ -0,0 +1,50 @@
+// Vertex shader for quantized meshes (QuantizedVertex); produces the same outputs as mesh.vert
+#version 330 core
+
+// Positions, unorm16 within the mesh bounds
+layout (location = 0) in vec3 aPos;
+
+// Colors, unorm8
+layout (location = 1) in vec4 aColor;
+
+// Texture coordinates, half floats
+layout (location = 2) in vec2 aTex;
+
+// Normals, octahedral snorm16
+layout (location = 7) in vec2 aNormal;
+
+// Outputs colors to the Fragment Shader
+out vec3 color;
+
+// Outputs texture coordinates to the Fragment Shader
+out vec2 texCoord;
+
+// Outputs normals to the Fragment Shader
+out vec3 normal;
+
+// Imports the camera matrix from the main function
+uniform mat4 cameraMatrix;
+
+// Places the mesh in the world (identity unless set)
+uniform mat4 model = mat4(1.0);
+
+// Mesh bounds the positions were quantized in
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+// Unfolds an octahedral normal
+vec3 octahedralDecode(vec2 e)
+{
+   vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+   float t = max(-n.z, 0.0);
+   n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+   return normalize(n);
+}
+
+void main()
+{
+   gl_Position = cameraMatrix * model * vec4(positionOffset + aPos * positionScale, 1.0);
+   color = aColor.rgb;
+   texCoord = aTex;
+   normal = octahedralDecode(aNormal);
+}
@@ -0,0 +1,486 @@
+#include "BCnEncoder.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BCN_USE_SSE2 1
+#endif
+
+// Pixels of one block as floats, 4 channels each (unused channels are zero)
+typedef float BlockPixels[16][4];
+
+// Up to 16 candidate colors in structure-of-arrays layout, padded to a multiple of 4
+struct Palette {
+	alignas(16) float channel[4][16];
+	int count;
+};
+
+// BC7 interpolation weights for 4-bit indices
+static const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static void loadBlock(const unsigned char* rgba, BlockPixels pixels, int channels) {
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 4; c++) {
+			pixels[i][c] = c < channels ? (float)rgba[i * 4 + c] : 0.0f;
+		}
+	}
+}
+
+static void padPalette(Palette& palette) {
+	for (int i = palette.count; i < ((palette.count + 3) & ~3); i++) {
+		for (int c = 0; c < 4; c++) {
+			palette.channel[c][i] = 1e15f;
+		}
+	}
+}
+
+// Picks the nearest palette entry for every pixel; returns the total squared error
+static float selectIndices(const BlockPixels pixels, const Palette& palette, unsigned char indices[16]) {
+	float total = 0.0f;
+	for (int i = 0; i < 16; i++) {
+		float best = 3.4e38f;
+		int bestIndex = 0;
+#ifdef BCN_USE_SSE2
+		// Four palette entries per step
+		__m128 r = _mm_set1_ps(pixels[i][0]);
+		__m128 g = _mm_set1_ps(pixels[i][1]);
+		__m128 b = _mm_set1_ps(pixels[i][2]);
+		__m128 a = _mm_set1_ps(pixels[i][3]);
+		for (int k = 0; k < palette.count; k += 4) {
+			__m128 dr = _mm_sub_ps(_mm_load_ps(palette.channel[0] + k), r);
+			__m128 dg = _mm_sub_ps(_mm_load_ps(palette.channel[1] + k), g);
+			__m128 db = _mm_sub_ps(_mm_load_ps(palette.channel[2] + k), b);
+			__m128 da = _mm_sub_ps(_mm_load_ps(palette.channel[3] + k), a);
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+			alignas(16) float distance[4];
+			_mm_store_ps(distance, d);
+			for (int j = 0; j < 4; j++) {
+				if (distance[j] < best) {
+					best = distance[j];
+					bestIndex = k + j;
+				}
+			}
+		}
+#else
+		for (int k = 0; k < palette.count; k++) {
+			float d = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				float delta = palette.channel[c][k] - pixels[i][c];
+				d += delta * delta;
+			}
+			if (d < best) {
+				best = d;
+				bestIndex = k;
+			}
+		}
+#endif
+		indices[i] = (unsigned char)bestIndex;
+		total += best;
+	}
+	return total;
+}
+
+// Scales v to unit length; false if it is (nearly) zero
+static bool normalize(float v[4]) {
+	float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+	if (length < 1e-6f) {
+		return false;
+	}
+	for (int c = 0; c < 4; c++) {
+		v[c] /= length;
+	}
+	return true;
+}
+
+// Unit direction between the two pixels farthest apart; false if all pixels are the same
+static bool farthestPair(const BlockPixels pixels, float axis[4]) {
+	float best = 0.0f;
+	for (int i = 0; i < 16; i++) {
+		for (int j = i + 1; j < 16; j++) {
+			float d = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				float delta = pixels[j][c] - pixels[i][c];
+				d += delta * delta;
+			}
+			if (d > best) {
+				best = d;
+				for (int c = 0; c < 4; c++) {
+					axis[c] = pixels[j][c] - pixels[i][c];
+				}
+			}
+		}
+	}
+	return best > 0.0f && normalize(axis);
+}
+
+// Unit direction from the darkest to the brightest pixel, left alone if they have the same luminance
+static void luminancePair(const BlockPixels pixels, float axis[4]) {
+	int darkest = 0, brightest = 0;
+	float minY = 3.4e38f, maxY = -3.4e38f;
+	for (int i = 0; i < 16; i++) {
+		float y = 0.299f * pixels[i][0] + 0.587f * pixels[i][1] + 0.114f * pixels[i][2];
+		if (y < minY) {
+			minY = y;
+			darkest = i;
+		}
+		if (y > maxY) {
+			maxY = y;
+			brightest = i;
+		}
+	}
+	float direction[4];
+	for (int c = 0; c < 4; c++) {
+		direction[c] = pixels[brightest][c] - pixels[darkest][c];
+	}
+	if (normalize(direction)) {
+		std::memcpy(axis, direction, sizeof(direction));
+	}
+}
+
+// Fits a line through the pixels (principal component) and returns its extreme points
+static void fitEndpoints(const BlockPixels pixels, float e0[4], float e1[4]) {
+	float mean[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 4; c++) {
+			mean[c] += pixels[i][c] / 16.0f;
+		}
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++) {
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				covariance[r][c] += (pixels[i][r] - mean[r]) * (pixels[i][c] - mean[c]);
+			}
+		}
+	}
+
+	// Power iteration for the dominant eigenvector, seeded with the two pixels farthest apart: a fixed
+	// seed such as (1,1,1,1) is nearly orthogonal to the spread of anti-correlated channels (a red and
+	// green checker) and collapses the block to its mean
+	float axis[4] = {};
+	if (!farthestPair(pixels, axis)) {
+		for (int c = 0; c < 4; c++) {
+			e0[c] = e1[c] = mean[c];
+		}
+		return;
+	}
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = {};
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				next[r] += covariance[r][c] * axis[c];
+			}
+		}
+		if (!normalize(next)) {
+			// Degenerate covariance: use the darkest to brightest pixel instead
+			luminancePair(pixels, axis);
+			break;
+		}
+		std::memcpy(axis, next, sizeof(next));
+	}
+
+	float minT = 0.0f, maxT = 0.0f;
+	for (int i = 0; i < 16; i++) {
+		float t = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			t += (pixels[i][c] - mean[c]) * axis[c];
+		}
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	for (int c = 0; c < 4; c++) {
+		e0[c] = std::min(std::max(mean[c] + minT * axis[c], 0.0f), 255.0f);
+		e1[c] = std::min(std::max(mean[c] + maxT * axis[c], 0.0f), 255.0f);
+	}
+}
+
+// Least-squares endpoints for fixed indices, where pixel ~ (1 - w) * e0 + w * e1
+static bool refineEndpoints(const BlockPixels pixels, const unsigned char indices[16], const float* weights, float e0[4], float e1[4]) {
+	float a = 0.0f, b = 0.0f, d = 0.0f;
+	float x0[4] = {}, x1[4] = {};
+	for (int i = 0; i < 16; i++) {
+		float w = weights[indices[i]];
+		a += (1.0f - w) * (1.0f - w);
+		b += (1.0f - w) * w;
+		d += w * w;
+		for (int c = 0; c < 4; c++) {
+			x0[c] += (1.0f - w) * pixels[i][c];
+			x1[c] += w * pixels[i][c];
+		}
+	}
+	float det = a * d - b * b;
+	if (std::fabs(det) < 1e-6f) {
+		return false;
+	}
+	for (int c = 0; c < 4; c++) {
+		e0[c] = std::min(std::max((d * x0[c] - b * x1[c]) / det, 0.0f), 255.0f);
+		e1[c] = std::min(std::max((a * x1[c] - b * x0[c]) / det, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+static uint16_t packRGB565(const float color[4]) {
+	int r = std::min(std::max((int)std::lround(color[0] * 31.0f / 255.0f), 0), 31);
+	int g = std::min(std::max((int)std::lround(color[1] * 63.0f / 255.0f), 0), 63);
+	int b = std::min(std::max((int)std::lround(color[2] * 31.0f / 255.0f), 0), 31);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t packed, float color[4]) {
+	int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (float)((r << 3) | (r >> 2));
+	color[1] = (float)((g << 2) | (g >> 4));
+	color[2] = (float)((b << 3) | (b >> 2));
+	color[3] = 0.0f;
+}
+
+// Four-color BC1 block (also the color half of BC3)
+static void encodeColorBlock(const unsigned char* rgba, unsigned char* out) {
+	BlockPixels pixels;
+	loadBlock(rgba, pixels, 3);
+
+	// Palette order: endpoint 0, endpoint 1, 1/3 and 2/3 of the way from 0 to 1
+	static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float e0[4], e1[4];
+	fitEndpoints(pixels, e1, e0);
+
+	uint16_t bestC0 = 0, bestC1 = 0;
+	unsigned char bestIndices[16] = {};
+	float bestError = 3.4e38f;
+	for (int iteration = 0; iteration < 2; iteration++) {
+		uint16_t c0 = packRGB565(e0), c1 = packRGB565(e1);
+
+		Palette palette;
+		palette.count = 4;
+		float q0[4], q1[4];
+		unpackRGB565(c0, q0);
+		unpackRGB565(c1, q1);
+		for (int k = 0; k < 4; k++) {
+			for (int c = 0; c < 4; c++) {
+				palette.channel[c][k] = q0[c] + (q1[c] - q0[c]) * weights[k];
+			}
+		}
+
+		unsigned char indices[16];
+		float error = selectIndices(pixels, palette, indices);
+		if (error < bestError) {
+			bestError = error;
+			bestC0 = c0;
+			bestC1 = c1;
+			std::memcpy(bestIndices, indices, 16);
+		}
+		if (!refineEndpoints(pixels, indices, weights, e0, e1)) {
+			break;
+		}
+	}
+
+	// Four-color mode requires color0 > color1
+	if (bestC0 < bestC1) {
+		std::swap(bestC0, bestC1);
+		for (int i = 0; i < 16; i++) {
+			bestIndices[i] ^= 1;
+		}
+	}
+	else if (bestC0 == bestC1) {
+		std::memset(bestIndices, 0, 16);
+	}
+
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++) {
+		bits |= (uint32_t)bestIndices[i] << (i * 2);
+	}
+	out[0] = (unsigned char)(bestC0 & 0xFF);
+	out[1] = (unsigned char)(bestC0 >> 8);
+	out[2] = (unsigned char)(bestC1 & 0xFF);
+	out[3] = (unsigned char)(bestC1 >> 8);
+	for (int i = 0; i < 4; i++) {
+		out[4 + i] = (unsigned char)(bits >> (i * 8));
+	}
+}
+
+// Eight-value interpolated alpha block (BC3 alpha / BC4)
+static void encodeAlphaBlock(const unsigned char* rgba, unsigned char* out) {
+	int minA = 255, maxA = 0;
+	for (int i = 0; i < 16; i++) {
+		minA = std::min(minA, (int)rgba[i * 4 + 3]);
+		maxA = std::max(maxA, (int)rgba[i * 4 + 3]);
+	}
+
+	out[0] = (unsigned char)maxA;
+	out[1] = (unsigned char)minA;
+	uint64_t bits = 0;
+	if (maxA > minA) {
+		for (int i = 0; i < 16; i++) {
+			// Step 0..7 from alpha1 (min) to alpha0 (max); codes are 1, 7, 6, ..., 2, 0
+			int step = (int)std::lround((rgba[i * 4 + 3] - minA) * 7.0f / (maxA - minA));
+			int code = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+			bits |= (uint64_t)code << (i * 3);
+		}
+	}
+	for (int i = 0; i < 6; i++) {
+		out[2 + i] = (unsigned char)(bits >> (i * 8));
+	}
+}
+
+// Bytes per 4x4 block
+size_t BCBlockBytes(BCFormat format) {
+	return format == BCFormat::BC1 ? 8 : 16;
+}
+
+// Size in bytes of a width x height image
+size_t BCImageBytes(BCFormat format, int width, int height) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BCBlockBytes(format);
+}
+
+void EncodeBC1Block(const unsigned char* rgba, unsigned char* out) {
+	encodeColorBlock(rgba, out);
+}
+
+void EncodeBC3Block(const unsigned char* rgba, unsigned char* out) {
+	encodeAlphaBlock(rgba, out);
+	encodeColorBlock(rgba, out + 8);
+}
+
+// Writes bits LSB first into a 128-bit block
+struct BitWriter {
+	unsigned char* out;
+	int position = 0;
+
+	void Write(uint32_t value, int count) {
+		for (int i = 0; i < count; i++, position++) {
+			out[position >> 3] |= (unsigned char)(((value >> i) & 1) << (position & 7));
+		}
+	}
+};
+
+// Quantizes an endpoint to 7 bits per channel plus a shared p-bit, picking the better p-bit
+static void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pbit) {
+	float bestError = 3.4e38f;
+	for (int p = 0; p < 2; p++) {
+		int candidate[4];
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			candidate[c] = std::min(std::max((int)std::lround((endpoint[c] - p) / 2.0f), 0), 127);
+			float delta = (float)(candidate[c] * 2 + p) - endpoint[c];
+			error += delta * delta;
+		}
+		if (error < bestError) {
+			bestError = error;
+			pbit = p;
+			std::memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+void EncodeBC7Block(const unsigned char* rgba, unsigned char* out) {
+	BlockPixels pixels;
+	loadBlock(rgba, pixels, 4);
+
+	float weights[16];
+	for (int k = 0; k < 16; k++) {
+		weights[k] = BC7_WEIGHTS4[k] / 64.0f;
+	}
+
+	float e0[4], e1[4];
+	fitEndpoints(pixels, e0, e1);
+
+	int bestQ0[4] = {}, bestQ1[4] = {}, bestP0 = 0, bestP1 = 0;
+	unsigned char bestIndices[16] = {};
+	float bestError = 3.4e38f;
+	for (int iteration = 0; iteration < 3; iteration++) {
+		int q0[4], q1[4], p0, p1;
+		quantizeBC7Endpoint(e0, q0, p0);
+		quantizeBC7Endpoint(e1, q1, p1);
+
+		Palette palette;
+		palette.count = 16;
+		for (int k = 0; k < 16; k++) {
+			for (int c = 0; c < 4; c++) {
+				int v0 = q0[c] * 2 + p0, v1 = q1[c] * 2 + p1;
+				palette.channel[c][k] = (float)(((64 - BC7_WEIGHTS4[k]) * v0 + BC7_WEIGHTS4[k] * v1 + 32) >> 6);
+			}
+		}
+		padPalette(palette);
+
+		unsigned char indices[16];
+		float error = selectIndices(pixels, palette, indices);
+		if (error < bestError) {
+			bestError = error;
+			std::memcpy(bestQ0, q0, sizeof(q0));
+			std::memcpy(bestQ1, q1, sizeof(q1));
+			bestP0 = p0;
+			bestP1 = p1;
+			std::memcpy(bestIndices, indices, 16);
+		}
+		if (error == 0.0f || !refineEndpoints(pixels, indices, weights, e0, e1)) {
+			break;
+		}
+	}
+
+	// The anchor (first) index is stored with its top bit implied zero
+	if (bestIndices[0] >= 8) {
+		std::swap(bestQ0, bestQ1);
+		std::swap(bestP0, bestP1);
+		for (int i = 0; i < 16; i++) {
+			bestIndices[i] = (unsigned char)(15 - bestIndices[i]);
+		}
+	}
+
+	std::memset(out, 0, 16);
+	BitWriter writer = { out };
+	writer.Write(1 << 6, 7); // mode 6
+	for (int c = 0; c < 4; c++) {
+		writer.Write(bestQ0[c], 7);
+		writer.Write(bestQ1[c], 7);
+	}
+	writer.Write(bestP0, 1);
+	writer.Write(bestP1, 1);
+	writer.Write(bestIndices[0], 3);
+	for (int i = 1; i < 16; i++) {
+		writer.Write(bestIndices[i], 4);
+	}
+}
+
+// Encodes a whole RGBA8 image, split across the pool's workers by block rows when a pool is given
+void EncodeBCImage(BCFormat format, const unsigned char* rgba, int width, int height, unsigned char* out, ThreadPool* pool) {
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	const size_t blockBytes = BCBlockBytes(format);
+
+	std::function<void(size_t, size_t)> encodeRows = [&](size_t begin, size_t end) {
+		unsigned char block[64];
+		for (size_t by = begin; by < end; by++) {
+			for (int bx = 0; bx < blocksX; bx++) {
+				// Gather the 4x4 block, clamping to the image edge
+				for (int y = 0; y < 4; y++) {
+					int sy = std::min((int)by * 4 + y, height - 1);
+					for (int x = 0; x < 4; x++) {
+						int sx = std::min(bx * 4 + x, width - 1);
+						std::memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+					}
+				}
+
+				unsigned char* destination = out + (by * blocksX + bx) * blockBytes;
+				switch (format) {
+				case BCFormat::BC1: EncodeBC1Block(block, destination); break;
+				case BCFormat::BC3: EncodeBC3Block(block, destination); break;
+				case BCFormat::BC7: EncodeBC7Block(block, destination); break;
+				}
+			}
+		}
+	};
+
+	if (pool) {
+		pool->ParallelFor(blocksY, 4, encodeRows);
+	}
+	else {
+		encodeRows(0, blocksY);
+	}
+}
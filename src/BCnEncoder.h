@@ -0,0 +1,30 @@
+#ifndef BCN_ENCODER_H
+#define BCN_ENCODER_H
+
+#include <cstddef>
+
+class ThreadPool;
+
+// Block-compressed texture formats produced by the encoder
+enum class BCFormat {
+	BC1, // RGB, 4 bpp (alpha ignored)
+	BC3, // RGBA, 8 bpp (BC1 color + interpolated alpha)
+	BC7  // RGBA, 8 bpp (mode 6 only: one subset, 7.7.7.7+p endpoints, 4-bit indices)
+};
+
+// Bytes per 4x4 block
+size_t BCBlockBytes(BCFormat format);
+
+// Size in bytes of a width x height image
+size_t BCImageBytes(BCFormat format, int width, int height);
+
+// Encodes one 4x4 RGBA8 block (64 bytes, row-major)
+void EncodeBC1Block(const unsigned char* rgba, unsigned char* out);
+void EncodeBC3Block(const unsigned char* rgba, unsigned char* out);
+void EncodeBC7Block(const unsigned char* rgba, unsigned char* out);
+
+// Encodes a whole RGBA8 image (partial edge blocks repeat the edge texels), split across the pool's
+// workers by block rows when a pool is given
+void EncodeBCImage(BCFormat format, const unsigned char* rgba, int width, int height, unsigned char* out, ThreadPool* pool = nullptr);
+
+#endif
@@ -0,0 +1,392 @@
+#include "BVH.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+// Centroid bins per axis evaluated for every split
+static const int SAH_BINS = 16;
+
+// Cost of visiting an interior node relative to testing one object's box
+static const float SAH_TRAVERSAL_COST = 1.0f;
+
+// Leaves never hold more objects than this, even when the SAH would prefer it
+static const uint32_t BVH_MAX_LEAF_SIZE = 8;
+
+static float surfaceArea(const glm::vec3& min, const glm::vec3& max) {
+	glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static glm::vec3 objectCenter(const CullingBounds& bounds, uint32_t index) {
+	return glm::vec3(bounds.centerX[index], bounds.centerY[index], bounds.centerZ[index]);
+}
+
+static glm::vec3 objectExtent(const CullingBounds& bounds, uint32_t index) {
+	return glm::vec3(bounds.extentX[index], bounds.extentY[index], bounds.extentZ[index]);
+}
+
+// Builds the tree over every box of bounds (binned SAH)
+void BVH::Build(const CullingBounds& bounds) {
+	PROFILE_ZONE("BVH::Build");
+	uint32_t objectCount = (uint32_t)bounds.Size();
+	objects.resize(objectCount);
+	std::iota(objects.begin(), objects.end(), 0u);
+	nodes.clear();
+	stats.leaves = 0;
+	stats.depth = 0;
+	stats.builds++;
+	if (objectCount == 0) {
+		stats.nodes = 0;
+		stats.cost = stats.builtCost = 0.0f;
+		return;
+	}
+	nodes.reserve((size_t)objectCount * 2);
+	nodes.push_back({ glm::vec3(0.0f), 0, glm::vec3(0.0f), objectCount });
+
+	// The boxes are gathered out of the SoA arrays once, so splitting reads one record per object
+	struct Box {
+		glm::vec3 min, max, centroid;
+	};
+	std::vector<Box> boxes(objectCount);
+	for (uint32_t i = 0; i < objectCount; i++) {
+		glm::vec3 center = objectCenter(bounds, i);
+		glm::vec3 extent = objectExtent(bounds, i);
+		boxes[i] = { center - extent, center + extent, center };
+	}
+
+	struct Bin {
+		glm::vec3 min, max;
+		uint32_t count;
+	};
+
+	// Nodes are split top-down; each one arrives here holding its object range and leaves as a
+	// leaf or with two children
+	std::vector<std::pair<uint32_t, unsigned int>> pending = { { 0u, 1u } };
+	while (!pending.empty()) {
+		uint32_t index = pending.back().first;
+		unsigned int depth = pending.back().second;
+		pending.pop_back();
+		stats.depth = std::max(stats.depth, depth);
+
+		uint32_t first = nodes[index].leftFirst;
+		uint32_t count = nodes[index].count;
+		glm::vec3 boxMin(FLT_MAX), boxMax(-FLT_MAX), centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+		for (uint32_t i = first; i < first + count; i++) {
+			const Box& box = boxes[objects[i]];
+			boxMin = glm::min(boxMin, box.min);
+			boxMax = glm::max(boxMax, box.max);
+			centroidMin = glm::min(centroidMin, box.centroid);
+			centroidMax = glm::max(centroidMax, box.centroid);
+		}
+		nodes[index].min = boxMin;
+		nodes[index].max = boxMax;
+
+		// Bins every object along all three axes in one pass (axes whose centroids coincide are skipped);
+		// small nodes get fewer bins, since most would stay empty and sweeping them dominates the build
+		int binCount = (int)std::min(count, (uint32_t)SAH_BINS);
+		glm::vec3 range = centroidMax - centroidMin;
+		glm::vec3 scale;
+		Bin bins[3][SAH_BINS];
+		for (int axis = 0; axis < 3; axis++) {
+			scale[axis] = range[axis] > 0.0f ? binCount / range[axis] : 0.0f;
+			for (int b = 0; b < binCount; b++) {
+				bins[axis][b] = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), 0 };
+			}
+		}
+		if (count > 1) {
+			for (uint32_t i = first; i < first + count; i++) {
+				const Box& box = boxes[objects[i]];
+				for (int axis = 0; axis < 3; axis++) {
+					Bin& bin = bins[axis][std::min((int)((box.centroid[axis] - centroidMin[axis]) * scale[axis]), binCount - 1)];
+					bin.min = glm::min(bin.min, box.min);
+					bin.max = glm::max(bin.max, box.max);
+					bin.count++;
+				}
+			}
+		}
+
+		// Cheapest split over every bin boundary of every axis, with costs scaled by the node's area
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float bestCost = FLT_MAX;
+		for (int axis = 0; axis < 3 && count > 1; axis++) {
+			if (scale[axis] == 0.0f) {
+				continue;
+			}
+
+			// Left sides swept forward, right sides backward; split s puts bins [0, s) on the left
+			float leftArea[SAH_BINS];
+			uint32_t leftCount[SAH_BINS];
+			glm::vec3 sideMin(FLT_MAX), sideMax(-FLT_MAX);
+			uint32_t sideCount = 0;
+			for (int s = 1; s < binCount; s++) {
+				sideMin = glm::min(sideMin, bins[axis][s - 1].min);
+				sideMax = glm::max(sideMax, bins[axis][s - 1].max);
+				sideCount += bins[axis][s - 1].count;
+				leftArea[s] = surfaceArea(sideMin, sideMax);
+				leftCount[s] = sideCount;
+			}
+			sideMin = glm::vec3(FLT_MAX);
+			sideMax = glm::vec3(-FLT_MAX);
+			sideCount = 0;
+			for (int s = binCount - 1; s >= 1; s--) {
+				sideMin = glm::min(sideMin, bins[axis][s].min);
+				sideMax = glm::max(sideMax, bins[axis][s].max);
+				sideCount += bins[axis][s].count;
+				if (leftCount[s] == 0 || sideCount == 0) {
+					continue;
+				}
+				float splitCost = leftCount[s] * leftArea[s] + sideCount * surfaceArea(sideMin, sideMax);
+				if (splitCost < bestCost) {
+					bestCost = splitCost;
+					bestAxis = axis;
+					bestSplit = s;
+				}
+			}
+		}
+
+		float nodeArea = surfaceArea(boxMin, boxMax);
+		bool split = bestAxis >= 0 && SAH_TRAVERSAL_COST * nodeArea + bestCost < count * nodeArea;
+		if (!split && count <= BVH_MAX_LEAF_SIZE) {
+			stats.leaves++;
+			continue;
+		}
+
+		// Partition the range by the chosen bin boundary; objects whose centroids all coincide are
+		// split in the middle instead
+		uint32_t middle = first + count / 2;
+		if (bestAxis >= 0) {
+			float minimum = centroidMin[bestAxis];
+			float axisScale = scale[bestAxis];
+			middle = (uint32_t)(std::partition(objects.begin() + first, objects.begin() + first + count, [&](uint32_t object) {
+				return std::min((int)((boxes[object].centroid[bestAxis] - minimum) * axisScale), binCount - 1) < bestSplit;
+			}) - objects.begin());
+		}
+
+		uint32_t left = (uint32_t)nodes.size();
+		nodes.push_back({ glm::vec3(0.0f), first, glm::vec3(0.0f), middle - first });
+		nodes.push_back({ glm::vec3(0.0f), middle, glm::vec3(0.0f), first + count - middle });
+		nodes[index].leftFirst = left;
+		nodes[index].count = 0;
+		pending.push_back({ left + 1, depth + 1 });
+		pending.push_back({ left, depth + 1 });
+	}
+
+	stats.nodes = nodes.size();
+	stats.cost = stats.builtCost = cost();
+}
+
+// Recomputes every node box bottom-up after objects moved, keeping the tree's topology
+void BVH::Refit(const CullingBounds& bounds) {
+	PROFILE_ZONE("BVH::Refit");
+	// Children always come after their parent, so one backward pass sees them first
+	for (size_t i = nodes.size(); i-- > 0;) {
+		BVHNode& node = nodes[i];
+		if (node.count > 0) {
+			node.min = glm::vec3(FLT_MAX);
+			node.max = glm::vec3(-FLT_MAX);
+			for (uint32_t o = node.leftFirst; o < node.leftFirst + node.count; o++) {
+				glm::vec3 center = objectCenter(bounds, objects[o]);
+				glm::vec3 extent = objectExtent(bounds, objects[o]);
+				node.min = glm::min(node.min, center - extent);
+				node.max = glm::max(node.max, center + extent);
+			}
+		}
+		else {
+			const BVHNode& left = nodes[node.leftFirst];
+			const BVHNode& right = nodes[node.leftFirst + 1];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+		}
+	}
+	stats.refits++;
+	stats.cost = cost();
+}
+
+// Refits, or rebuilds when the object count changed or the SAH cost has grown past the rebuild
+// threshold times its cost after the last build. Returns true if it rebuilt
+bool BVH::Update(const CullingBounds& bounds) {
+	if (objects.size() != bounds.Size() || nodes.empty()) {
+		Build(bounds);
+		return true;
+	}
+	Refit(bounds);
+	if (stats.cost > rebuildThreshold * stats.builtCost) {
+		Build(bounds);
+		return true;
+	}
+	return false;
+}
+
+// SAH cost of the current node boxes
+float BVH::cost() const {
+	if (nodes.empty()) {
+		return 0.0f;
+	}
+	float rootArea = surfaceArea(nodes[0].min, nodes[0].max);
+	if (rootArea <= 0.0f) {
+		return 0.0f;
+	}
+	float total = 0.0f;
+	for (const BVHNode& node : nodes) {
+		total += surfaceArea(node.min, node.max) * (node.count > 0 ? (float)node.count : SAH_TRAVERSAL_COST);
+	}
+	return total / rootArea;
+}
+
+// The objects of a subtree are contiguous: from its leftmost leaf's first to its rightmost leaf's last
+static void subtreeObjects(const std::vector<BVHNode>& nodes, uint32_t index, uint32_t& first, uint32_t& end) {
+	uint32_t left = index, right = index;
+	while (nodes[left].count == 0) {
+		left = nodes[left].leftFirst;
+	}
+	while (nodes[right].count == 0) {
+		right = nodes[right].leftFirst + 1;
+	}
+	first = nodes[left].leftFirst;
+	end = nodes[right].leftFirst + nodes[right].count;
+}
+
+// Writes the indices of the boxes inside or touching the frustum to visible (room for
+// bounds.Size() entries) in tree order, and returns how many there are. Subtrees outside the
+// frustum are skipped and subtrees inside it are taken without testing their objects
+size_t BVH::Cull(const Frustum& frustum, const CullingBounds& bounds, uint32_t* visible) const {
+	PROFILE_ZONE("BVH::Cull");
+	if (nodes.empty()) {
+		return 0;
+	}
+	glm::vec3 normals[6], absNormals[6];
+	for (int p = 0; p < 6; p++) {
+		normals[p] = glm::vec3(frustum.planes[p]);
+		absNormals[p] = glm::abs(normals[p]);
+	}
+
+	// Each entry carries the planes its node still straddles; a node entirely inside a plane
+	// drops it for the whole subtree
+	struct Entry {
+		uint32_t node;
+		uint32_t planes;
+	};
+	std::vector<Entry> pending;
+	pending.reserve(64);
+	pending.push_back({ 0u, 0x3Fu });
+	size_t written = 0;
+	while (!pending.empty()) {
+		Entry entry = pending.back();
+		pending.pop_back();
+		const BVHNode& node = nodes[entry.node];
+		glm::vec3 center = (node.min + node.max) * 0.5f;
+		glm::vec3 extent = (node.max - node.min) * 0.5f;
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; p++) {
+			if (entry.planes & (1u << p)) {
+				float distance = glm::dot(normals[p], center) + frustum.planes[p].w;
+				float reach = glm::dot(absNormals[p], extent);
+				outside = distance + reach < 0.0f;
+				if (distance - reach >= 0.0f) {
+					entry.planes &= ~(1u << p);
+				}
+			}
+		}
+		if (outside) {
+			continue;
+		}
+
+		if (entry.planes == 0) {
+			uint32_t first, end;
+			subtreeObjects(nodes, entry.node, first, end);
+			std::copy(objects.begin() + first, objects.begin() + end, visible + written);
+			written += end - first;
+		}
+		else if (node.count > 0) {
+			for (uint32_t o = node.leftFirst; o < node.leftFirst + node.count; o++) {
+				uint32_t object = objects[o];
+				glm::vec3 boxCenter = objectCenter(bounds, object);
+				glm::vec3 boxExtent = objectExtent(bounds, object);
+				bool inside = true;
+				for (int p = 0; p < 6 && inside; p++) {
+					if (entry.planes & (1u << p)) {
+						inside = glm::dot(normals[p], boxCenter) + frustum.planes[p].w + glm::dot(absNormals[p], boxExtent) >= 0.0f;
+					}
+				}
+				visible[written] = object;
+				written += inside ? 1 : 0;
+			}
+		}
+		else {
+			pending.push_back({ node.leftFirst + 1, entry.planes });
+			pending.push_back({ node.leftFirst, entry.planes });
+		}
+	}
+	return written;
+}
+
+// Distance at which the ray enters the box (0 if it starts inside), or FLT_MAX if it misses
+static float rayEnters(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection) {
+	glm::vec3 t0 = (min - origin) * inverseDirection;
+	glm::vec3 t1 = (max - origin) * inverseDirection;
+	glm::vec3 entries = glm::min(t0, t1);
+	glm::vec3 exits = glm::max(t0, t1);
+	float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+	float exit = std::min(std::min(exits.x, exits.y), exits.z);
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+// Finds the nearest box the ray from origin along direction enters within maxDistance (e.g. a
+// Camera::CursorRay() from Camera::Position, for picking). Returns false if it hits nothing
+bool BVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, const CullingBounds& bounds, float maxDistance, RayHit& hit) const {
+	PROFILE_ZONE("BVH::Raycast");
+	hit = RayHit();
+	if (nodes.empty()) {
+		return false;
+	}
+	glm::vec3 inverseDirection = 1.0f / direction;
+	float nearest = maxDistance;
+
+	// Entries carry the distance at which the ray entered their node, so nodes behind the nearest
+	// hit so far are dropped when popped; the nearer child is always visited first
+	std::vector<std::pair<uint32_t, float>> pending;
+	pending.reserve(64);
+	float rootEnter = rayEnters(nodes[0].min, nodes[0].max, origin, inverseDirection);
+	if (rootEnter < nearest) {
+		pending.push_back({ 0u, rootEnter });
+	}
+	while (!pending.empty()) {
+		std::pair<uint32_t, float> entry = pending.back();
+		pending.pop_back();
+		if (entry.second >= nearest) {
+			continue;
+		}
+		const BVHNode& node = nodes[entry.first];
+		if (node.count > 0) {
+			for (uint32_t o = node.leftFirst; o < node.leftFirst + node.count; o++) {
+				glm::vec3 center = objectCenter(bounds, objects[o]);
+				glm::vec3 extent = objectExtent(bounds, objects[o]);
+				float distance = rayEnters(center - extent, center + extent, origin, inverseDirection);
+				if (distance < nearest) {
+					nearest = distance;
+					hit.index = objects[o];
+				}
+			}
+			continue;
+		}
+		uint32_t first = node.leftFirst, second = node.leftFirst + 1;
+		float firstEnter = rayEnters(nodes[first].min, nodes[first].max, origin, inverseDirection);
+		float secondEnter = rayEnters(nodes[second].min, nodes[second].max, origin, inverseDirection);
+		if (secondEnter < firstEnter) {
+			std::swap(first, second);
+			std::swap(firstEnter, secondEnter);
+		}
+		if (secondEnter < nearest) {
+			pending.push_back({ second, secondEnter });
+		}
+		if (firstEnter < nearest) {
+			pending.push_back({ first, firstEnter });
+		}
+	}
+	hit.distance = nearest;
+	return hit.index != RayHit().index;
+}
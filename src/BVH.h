@@ -0,0 +1,81 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "FrustumCulling.h"
+
+// One node in 32 bytes, so two siblings share a cache line. Children are allocated in pairs
+// (right = left + 1) and always after their parent; the objects of every subtree are contiguous
+// in the BVH's object order
+struct BVHNode {
+	glm::vec3 min;
+	uint32_t leftFirst;   // interior: index of the left child; leaf: first entry in the object order
+	glm::vec3 max;
+	uint32_t count;       // objects in a leaf, 0 for interior nodes
+};
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode should stay 32 bytes");
+
+// Nearest object a ray hit
+struct RayHit {
+	uint32_t index = 0xFFFFFFFFu;   // into the CullingBounds the BVH was built from
+	float distance = 0.0f;          // along the ray, in units of the direction's length
+};
+
+// Bounding volume hierarchy over the boxes of a CullingBounds, built with the surface area
+// heuristic. Objects that move are handled by refitting the existing tree, which keeps the
+// topology and only grows or shrinks node boxes; Update() rebuilds once refitting has made the
+// tree too loose. Queries take the same CullingBounds, so leaves test each object's own box
+class BVH {
+public:
+	// Shape and history of the tree
+	struct Stats {
+		size_t nodes = 0;
+		size_t leaves = 0;
+		unsigned int depth = 0;
+		float cost = 0.0f;        // SAH cost now, relative to one box test at the root
+		float builtCost = 0.0f;   // SAH cost right after the last build
+		unsigned int builds = 0;
+		unsigned int refits = 0;
+	};
+
+	Stats stats;
+
+	// Builds the tree over every box of bounds (binned SAH)
+	void Build(const CullingBounds& bounds);
+
+	// Recomputes every node box bottom-up after objects moved, keeping the tree's topology
+	void Refit(const CullingBounds& bounds);
+
+	// Refits, or rebuilds when the object count changed or the SAH cost has grown past the rebuild
+	// threshold times its cost after the last build. Returns true if it rebuilt
+	bool Update(const CullingBounds& bounds);
+
+	// Cost ratio at which Update() rebuilds instead of refitting
+	void SetRebuildThreshold(float threshold) { rebuildThreshold = threshold; }
+
+	// Writes the indices of the boxes inside or touching the frustum to visible (room for
+	// bounds.Size() entries) in tree order, and returns how many there are. Subtrees outside the
+	// frustum are skipped and subtrees inside it are taken without testing their objects
+	size_t Cull(const Frustum& frustum, const CullingBounds& bounds, uint32_t* visible) const;
+
+	// Finds the nearest box the ray from origin along direction enters within maxDistance (e.g. a
+	// Camera::CursorRay() from Camera::Position, for picking). Returns false if it hits nothing
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, const CullingBounds& bounds, float maxDistance, RayHit& hit) const;
+
+	const std::vector<BVHNode>& Nodes() const { return nodes; }
+
+private:
+	std::vector<BVHNode> nodes;
+	std::vector<uint32_t> objects;   // object indices, ordered so every leaf is a contiguous range
+	float rebuildThreshold = 1.5f;
+
+	// SAH cost of the current node boxes
+	float cost() const;
+};
+
+#endif
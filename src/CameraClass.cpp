@@ -1,4 +1,5 @@
 #include "CameraClass.h"
+#include "Profiler.h"
 
 Camera::Camera(int width, int height, glm::vec3 position) {
 	Camera::width = width;
@@ -6,24 +7,40 @@ Camera::Camera(int width, int height, glm::vec3 position) {
 	Position = position;
 }
 
-// Exports the camera matrix to the Vertex Shader
-void Camera::Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, const char* uniform) {
-	// Initializes matrices
-	glm::mat4 view = glm::mat4(1.0f);
-	glm::mat4 proj = glm::mat4(1.0f);
-
+// Returns the projection times view matrix (what Matrix() exports, e.g. for frustum culling)
+glm::mat4 Camera::ViewProjection(float FOVdeg, float nearPlane, float farPlane) const {
 	// Creates camera view matrix
-	view = glm::lookAt(Position, Position + Orientation, UpVector);
+	glm::mat4 view = glm::lookAt(Position, Position + Orientation, UpVector);
 
 	// Creates camera projection matrix
-	proj = glm::perspective(glm::radians(FOVdeg), width / float(height), nearPlane, farPlane);
+	glm::mat4 proj = glm::perspective(glm::radians(FOVdeg), width / float(height), nearPlane, farPlane);
+
+	return proj * view;
+}
+
+// Returns the world-space direction from Position through a cursor position in pixels (origin at
+// the top left, as glfwGetCursorPos reports it), for picking
+glm::vec3 Camera::CursorRay(double cursorX, double cursorY, float FOVdeg, float nearPlane, float farPlane) const {
+	// Unprojects the cursor on the near and far planes
+	glm::vec2 ndc(2.0f * (float)cursorX / width - 1.0f, 1.0f - 2.0f * (float)cursorY / height);
+	glm::mat4 inverse = glm::inverse(ViewProjection(FOVdeg, nearPlane, farPlane));
+	glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+	return glm::normalize(glm::vec3(farPoint) / farPoint.w - glm::vec3(nearPoint) / nearPoint.w);
+}
+
+// Exports the camera matrix to the Vertex Shader
+void Camera::Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, UniformName uniform) {
+	PROFILE_ZONE("Camera::Matrix");
 
 	// Exports matrices to the Vertex Shader
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, uniform), 1, GL_FALSE, glm::value_ptr(proj * view));
+	shader.SetMat4(uniform, ViewProjection(FOVdeg, nearPlane, farPlane));
 }
 
 // Handles camera inputs
 void Camera::Inputs(GLFWwindow* window) {
+	PROFILE_ZONE("Camera::Inputs");
+
 	// Handles key inputs
 	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
 		Position += cameraSpeed * Orientation;
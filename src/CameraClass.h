@@ -33,8 +33,15 @@ public:
 	// Constructor
 	Camera(int width, int height, glm::vec3 position);
 
+	// Returns the projection times view matrix (what Matrix() exports, e.g. for frustum culling)
+	glm::mat4 ViewProjection(float FOVdeg, float nearPlane, float farPlane) const;
+
+	// Returns the world-space direction from Position through a cursor position in pixels (origin at
+	// the top left, as glfwGetCursorPos reports it), for picking
+	glm::vec3 CursorRay(double cursorX, double cursorY, float FOVdeg, float nearPlane, float farPlane) const;
+
 	// Exports the camera matrix to the Vertex Shader
-	void Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, const char* uniform);
+	void Matrix(float FOVdeg, float nearPlane, float farPlane, Shader& shader, UniformName uniform);
 
 	// Handles camera inputs
 	void Inputs(GLFWwindow* window);
@@ -0,0 +1,232 @@
+#include "CookedMesh.h"
+#include "EBO.h"
+#include "Hash.h"
+#include "Profiler.h"
+#include "VertexLayout.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char COOKED_MESH_MAGIC[4] = { 'C', 'M', 'S', 'H' };
+
+// Sections beyond this are rejected as corrupt
+static const uint32_t COOKED_MESH_MAX_SECTIONS = 32;
+
+// Returns true if the path names a cooked mesh (.cmesh)
+bool IsCookedMeshPath(const char* path) {
+	size_t length = std::strlen(path);
+	return length > 6 && std::strcmp(path + length - 6, ".cmesh") == 0;
+}
+
+static bool validHeader(const CookedMeshHeader& header) {
+	return std::memcmp(header.magic, COOKED_MESH_MAGIC, 4) == 0 && header.version == COOKED_MESH_VERSION &&
+		header.sectionCount <= COOKED_MESH_MAX_SECTIONS;
+}
+
+// Reads only the header (e.g. to check whether a cooked file is up to date)
+bool ReadCookedMeshHeader(const char* path, CookedMeshHeader& header) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	in.read((char*)&header, sizeof(header));
+	return in && validHeader(header);
+}
+
+// Appends a section to the file image, aligned, and records it in the table
+static void appendSection(std::vector<unsigned char>& image, std::vector<CookedMeshSection>& table, uint32_t type, uint32_t elementSize,
+	const void* data, size_t size) {
+	if (size == 0) {
+		return;
+	}
+	size_t offset = (image.size() + COOKED_MESH_ALIGNMENT - 1) & ~(COOKED_MESH_ALIGNMENT - 1);
+	image.resize(offset + size);
+	std::memcpy(image.data() + offset, data, size);
+	table.push_back({ type, elementSize, (uint64_t)offset, (uint64_t)size });
+}
+
+// Writes a cooked mesh, with a checksum when asked
+bool WriteCookedMesh(const char* path, const CookedMeshContents& contents, bool checksum) {
+	CookedMeshHeader header = {};
+	std::memcpy(header.magic, COOKED_MESH_MAGIC, 4);
+	header.version = COOKED_MESH_VERSION;
+	header.sourceHash = contents.sourceHash;
+	header.flags = contents.flags;
+	header.vertexCount = contents.vertexCount;
+	header.vertexStride = (uint32_t)contents.format.stride;
+	header.indexCount = contents.indexCount;
+	for (int i = 0; i < 3; i++) {
+		header.boundsMin[i] = contents.boundsMin[i];
+		header.boundsMax[i] = contents.boundsMax[i];
+		header.positionOffset[i] = contents.positionOffset[i];
+		header.positionScale[i] = contents.positionScale[i];
+	}
+
+	std::vector<CookedMeshAttribute> attributes;
+	for (const VertexAttribute& attribute : contents.format.attributes) {
+		attributes.push_back({ attribute.location, (uint32_t)attribute.components, attribute.type, attribute.normalized, attribute.offset });
+	}
+
+	// Indices are stored in the type they will be drawn with, so loading never converts them
+	header.indexType = EBO::IndexTypeFor(contents.indices, contents.indexCount);
+	std::vector<GLushort> narrow;
+	const void* indexData = contents.indices;
+	uint32_t indexSize = sizeof(GLuint);
+	if (header.indexType == GL_UNSIGNED_SHORT) {
+		narrow.assign(contents.indices, contents.indices + contents.indexCount);
+		indexData = narrow.data();
+		indexSize = sizeof(GLushort);
+	}
+
+	std::vector<CookedMeshLod> lods = contents.lods;
+	if (lods.empty()) {
+		uint32_t meshletCount = contents.meshlets ? (uint32_t)contents.meshlets->meshlets.size() : 0;
+		lods.push_back({ 0, contents.indexCount, 0, meshletCount, 0.0f, 0 });
+	}
+
+	// The table is written before the sections, so its size is known up front
+	uint32_t sectionCount = 4;
+	if (contents.meshlets && !contents.meshlets->meshlets.empty()) {
+		sectionCount += 3;
+	}
+	std::vector<unsigned char> image(sizeof(CookedMeshHeader) + sectionCount * sizeof(CookedMeshSection));
+	std::vector<CookedMeshSection> table;
+	appendSection(image, table, COOKED_MESH_ATTRIBUTES, sizeof(CookedMeshAttribute), attributes.data(), attributes.size() * sizeof(CookedMeshAttribute));
+	appendSection(image, table, COOKED_MESH_VERTICES, header.vertexStride, contents.vertices, (size_t)contents.vertexCount * header.vertexStride);
+	appendSection(image, table, COOKED_MESH_INDICES, indexSize, indexData, (size_t)contents.indexCount * indexSize);
+	appendSection(image, table, COOKED_MESH_LODS, sizeof(CookedMeshLod), lods.data(), lods.size() * sizeof(CookedMeshLod));
+	if (sectionCount > 4) {
+		const MeshletData& meshlets = *contents.meshlets;
+		appendSection(image, table, COOKED_MESH_MESHLETS, sizeof(Meshlet), meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(Meshlet));
+		appendSection(image, table, COOKED_MESH_MESHLET_VERTICES, sizeof(uint32_t), meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+		appendSection(image, table, COOKED_MESH_MESHLET_TRIANGLES, 1, meshlets.triangles.data(), meshlets.triangles.size());
+	}
+	if (table.size() != sectionCount) {
+		std::cerr << "Cannot cook an empty mesh: " << path << std::endl;
+		return false;
+	}
+
+	// Pad the end so the last section is a whole number of alignment blocks too
+	image.resize((image.size() + COOKED_MESH_ALIGNMENT - 1) & ~(COOKED_MESH_ALIGNMENT - 1));
+	header.sectionCount = sectionCount;
+	header.fileSize = image.size();
+	std::memcpy(image.data() + sizeof(CookedMeshHeader), table.data(), table.size() * sizeof(CookedMeshSection));
+	if (checksum) {
+		header.checksum = fnv1a64(image.data() + sizeof(CookedMeshHeader), image.size() - sizeof(CookedMeshHeader));
+	}
+	std::memcpy(image.data(), &header, sizeof(header));
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		std::cerr << "Failed to write cooked mesh: " << path << std::endl;
+		return false;
+	}
+	out.write((const char*)image.data(), image.size());
+	return (bool)out;
+}
+
+// Maps and validates a cooked mesh
+bool CookedMesh::Open(const char* path, bool verifyChecksum) {
+	PROFILE_ZONE("CookedMesh::Open");
+	Close();
+	if (!file.Open(path)) {
+		return false;
+	}
+	if (file.Size() < sizeof(CookedMeshHeader)) {
+		std::cerr << "Truncated cooked mesh: " << path << std::endl;
+		Close();
+		return false;
+	}
+	std::memcpy(&header, file.Data(), sizeof(CookedMeshHeader));
+	if (std::memcmp(header.magic, COOKED_MESH_MAGIC, 4) != 0) {
+		std::cerr << "Not a cooked mesh: " << path << std::endl;
+		Close();
+		return false;
+	}
+	if (header.version != COOKED_MESH_VERSION) {
+		std::cerr << "Cooked mesh " << path << " has version " << header.version << ", expected " << COOKED_MESH_VERSION << " (re-cook it)" << std::endl;
+		Close();
+		return false;
+	}
+	size_t tableEnd = sizeof(CookedMeshHeader) + (size_t)header.sectionCount * sizeof(CookedMeshSection);
+	if (header.fileSize != file.Size() || !validHeader(header) || tableEnd > file.Size()) {
+		std::cerr << "Truncated or corrupt cooked mesh: " << path << std::endl;
+		Close();
+		return false;
+	}
+
+	// Every section must lie inside the file, aligned, and hold whole elements of the right size;
+	// unknown section types are skipped so older runtimes can read files with extra sections
+	const CookedMeshSection* table = (const CookedMeshSection*)(file.Data() + sizeof(CookedMeshHeader));
+	bool valid = true;
+	for (uint32_t s = 0; s < header.sectionCount && valid; s++) {
+		const CookedMeshSection& section = table[s];
+		valid = section.offset % COOKED_MESH_ALIGNMENT == 0 && section.offset >= tableEnd && section.offset <= file.Size() &&
+			section.size <= file.Size() - section.offset && section.elementSize > 0 && section.size % section.elementSize == 0;
+		CookedMeshSection* slot = nullptr;
+		uint32_t expectedSize = section.elementSize;
+		switch (section.type) {
+		case COOKED_MESH_ATTRIBUTES: slot = &attributes; expectedSize = sizeof(CookedMeshAttribute); break;
+		case COOKED_MESH_VERTICES: slot = &vertices; expectedSize = header.vertexStride; break;
+		case COOKED_MESH_INDICES: slot = &indices; expectedSize = header.indexType == GL_UNSIGNED_SHORT ? 2 : 4; break;
+		case COOKED_MESH_LODS: slot = &lods; expectedSize = sizeof(CookedMeshLod); break;
+		case COOKED_MESH_MESHLETS: slot = &meshlets; expectedSize = sizeof(Meshlet); break;
+		case COOKED_MESH_MESHLET_VERTICES: slot = &meshletVertices; expectedSize = sizeof(uint32_t); break;
+		case COOKED_MESH_MESHLET_TRIANGLES: slot = &meshletTriangles; expectedSize = 1; break;
+		}
+		valid = valid && section.elementSize == expectedSize;
+		if (slot) {
+			*slot = section;
+		}
+	}
+
+	// Counts in the header must agree with the sections, and every range must point inside its target
+	valid = valid && attributes.size > 0 && vertices.size > 0 && indices.size > 0 && lods.size > 0 && (header.indexType == GL_UNSIGNED_SHORT || header.indexType == GL_UNSIGNED_INT) &&
+		vertices.size == (uint64_t)header.vertexCount * header.vertexStride && indices.size / indices.elementSize == header.indexCount;
+	for (size_t a = 0; valid && a < attributes.size / sizeof(CookedMeshAttribute); a++) {
+		const CookedMeshAttribute& attribute = ((const CookedMeshAttribute*)data(attributes))[a];
+		VertexAttribute check = { attribute.location, (GLint)attribute.components, attribute.type, (GLboolean)attribute.normalized, attribute.offset };
+		valid = attribute.components >= 1 && attribute.components <= 4 && attribute.offset + VertexAttributeBytes(check) <= header.vertexStride;
+	}
+	for (size_t l = 0; valid && l < LodCount(); l++) {
+		const CookedMeshLod& lod = Lods()[l];
+		valid = (uint64_t)lod.firstIndex + lod.indexCount <= header.indexCount && (uint64_t)lod.firstMeshlet + lod.meshletCount <= MeshletCount();
+	}
+	for (size_t m = 0; valid && m < MeshletCount(); m++) {
+		const Meshlet& meshlet = Meshlets()[m];
+		valid = (uint64_t)meshlet.vertexOffset + meshlet.vertexCount <= meshletVertices.size / sizeof(uint32_t) &&
+			(uint64_t)meshlet.triangleOffset + meshlet.triangleCount * 3ull <= meshletTriangles.size;
+	}
+	if (!valid) {
+		std::cerr << "Corrupt cooked mesh: " << path << std::endl;
+		Close();
+		return false;
+	}
+
+	if (verifyChecksum && header.checksum != 0 &&
+		fnv1a64(file.Data() + sizeof(CookedMeshHeader), file.Size() - sizeof(CookedMeshHeader)) != header.checksum) {
+		std::cerr << "Checksum mismatch in cooked mesh: " << path << std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// Unmaps the file
+void CookedMesh::Close() {
+	file.Close();
+	header = {};
+	attributes = vertices = indices = lods = meshlets = meshletVertices = meshletTriangles = {};
+}
+
+// Rebuilds the vertex layout from the attribute section
+VertexFormat CookedMesh::Format() const {
+	VertexFormat format;
+	format.stride = (GLsizei)header.vertexStride;
+	for (size_t a = 0; a < attributes.size / sizeof(CookedMeshAttribute); a++) {
+		const CookedMeshAttribute& attribute = ((const CookedMeshAttribute*)data(attributes))[a];
+		format.attributes.push_back({ attribute.location, (GLint)attribute.components, attribute.type, (GLboolean)attribute.normalized, attribute.offset });
+	}
+	return format;
+}
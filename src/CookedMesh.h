@@ -0,0 +1,152 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "VertexFormat.h"
+
+// Cooked mesh file (.cmesh) written by the AssetCooker, laid out so it can be memory-mapped and its
+// sections handed straight to glBufferData without parsing or copying:
+//   CookedMeshHeader
+//   CookedMeshSection[sectionCount]
+//   section data, each section aligned to COOKED_MESH_ALIGNMENT bytes
+// Everything is little endian. Sections a mesh doesn't have are left out of the table.
+struct CookedMeshHeader {
+	char magic[4];         // "CMSH"
+	uint32_t version;
+	uint64_t fileSize;     // catches truncated files without touching the data
+	uint64_t sourceHash;   // hash of the source mesh and cook settings, for incremental cooking
+	uint64_t checksum;     // FNV-1a of everything after the header, 0 when not computed
+	uint32_t sectionCount;
+	uint32_t flags;        // COOKED_MESH_* flags
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	uint32_t indexType;    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	float boundsMin[3];
+	float boundsMax[3];
+	float positionOffset[3]; // quantized positions decode as positionOffset + position * positionScale
+	float positionScale[3];
+};
+
+// What a section holds; the element size of each is fixed (see CookedMesh::Open)
+enum CookedMeshSectionType : uint32_t {
+	COOKED_MESH_ATTRIBUTES = 1,        // CookedMeshAttribute[]
+	COOKED_MESH_VERTICES = 2,          // vertexCount * vertexStride bytes, interleaved
+	COOKED_MESH_INDICES = 3,           // indexCount indices of indexType
+	COOKED_MESH_LODS = 4,              // CookedMeshLod[], finest first
+	COOKED_MESH_MESHLETS = 5,          // Meshlet[]
+	COOKED_MESH_MESHLET_VERTICES = 6,  // uint32_t[]
+	COOKED_MESH_MESHLET_TRIANGLES = 7, // uint8_t[], three per triangle
+};
+
+struct CookedMeshSection {
+	uint32_t type;
+	uint32_t elementSize;
+	uint64_t offset;       // from the start of the file
+	uint64_t size;         // in bytes, a multiple of elementSize
+};
+
+// One vertex attribute (VertexAttribute with fixed-size fields)
+struct CookedMeshAttribute {
+	uint32_t location;
+	uint32_t components;
+	uint32_t type;
+	uint32_t normalized;
+	uint32_t offset;
+};
+
+// A range of the index section drawn at one level of detail, with its meshlets
+struct CookedMeshLod {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+	float error;           // object-space error of the level, 0 for the source mesh
+	uint32_t reserved;
+};
+
+// Positions are QuantizedVertex-style unorm16 (draw with quantized.vert and positionOffset / positionScale)
+static const uint32_t COOKED_MESH_QUANTIZED = 1;
+
+static const uint32_t COOKED_MESH_VERSION = 1;
+static const size_t COOKED_MESH_ALIGNMENT = 64;
+
+// Everything a cooked mesh is written from
+struct CookedMeshContents {
+	const void* vertices = nullptr;
+	uint32_t vertexCount = 0;
+	VertexFormat format;
+	const GLuint* indices = nullptr;   // narrowed to 16 bits in the file when they fit
+	uint32_t indexCount = 0;
+	std::vector<CookedMeshLod> lods;   // empty: one level covering every index
+	const MeshletData* meshlets = nullptr;
+	uint32_t flags = 0;
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+	glm::vec3 positionScale = glm::vec3(1.0f);
+	uint64_t sourceHash = 0;
+};
+
+// Returns true if the path names a cooked mesh (.cmesh)
+bool IsCookedMeshPath(const char* path);
+
+// Reads only the header (e.g. to check whether a cooked file is up to date)
+bool ReadCookedMeshHeader(const char* path, CookedMeshHeader& header);
+
+// Writes a cooked mesh, with a checksum when asked
+bool WriteCookedMesh(const char* path, const CookedMeshContents& contents, bool checksum = true);
+
+// A memory-mapped cooked mesh. Open() only checks the header and section table, so opening costs
+// the same for any mesh size; the data pages are read when the sections are first touched
+class CookedMesh {
+public:
+	// Maps and validates a cooked mesh; verifyChecksum also hashes the whole file
+	bool Open(const char* path, bool verifyChecksum = false);
+
+	// Unmaps the file
+	void Close();
+
+	const CookedMeshHeader& Header() const { return header; }
+
+	// Interleaved vertices and their layout
+	const void* Vertices() const { return data(vertices); }
+	GLsizeiptr VertexBytes() const { return (GLsizeiptr)vertices.size; }
+	VertexFormat Format() const;
+
+	// Indices, already in Header().indexType
+	const void* Indices() const { return data(indices); }
+	GLsizeiptr IndexBytes() const { return (GLsizeiptr)indices.size; }
+
+	// Levels of detail (at least one)
+	const CookedMeshLod* Lods() const { return (const CookedMeshLod*)data(lods); }
+	size_t LodCount() const { return lods.size / sizeof(CookedMeshLod); }
+
+	// Meshlets and the arrays they index (empty when the mesh was cooked without them)
+	const Meshlet* Meshlets() const { return (const Meshlet*)data(meshlets); }
+	size_t MeshletCount() const { return meshlets.size / sizeof(Meshlet); }
+	const uint32_t* MeshletVertices() const { return (const uint32_t*)data(meshletVertices); }
+	const uint8_t* MeshletTriangles() const { return (const uint8_t*)data(meshletTriangles); }
+
+private:
+	MappedFile file;
+	CookedMeshHeader header = {};
+	CookedMeshSection attributes = {};
+	CookedMeshSection vertices = {};
+	CookedMeshSection indices = {};
+	CookedMeshSection lods = {};
+	CookedMeshSection meshlets = {};
+	CookedMeshSection meshletVertices = {};
+	CookedMeshSection meshletTriangles = {};
+
+	const void* data(const CookedMeshSection& section) const { return section.size ? file.Data() + section.offset : nullptr; }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "CookedTexture.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char COOKED_TEXTURE_MAGIC[4] = { 'C', 'T', 'E', 'X' };
+
+// Returns true if the path names a cooked texture (.ctex)
+bool IsCookedTexturePath(const char* path) {
+	size_t length = std::strlen(path);
+	return length > 5 && std::strcmp(path + length - 5, ".ctex") == 0;
+}
+
+static bool validHeader(const CookedTextureHeader& header) {
+	return std::memcmp(header.magic, COOKED_TEXTURE_MAGIC, 4) == 0 && header.version == COOKED_TEXTURE_VERSION &&
+		header.levelCount > 0 && header.levelCount <= 32;
+}
+
+// Reads only the header (e.g. to check whether a cooked file is up to date)
+bool ReadCookedTextureHeader(const char* path, CookedTextureHeader& header) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	in.read((char*)&header, sizeof(header));
+	return in && validHeader(header);
+}
+
+// Reads and validates a cooked texture
+bool ReadCookedTexture(const char* path, CookedTexture& texture) {
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		std::cerr << "Failed to open cooked texture: " << path << std::endl;
+		return false;
+	}
+	texture.data.resize((size_t)in.tellg());
+	in.seekg(0, std::ios::beg);
+	in.read((char*)texture.data.data(), texture.data.size());
+
+	if (!in || texture.data.size() < sizeof(CookedTextureHeader)) {
+		std::cerr << "Truncated cooked texture: " << path << std::endl;
+		return false;
+	}
+	std::memcpy(&texture.header, texture.data.data(), sizeof(CookedTextureHeader));
+	if (!validHeader(texture.header)) {
+		std::cerr << "Invalid cooked texture: " << path << std::endl;
+		return false;
+	}
+
+	size_t tableEnd = sizeof(CookedTextureHeader) + texture.header.levelCount * sizeof(CookedTextureLevel);
+	if (texture.data.size() < tableEnd) {
+		std::cerr << "Truncated cooked texture: " << path << std::endl;
+		return false;
+	}
+	texture.levels.resize(texture.header.levelCount);
+	std::memcpy(texture.levels.data(), texture.data.data() + sizeof(CookedTextureHeader), texture.levels.size() * sizeof(CookedTextureLevel));
+	for (const CookedTextureLevel& level : texture.levels) {
+		if (level.offset + level.size > texture.data.size()) {
+			std::cerr << "Truncated cooked texture: " << path << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Writes a cooked texture; levels hold each level's blocks in order
+bool WriteCookedTexture(const char* path, uint32_t glFormat, uint64_t sourceHash,
+	const std::vector<CookedTextureLevel>& levels, const std::vector<std::vector<unsigned char>>& levelData) {
+	CookedTextureHeader header;
+	std::memcpy(header.magic, COOKED_TEXTURE_MAGIC, 4);
+	header.version = COOKED_TEXTURE_VERSION;
+	header.glFormat = glFormat;
+	header.width = levels.empty() ? 0 : levels[0].width;
+	header.height = levels.empty() ? 0 : levels[0].height;
+	header.levelCount = (uint32_t)levels.size();
+	header.sourceHash = sourceHash;
+
+	// Lay the levels out after the table, 16-byte aligned
+	std::vector<CookedTextureLevel> table = levels;
+	uint64_t offset = sizeof(CookedTextureHeader) + table.size() * sizeof(CookedTextureLevel);
+	for (size_t l = 0; l < table.size(); l++) {
+		offset = (offset + 15) & ~(uint64_t)15;
+		table[l].offset = offset;
+		table[l].size = levelData[l].size();
+		offset += table[l].size;
+	}
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		std::cerr << "Failed to write cooked texture: " << path << std::endl;
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)table.data(), table.size() * sizeof(CookedTextureLevel));
+	for (size_t l = 0; l < table.size(); l++) {
+		static const char padding[16] = {};
+		out.write(padding, table[l].offset - (uint64_t)out.tellp());
+		out.write((const char*)levelData[l].data(), levelData[l].size());
+	}
+	return (bool)out;
+}
+
+// Returns true if the current context can sample the given compressed format
+bool IsCompressedFormatSupported(GLenum glFormat) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+	std::vector<GLint> formats(count);
+	if (count > 0) {
+		glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+	}
+	for (GLint format : formats) {
+		if ((GLenum)format == glFormat) {
+			return true;
+		}
+	}
+
+	// BPTC is core since GL 4.2 and some drivers do not list it
+	return glFormat == GL_COMPRESSED_RGBA_BPTC_UNORM && GLAD_GL_VERSION_4_2;
+}
+
+// Uploads every level with glCompressedTexImage2D to the texture bound to target
+bool UploadCookedTexture(GLenum target, const CookedTexture& texture) {
+	if (!IsCompressedFormatSupported(texture.header.glFormat)) {
+		std::cerr << "Compressed texture format 0x" << std::hex << texture.header.glFormat << std::dec << " is not supported" << std::endl;
+		return false;
+	}
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+	for (size_t l = 0; l < texture.levels.size(); l++) {
+		const CookedTextureLevel& level = texture.levels[l];
+		glCompressedTexImage2D(target, (GLint)l, texture.header.glFormat, level.width, level.height, 0,
+			(GLsizei)level.size, texture.data.data() + level.offset);
+	}
+	return true;
+}
+
+// Allocates immutable storage for every level of a texture object and uploads them by name
+bool StoreCookedTexture(GLuint textureID, const CookedTexture& texture) {
+	if (!IsCompressedFormatSupported(texture.header.glFormat)) {
+		std::cerr << "Compressed texture format 0x" << std::hex << texture.header.glFormat << std::dec << " is not supported" << std::endl;
+		return false;
+	}
+	glTextureStorage2D(textureID, (GLsizei)texture.levels.size(), texture.header.glFormat, texture.header.width, texture.header.height);
+	for (size_t l = 0; l < texture.levels.size(); l++) {
+		const CookedTextureLevel& level = texture.levels[l];
+		glCompressedTextureSubImage2D(textureID, (GLint)l, 0, 0, level.width, level.height, texture.header.glFormat,
+			(GLsizei)level.size, texture.data.data() + level.offset);
+	}
+	return true;
+}
@@ -0,0 +1,69 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// S3TC formats come from EXT_texture_compression_s3tc, which is not part of the core loader
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Cooked texture file (.ctex) written by the AssetCooker:
+//   CookedTextureHeader
+//   CookedTextureLevel[levelCount]
+//   block data of every level, each level aligned to 16 bytes
+struct CookedTextureHeader {
+	char magic[4];        // "CTEX"
+	uint32_t version;
+	uint32_t glFormat;    // compressed internal format passed to glCompressedTexImage2D
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelCount;
+	uint64_t sourceHash;  // hash of the source image and cook settings, for incremental cooking
+};
+
+struct CookedTextureLevel {
+	uint32_t width;
+	uint32_t height;
+	uint64_t offset;      // from the start of the file
+	uint64_t size;
+};
+
+static const uint32_t COOKED_TEXTURE_VERSION = 1;
+
+// Cooked texture loaded in memory
+struct CookedTexture {
+	CookedTextureHeader header;
+	std::vector<CookedTextureLevel> levels;
+	std::vector<unsigned char> data; // whole file
+};
+
+// Returns true if the path names a cooked texture (.ctex)
+bool IsCookedTexturePath(const char* path);
+
+// Reads only the header (e.g. to check whether a cooked file is up to date)
+bool ReadCookedTextureHeader(const char* path, CookedTextureHeader& header);
+
+// Reads and validates a cooked texture
+bool ReadCookedTexture(const char* path, CookedTexture& texture);
+
+// Writes a cooked texture; levels hold each level's blocks in order
+bool WriteCookedTexture(const char* path, uint32_t glFormat, uint64_t sourceHash,
+	const std::vector<CookedTextureLevel>& levels, const std::vector<std::vector<unsigned char>>& levelData);
+
+// Returns true if the current context can sample the given compressed format
+bool IsCompressedFormatSupported(GLenum glFormat);
+
+// Uploads every level with glCompressedTexImage2D to the texture bound to target
+bool UploadCookedTexture(GLenum target, const CookedTexture& texture);
+
+// Allocates immutable storage for every level of a texture object and uploads them by name (GL 4.5)
+bool StoreCookedTexture(GLuint textureID, const CookedTexture& texture);
+
+#endif
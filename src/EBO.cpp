@@ -1,23 +1,90 @@
 #include "EBO.h"
+#include "GLState.h"
 
-// Constructor that generates a Element Buffer Object and links it to indices
+// Constructor that generates a Element Buffer Object and links it to indices (size in bytes)
 EBO::EBO(GLuint* indices, GLsizeiptr size) {
-	glGenBuffers(1, &ID);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+	upload(indices, (size_t)size / sizeof(GLuint));
+}
+
+// Constructor that uploads count indices already stored as type
+EBO::EBO(const void* indices, GLsizei count, GLenum type) : type(type), count(count) {
+	create(indices);
+}
+
+// Returns the narrowest index type that can hold every index
+GLenum EBO::IndexTypeFor(const GLuint* indices, size_t count) {
+	// 0xFFFF is left out so it stays free as a primitive restart index
+	for (size_t i = 0; i < count; i++) {
+		if (indices[i] >= 0xFFFF) {
+			return GL_UNSIGNED_INT;
+		}
+	}
+	return GL_UNSIGNED_SHORT;
+}
+
+// Replaces size bytes of the buffer starting at offset
+void EBO::Update(GLintptr offset, GLsizeiptr size, const void* data) {
+	if (GLState::Get().DirectStateAccess()) {
+		glNamedBufferSubData(ID, offset, size, data);
+		return;
+	}
+	GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
 }
 
 // Binds the EBO
 void EBO::Bind() {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+	GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
 }
 
 // Unbinds the EBO
 void EBO::Unbind() {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// Draws every index with the bound VAO
+void EBO::Draw(GLenum mode) {
+	glDrawElements(mode, count, type, 0);
+}
+
+// Draws every index instanceCount times
+void EBO::DrawInstanced(GLsizei instanceCount, GLenum mode) {
+	glDrawElementsInstanced(mode, count, type, 0, instanceCount);
 }
 
 // Deletes the EBO
 void EBO::Delete() {
+	GLState::Get().DeleteBuffer(ID);
 	glDeleteBuffers(1, &ID);
-}
\ No newline at end of file
+}
+
+// Generates the buffer and uploads count indices, narrowed to 16 bits when they fit
+void EBO::upload(const GLuint* indices, size_t count) {
+	type = IndexTypeFor(indices, count);
+	EBO::count = (GLsizei)count;
+	if (type == GL_UNSIGNED_SHORT) {
+		std::vector<GLushort> narrow(indices, indices + count);
+		create(narrow.data());
+	}
+	else {
+		create(indices);
+	}
+}
+
+// Generates the buffer from indices already stored as type
+void EBO::create(const void* indices) {
+	GLsizeiptr size = (GLsizeiptr)count * IndexSize();
+	if (GLState::Get().DirectStateAccess()) {
+		glCreateBuffers(1, &ID);
+		if (size > 0) {
+			glNamedBufferStorage(ID, size, indices, GL_DYNAMIC_STORAGE_BIT);
+		}
+	}
+	else {
+		glGenBuffers(1, &ID);
+		GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+	}
+	// The element binding belongs to the VAO, so both paths attach the new buffer to the bound one
+	GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+}
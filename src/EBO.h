@@ -2,23 +2,62 @@
 #define EBO_CLASS_H
 
 #include <glad/glad.h>
+#include <cstddef>
+#include <vector>
 
 class EBO {
 public:
 	// Reference ID of the Element Buffer Object
 	GLuint ID;
+	// GL_UNSIGNED_SHORT when every index fits in 16 bits, GL_UNSIGNED_INT otherwise
+	GLenum type;
+	// Number of indices stored
+	GLsizei count;
 
-	// Constructor that generates a Element Buffer Object and links it to indices
+	// Constructor that generates a Element Buffer Object and links it to indices (size in bytes)
 	EBO(GLuint* indices, GLsizeiptr size);
 
+	// Constructors that take the index count from an array or vector
+	template <size_t N>
+	EBO(const GLuint (&indices)[N]) { upload(indices, N); }
+	EBO(const std::vector<GLuint>& indices) { upload(indices.data(), indices.size()); }
+
+	// Constructor that uploads count indices already stored as type (e.g. straight from a cooked mesh)
+	EBO(const void* indices, GLsizei count, GLenum type);
+
+	// Returns the narrowest index type that can hold every index
+	static GLenum IndexTypeFor(const GLuint* indices, size_t count);
+
+	// Bytes per stored index
+	GLsizei IndexSize() const { return type == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+	// Byte offset of an index, for glDraw* calls that start part way in
+	GLintptr Offset(GLuint firstIndex) const { return (GLintptr)firstIndex * IndexSize(); }
+
+	// Replaces size bytes of the buffer starting at offset (indices stored as type)
+	void Update(GLintptr offset, GLsizeiptr size, const void* data);
+
 	// Binds the EBO
 	void Bind();
 
 	// Unbinds the EBO
 	void Unbind();
 
+	// Draws every index with the bound VAO (which must reference this EBO)
+	void Draw(GLenum mode = GL_TRIANGLES);
+
+	// Draws every index instanceCount times
+	void DrawInstanced(GLsizei instanceCount, GLenum mode = GL_TRIANGLES);
+
 	// Deletes the EBO
 	void Delete();
+
+private:
+	// Generates the buffer and uploads count indices, narrowed to 16 bits when they fit
+	void upload(const GLuint* indices, size_t count);
+
+	// Generates the buffer from indices already stored as type
+	void create(const void* indices);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,199 @@
+#include "ECS.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static size_t componentSizes[ECS_MAX_COMPONENTS];
+static std::atomic<uint32_t> componentCount{ 0 };
+
+static size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Size in bytes of a registered component type
+size_t ComponentTypes::Size(uint32_t id) {
+	return componentSizes[id];
+}
+
+// Hands out the next id
+uint32_t ComponentTypes::Register(size_t size) {
+	uint32_t id = componentCount++;
+	if (id >= ECS_MAX_COMPONENTS) {
+		std::cerr << "ECS: more than " << ECS_MAX_COMPONENTS << " component types" << std::endl;
+		std::abort();
+	}
+	componentSizes[id] = size;
+	return id;
+}
+
+EntityWorld::~EntityWorld() {
+	for (const std::unique_ptr<Archetype>& archetype : archetypes) {
+		for (const Chunk& chunk : archetype->chunks) {
+			::operator delete(chunk.data, std::align_val_t(ECS_COLUMN_ALIGNMENT));
+		}
+	}
+	for (uint8_t* data : freeChunks) {
+		::operator delete(data, std::align_val_t(ECS_COLUMN_ALIGNMENT));
+	}
+}
+
+// Destroys an entity and its components
+void EntityWorld::Destroy(Entity entity) {
+	if (!Alive(entity)) {
+		return;
+	}
+	uint32_t index = entity & INDEX_MASK;
+	Record& record = records[index];
+	removeRow(record);
+	record.archetype = NO_ARCHETYPE;
+	record.generation = (record.generation + 1) & 0xFF;
+	freeIndices.push_back(index);
+	stats.entities--;
+	stats.destroyed++;
+}
+
+// Whether the handle refers to a live entity
+bool EntityWorld::Alive(Entity entity) const {
+	uint32_t index = entity & INDEX_MASK;
+	return index < records.size() && records[index].archetype != NO_ARCHETYPE && records[index].generation == entity >> GENERATION_SHIFT;
+}
+
+// Archetype with exactly these components, created on first use
+uint32_t EntityWorld::findArchetype(ComponentMask mask) {
+	auto found = archetypeByMask.find(mask);
+	if (found != archetypeByMask.end()) {
+		return found->second;
+	}
+
+	std::unique_ptr<Archetype> archetype(new Archetype());
+	archetype->mask = mask;
+	std::fill(archetype->columns, archetype->columns + ECS_MAX_COMPONENTS, (int8_t)-1);
+	size_t rowBytes = sizeof(Entity);
+	for (uint32_t id = 0; id < ECS_MAX_COMPONENTS; id++) {
+		if (mask & (ComponentMask(1) << id)) {
+			archetype->columns[id] = (int8_t)archetype->components.size();
+			archetype->components.push_back(id);
+			archetype->sizes.push_back(ComponentTypes::Size(id));
+			rowBytes += ComponentTypes::Size(id);
+		}
+	}
+
+	// As many rows as fit once every array is padded to a cache line; an archetype too big for one
+	// row per standard chunk gets chunks of its own size
+	size_t padding = ECS_COLUMN_ALIGNMENT * (archetype->components.size() + 1);
+	archetype->chunkBytes = std::max(ECS_CHUNK_BYTES, alignUp(padding + rowBytes, ECS_COLUMN_ALIGNMENT));
+	archetype->capacity = (uint32_t)((archetype->chunkBytes - padding) / rowBytes);
+	size_t offset = alignUp(archetype->capacity * sizeof(Entity), ECS_COLUMN_ALIGNMENT);
+	for (size_t size : archetype->sizes) {
+		archetype->offsets.push_back(offset);
+		offset = alignUp(offset + archetype->capacity * size, ECS_COLUMN_ALIGNMENT);
+	}
+
+	uint32_t index = (uint32_t)archetypes.size();
+	archetypes.push_back(std::move(archetype));
+	archetypeByMask[mask] = index;
+	stats.archetypes = archetypes.size();
+	return index;
+}
+
+// New handle with no storage yet
+Entity EntityWorld::allocateEntity() {
+	uint32_t index;
+	if (!freeIndices.empty()) {
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else {
+		index = (uint32_t)records.size();
+		records.push_back(Record{ NO_ARCHETYPE, 0, 0, 0 });
+	}
+	stats.entities++;
+	return index | (records[index].generation << GENERATION_SHIFT);
+}
+
+// Chunk memory, recycled between archetypes when it has the standard size
+uint8_t* EntityWorld::allocateChunk(size_t bytes) {
+	stats.chunks++;
+	if (bytes == ECS_CHUNK_BYTES && !freeChunks.empty()) {
+		uint8_t* data = freeChunks.back();
+		freeChunks.pop_back();
+		stats.freeChunks = freeChunks.size();
+		return data;
+	}
+	return static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(ECS_COLUMN_ALIGNMENT)));
+}
+
+void EntityWorld::releaseChunk(uint8_t* data, size_t bytes) {
+	stats.chunks--;
+	if (bytes == ECS_CHUNK_BYTES) {
+		freeChunks.push_back(data);
+		stats.freeChunks = freeChunks.size();
+	}
+	else {
+		::operator delete(data, std::align_val_t(ECS_COLUMN_ALIGNMENT));
+	}
+}
+
+// Appends a row for the entity to an archetype, leaving its components uninitialized
+void EntityWorld::place(Entity entity, uint32_t archetypeIndex) {
+	Archetype& archetype = *archetypes[archetypeIndex];
+	if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+		archetype.chunks.push_back(Chunk{ allocateChunk(archetype.chunkBytes), 0 });
+	}
+	Chunk& chunk = archetype.chunks.back();
+	uint32_t row = chunk.count++;
+	reinterpret_cast<Entity*>(chunk.data)[row] = entity;
+
+	Record& record = records[entity & INDEX_MASK];
+	record.archetype = archetypeIndex;
+	record.chunk = (uint32_t)archetype.chunks.size() - 1;
+	record.row = row;
+}
+
+// Fills the entity's row with the archetype's last entity and shrinks the archetype
+void EntityWorld::removeRow(const Record& record) {
+	Archetype& archetype = *archetypes[record.archetype];
+	Chunk& last = archetype.chunks.back();
+	uint32_t lastRow = last.count - 1;
+	if (record.chunk != archetype.chunks.size() - 1 || record.row != lastRow) {
+		Chunk& chunk = archetype.chunks[record.chunk];
+		Entity moved = reinterpret_cast<Entity*>(last.data)[lastRow];
+		reinterpret_cast<Entity*>(chunk.data)[record.row] = moved;
+		for (size_t c = 0; c < archetype.components.size(); c++) {
+			size_t size = archetype.sizes[c];
+			std::memcpy(chunk.data + archetype.offsets[c] + record.row * size, last.data + archetype.offsets[c] + lastRow * size, size);
+		}
+		Record& movedRecord = records[moved & INDEX_MASK];
+		movedRecord.chunk = record.chunk;
+		movedRecord.row = record.row;
+	}
+	if (--last.count == 0) {
+		releaseChunk(last.data, archetype.chunkBytes);
+		archetype.chunks.pop_back();
+	}
+}
+
+// Moves an entity to the archetype with the given mask, keeping the components both share
+void EntityWorld::move(Entity entity, ComponentMask mask) {
+	uint32_t target = findArchetype(mask);
+	Record& record = records[entity & INDEX_MASK];
+	Record source = record;
+	place(entity, target);
+
+	const Archetype& from = *archetypes[source.archetype];
+	const Archetype& to = *archetypes[target];
+	const Chunk& fromChunk = from.chunks[source.chunk];
+	const Chunk& toChunk = to.chunks[record.chunk];
+	for (size_t c = 0; c < from.components.size(); c++) {
+		int column = to.columns[from.components[c]];
+		if (column >= 0) {
+			size_t size = from.sizes[c];
+			std::memcpy(toChunk.data + to.offsets[column] + record.row * size, fromChunk.data + from.offsets[c] + source.row * size, size);
+		}
+	}
+	removeRow(source);
+	stats.moves++;
+}
@@ -0,0 +1,283 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Handle of an entity: slot index in the low 24 bits, generation in the high 8, so a handle kept
+// after Destroy() stops matching when the slot is reused (until the generation wraps around)
+typedef uint32_t Entity;
+static const Entity INVALID_ENTITY = 0xFFFFFFFFu;
+
+// Bit i set when an archetype has component type i
+typedef uint64_t ComponentMask;
+static const uint32_t ECS_MAX_COMPONENTS = 64;
+
+// Size of a chunk: entities of one archetype are stored in chunks of this many bytes, each
+// component type in its own array
+static const size_t ECS_CHUNK_BYTES = 16 * 1024;
+
+// Component arrays start on cache line boundaries within a chunk; no component may need more
+static const size_t ECS_COLUMN_ALIGNMENT = 64;
+
+// Component types get a small id the first time they are used. Components are plain data: they
+// are moved around with memcpy and never constructed or destroyed
+class ComponentTypes {
+public:
+	// Id of a component type (const and volatile are ignored, so queries can ask for const T)
+	template <typename T>
+	static uint32_t Id() {
+		return idOf<typename std::remove_cv<T>::type>();
+	}
+
+	// Mask of a set of component types
+	template <typename... Ts>
+	static ComponentMask Mask() {
+		return (ComponentMask(0) | ... | (ComponentMask(1) << Id<Ts>()));
+	}
+
+	// Size in bytes of a registered component type
+	static size_t Size(uint32_t id);
+
+private:
+	// Id of an unqualified component type
+	template <typename T>
+	static uint32_t idOf() {
+		static_assert(std::is_trivially_copyable<T>::value, "components must be trivially copyable");
+		static_assert(alignof(T) <= ECS_COLUMN_ALIGNMENT, "components can't be aligned beyond ECS_COLUMN_ALIGNMENT");
+		static const uint32_t id = Register(sizeof(T));
+		return id;
+	}
+
+	// Hands out the next id
+	static uint32_t Register(size_t size);
+};
+
+// Entity-component storage grouped by archetype (the exact set of components an entity has).
+// Every archetype keeps its entities in fixed-size chunks; inside a chunk each component type is one
+// contiguous array, so a query walks dense arrays of just the components it asks for. Removing an
+// entity moves the archetype's last entity into the hole, which keeps every chunk but the last full.
+//
+//   EntityWorld world;
+//   Entity e = world.Create(Position{...}, Velocity{...});
+//   world.Each<Position, const Velocity>([&](Position& p, const Velocity& v) { p.value += v.value * dt; });
+//   world.ParallelEachChunk<Transform, const Bounds>(pool, [&](size_t count, const Entity* entities, Transform* t, const Bounds* b) { ... });
+//
+// Creating, destroying, adding or removing components is not allowed while a query runs.
+class EntityWorld {
+public:
+	// Totals since construction, and the current storage
+	struct Stats {
+		size_t entities = 0;
+		size_t archetypes = 0;
+		size_t chunks = 0;           // in use by archetypes
+		size_t freeChunks = 0;       // kept for reuse
+		size_t created = 0;
+		size_t destroyed = 0;
+		size_t moves = 0;            // entities moved to another archetype by Add() or Remove()
+	};
+
+	Stats stats;
+
+	EntityWorld() = default;
+	~EntityWorld();
+
+	EntityWorld(const EntityWorld&) = delete;
+	EntityWorld& operator=(const EntityWorld&) = delete;
+
+	// Creates an entity with the given components
+	template <typename... Ts>
+	Entity Create(const Ts&... components) {
+		uint32_t archetype = findArchetype(ComponentTypes::Mask<Ts...>());
+		Entity entity = allocateEntity();
+		Record& record = records[entity & INDEX_MASK];
+		place(entity, archetype);
+		(writeComponent(record, components), ...);
+		stats.created++;
+		return entity;
+	}
+
+	// Destroys an entity and its components
+	void Destroy(Entity entity);
+
+	// Whether the handle refers to a live entity
+	bool Alive(Entity entity) const;
+
+	// Whether a live entity has a component of type T
+	template <typename T>
+	bool Has(Entity entity) const {
+		return (archetypes[records[entity & INDEX_MASK].archetype]->mask & ComponentTypes::Mask<T>()) != 0;
+	}
+
+	// Component of type T of a live entity, or nullptr if it has none. The pointer is valid until
+	// the next structural change (Create(), Destroy(), Add(), Remove())
+	template <typename T>
+	T* Get(Entity entity) {
+		const Record& record = records[entity & INDEX_MASK];
+		const Archetype& archetype = *archetypes[record.archetype];
+		int column = archetype.columns[ComponentTypes::Id<T>()];
+		if (column < 0) {
+			return nullptr;
+		}
+		return reinterpret_cast<T*>(archetype.chunks[record.chunk].data + archetype.offsets[column]) + record.row;
+	}
+
+	// Adds a component to a live entity (moving it to another archetype), or overwrites it if the
+	// entity already has one
+	template <typename T>
+	void Add(Entity entity, const T& component) {
+		uint32_t id = ComponentTypes::Id<T>();
+		Record& record = records[entity & INDEX_MASK];
+		if (archetypes[record.archetype]->columns[id] < 0) {
+			move(entity, archetypes[record.archetype]->mask | (ComponentMask(1) << id));
+		}
+		writeComponent(record, component);
+	}
+
+	// Removes a component from a live entity (moving it to another archetype)
+	template <typename T>
+	void Remove(Entity entity) {
+		ComponentMask mask = archetypes[records[entity & INDEX_MASK].archetype]->mask;
+		ComponentMask bit = ComponentTypes::Mask<T>();
+		if (mask & bit) {
+			move(entity, mask & ~bit);
+		}
+	}
+
+	// Calls function(count, entities, T0* column0, T1* column1, ...) for every chunk whose archetype has
+	// all of Ts (and possibly more)
+	template <typename... Ts, typename F>
+	void EachChunk(F&& function) {
+		ComponentMask mask = ComponentTypes::Mask<Ts...>();
+		for (const std::unique_ptr<Archetype>& archetype : archetypes) {
+			if ((archetype->mask & mask) != mask) {
+				continue;
+			}
+			for (const Chunk& chunk : archetype->chunks) {
+				function((size_t)chunk.count, reinterpret_cast<const Entity*>(chunk.data), column<Ts>(*archetype, chunk)...);
+			}
+		}
+	}
+
+	// Calls function(T0& component0, T1& component1, ...) for every entity that has all of Ts
+	template <typename... Ts, typename F>
+	void Each(F&& function) {
+		EachChunk<Ts...>([&](size_t count, const Entity*, Ts*... columns) {
+			for (size_t i = 0; i < count; i++) {
+				function(columns[i]...);
+			}
+		});
+	}
+
+	// EachChunk() with the chunks spread across a pool, which hands them out one at a time (serial
+	// without a pool). function runs concurrently on different chunks
+	template <typename... Ts, typename F>
+	void ParallelEachChunk(ThreadPool* pool, F&& function) {
+		if (!pool) {
+			EachChunk<Ts...>(function);
+			return;
+		}
+		ComponentMask mask = ComponentTypes::Mask<Ts...>();
+		queryChunks.clear();
+		for (const std::unique_ptr<Archetype>& archetype : archetypes) {
+			if ((archetype->mask & mask) == mask) {
+				for (const Chunk& chunk : archetype->chunks) {
+					queryChunks.push_back(QueryChunk{ archetype.get(), &chunk });
+				}
+			}
+		}
+		pool->ParallelFor(queryChunks.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Archetype& archetype = *queryChunks[i].archetype;
+				const Chunk& chunk = *queryChunks[i].chunk;
+				function((size_t)chunk.count, reinterpret_cast<const Entity*>(chunk.data), column<Ts>(archetype, chunk)...);
+			}
+		});
+	}
+
+	// Number of live entities
+	size_t Size() const { return stats.entities; }
+
+private:
+	static constexpr uint32_t INDEX_MASK = 0x00FFFFFFu;
+	static constexpr uint32_t GENERATION_SHIFT = 24;
+	static constexpr uint32_t NO_ARCHETYPE = 0xFFFFFFFFu;
+
+	// One block of an archetype's storage: capacity entity handles, then one array per component
+	struct Chunk {
+		uint8_t* data;
+		uint32_t count;
+	};
+
+	struct Archetype {
+		ComponentMask mask;
+		std::vector<uint32_t> components;      // ids, ascending
+		std::vector<size_t> sizes;             // size of each component
+		std::vector<size_t> offsets;           // byte offset of each component's array in a chunk
+		int8_t columns[ECS_MAX_COMPONENTS];    // index into components of every id, -1 if absent
+		uint32_t capacity;                     // entities per chunk
+		size_t chunkBytes;
+		std::vector<Chunk> chunks;             // all full but the last
+	};
+
+	// Where an entity lives
+	struct Record {
+		uint32_t archetype;
+		uint32_t chunk;
+		uint32_t row;
+		uint32_t generation;
+	};
+
+	struct QueryChunk {
+		const Archetype* archetype;
+		const Chunk* chunk;
+	};
+
+	std::vector<std::unique_ptr<Archetype>> archetypes;
+	std::unordered_map<ComponentMask, uint32_t> archetypeByMask;
+	std::vector<Record> records;
+	std::vector<uint32_t> freeIndices;
+	std::vector<uint8_t*> freeChunks;
+	std::vector<QueryChunk> queryChunks;
+
+	// Array of T in a chunk
+	template <typename T>
+	static T* column(const Archetype& archetype, const Chunk& chunk) {
+		return reinterpret_cast<T*>(chunk.data + archetype.offsets[archetype.columns[ComponentTypes::Id<T>()]]);
+	}
+
+	// Copies a component into an entity's row
+	template <typename T>
+	void writeComponent(const Record& record, const T& component) {
+		Archetype& archetype = *archetypes[record.archetype];
+		std::memcpy(column<T>(archetype, archetype.chunks[record.chunk]) + record.row, &component, sizeof(T));
+	}
+
+	// Archetype with exactly these components, created on first use
+	uint32_t findArchetype(ComponentMask mask);
+
+	// New handle with no storage yet
+	Entity allocateEntity();
+
+	// Chunk memory, recycled between archetypes when it has the standard size
+	uint8_t* allocateChunk(size_t bytes);
+	void releaseChunk(uint8_t* data, size_t bytes);
+
+	// Appends a row for the entity to an archetype, leaving its components uninitialized
+	void place(Entity entity, uint32_t archetype);
+
+	// Fills the entity's row with the archetype's last entity and shrinks the archetype
+	void removeRow(const Record& record);
+
+	// Moves an entity to the archetype with the given mask, keeping the components both share
+	void move(Entity entity, ComponentMask mask);
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "FBO.h"
+
+// Constructor that generates a Framebuffer Object with color and depth attachments of the given size
+FBO::FBO(int width, int height) {
+	FBO::width = width;
+	FBO::height = height;
+
+	glGenFramebuffers(1, &ID);
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+
+	// Color attachment (renderbuffer, since we never sample from it)
+	glGenRenderbuffers(1, &colorRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+
+	// Depth/stencil attachment so GL_DEPTH_TEST behaves like the default framebuffer
+	glGenRenderbuffers(1, &depthRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+// Returns true if the framebuffer is complete and can be rendered to
+bool FBO::IsComplete() {
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// Binds the FBO for drawing and reading
+void FBO::Bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+}
+
+// Unbinds the FBO (back to the default framebuffer)
+void FBO::Unbind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Deletes the FBO and its attachments
+void FBO::Delete() {
+	glDeleteRenderbuffers(1, &colorRBO);
+	glDeleteRenderbuffers(1, &depthRBO);
+	glDeleteFramebuffers(1, &ID);
+}
@@ -0,0 +1,35 @@
+#ifndef FBO_CLASS_H
+#define FBO_CLASS_H
+
+#include <glad/glad.h>
+
+class FBO {
+public:
+	// Reference ID of the Framebuffer Object
+	GLuint ID;
+
+	// Reference IDs of the color and depth/stencil attachments
+	GLuint colorRBO;
+	GLuint depthRBO;
+
+	// Framebuffer dimensions
+	int width;
+	int height;
+
+	// Constructor that generates a Framebuffer Object with color and depth attachments of the given size
+	FBO(int width, int height);
+
+	// Returns true if the framebuffer is complete and can be rendered to
+	bool IsComplete();
+
+	// Binds the FBO for drawing and reading
+	void Bind();
+
+	// Unbinds the FBO (back to the default framebuffer)
+	void Unbind();
+
+	// Deletes the FBO and its attachments
+	void Delete();
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "FrameTimer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Marks the start of a frame
+void FrameTimer::Begin() {
+	start = std::chrono::steady_clock::now();
+}
+
+// Marks the end of a frame and records its duration
+void FrameTimer::End() {
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	samples.push_back(elapsed.count());
+}
+
+// Clears all recorded samples
+void FrameTimer::Reset() {
+	samples.clear();
+}
+
+double FrameTimer::Min() const {
+	return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double FrameTimer::Max() const {
+	return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double FrameTimer::Mean() const {
+	return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double FrameTimer::Median() const {
+	return Percentile(50.0);
+}
+
+// Nearest-rank percentile, p in [0, 100]
+double FrameTimer::Percentile(double p) const {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+	return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+// Prints a one-block summary of the recorded frame times
+void FrameTimer::Report(std::ostream& out, const char* label) const {
+	out << label << ": " << samples.size() << " frames\n"
+		<< "  mean   " << Mean() << " ms (" << (Mean() > 0.0 ? 1000.0 / Mean() : 0.0) << " fps)\n"
+		<< "  min    " << Min() << " ms\n"
+		<< "  median " << Median() << " ms\n"
+		<< "  p99    " << Percentile(99.0) << " ms\n"
+		<< "  max    " << Max() << " ms" << std::endl;
+}
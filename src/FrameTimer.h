@@ -0,0 +1,37 @@
+#ifndef FRAME_TIMER_CLASS_H
+#define FRAME_TIMER_CLASS_H
+
+#include <chrono>
+#include <vector>
+#include <ostream>
+
+// Collects per-frame wall clock times and summarizes them
+class FrameTimer {
+public:
+	// Recorded frame times in milliseconds
+	std::vector<double> samples;
+
+	// Marks the start of a frame
+	void Begin();
+
+	// Marks the end of a frame and records its duration
+	void End();
+
+	// Clears all recorded samples
+	void Reset();
+
+	// Summary statistics over the recorded samples (milliseconds)
+	double Min() const;
+	double Max() const;
+	double Mean() const;
+	double Median() const;
+	double Percentile(double p) const;
+
+	// Prints a one-block summary of the recorded frame times
+	void Report(std::ostream& out, const char* label) const;
+
+private:
+	std::chrono::steady_clock::time_point start;
+};
+
+#endif
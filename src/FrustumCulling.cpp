@@ -0,0 +1,228 @@
+#include "FrustumCulling.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// AVX is used when the compiler targets it (e.g. -mavx or -march=native), SSE2 otherwise on x86
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_USE_SSE2 1
+#endif
+
+// The few operations the culling loop needs, on as many floats as the instruction set holds
+#if defined(FRUSTUM_USE_AVX)
+typedef __m256 Lanes;
+static const size_t LANES = 8;
+static inline Lanes lanesLoad(const float* p) { return _mm256_loadu_ps(p); }
+static inline Lanes lanesSet(float value) { return _mm256_set1_ps(value); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline int lanesNonNegative(Lanes a) { return _mm256_movemask_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GE_OQ)); }
+#elif defined(FRUSTUM_USE_SSE2)
+typedef __m128 Lanes;
+static const size_t LANES = 4;
+static inline Lanes lanesLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline Lanes lanesSet(float value) { return _mm_set1_ps(value); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline int lanesNonNegative(Lanes a) { return _mm_movemask_ps(_mm_cmpge_ps(a, _mm_setzero_ps())); }
+#else
+typedef float Lanes;
+static const size_t LANES = 1;
+static inline Lanes lanesLoad(const float* p) { return *p; }
+static inline Lanes lanesSet(float value) { return value; }
+static inline Lanes lanesAdd(Lanes a, Lanes b) { return a + b; }
+static inline Lanes lanesMul(Lanes a, Lanes b) { return a * b; }
+static inline Lanes lanesMin(Lanes a, Lanes b) { return std::min(a, b); }
+static inline int lanesNonNegative(Lanes a) { return a >= 0.0f ? 1 : 0; }
+#endif
+
+static_assert(CULLING_BOUNDS_PADDING % LANES == 0, "Padding must be a whole number of SIMD batches");
+
+// Extracts the normalized planes of a projection * view matrix (Gribb & Hartmann), e.g.
+// Camera::ViewProjection(); the planes are then in world space
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) {
+	// glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	// Clip space is -w <= x, y, z <= w (OpenGL depth range)
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+	for (glm::vec4& plane : frustum.planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+// Returns true if the sphere is inside or touches the frustum (conservative near the corners)
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+	for (const glm::vec4& plane : planes) {
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns true if the box (center and half extents) is inside or touches the frustum
+bool Frustum::IntersectsAABB(const glm::vec3& center, const glm::vec3& extent) const {
+	for (const glm::vec4& plane : planes) {
+		// Distance of the box corner furthest along the plane normal
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -glm::dot(glm::abs(glm::vec3(plane)), extent)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Sets the number of bounds; new entries are empty boxes at the origin
+void CullingBounds::Resize(size_t newCount) {
+	size_t padded = (newCount + CULLING_BOUNDS_PADDING - 1) / CULLING_BOUNDS_PADDING * CULLING_BOUNDS_PADDING;
+	for (std::vector<float>* array : { &centerX, &centerY, &centerZ }) {
+		array->resize(padded, 0.0f);
+	}
+	for (std::vector<float>* array : { &extentX, &extentY, &extentZ, &radius }) {
+		array->resize(padded, 0.0f);
+		// -FLT_MAX rather than -infinity so that a zero plane component never multiplies into NaN
+		std::fill(array->begin() + newCount, array->end(), -FLT_MAX);
+	}
+	count = newCount;
+}
+
+// Stores a box given its corners
+void CullingBounds::SetAABB(size_t index, const glm::vec3& min, const glm::vec3& max) {
+	glm::vec3 center = (min + max) * 0.5f;
+	glm::vec3 extent = (max - min) * 0.5f;
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	extentX[index] = extent.x;
+	extentY[index] = extent.y;
+	extentZ[index] = extent.z;
+	radius[index] = glm::length(extent);
+}
+
+// Stores a sphere
+void CullingBounds::SetSphere(size_t index, const glm::vec3& center, float sphereRadius) {
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	extentX[index] = extentY[index] = extentZ[index] = sphereRadius;
+	radius[index] = sphereRadius;
+}
+
+// Culls [begin, end), both multiples of LANES, writing the visible indices from visible[0].
+// An entry passes when its signed distance to every plane plus its reach along the plane normal
+// (the radius, or the box's projected extent) is non-negative, so the minimum over the planes is tested
+template <bool Box>
+static size_t cullRange(const Frustum& frustum, const CullingBounds& bounds, size_t begin, size_t end, uint32_t* visible) {
+	Lanes normalX[6], normalY[6], normalZ[6], distance[6], absX[6], absY[6], absZ[6];
+	for (int p = 0; p < 6; p++) {
+		const glm::vec4& plane = frustum.planes[p];
+		normalX[p] = lanesSet(plane.x);
+		normalY[p] = lanesSet(plane.y);
+		normalZ[p] = lanesSet(plane.z);
+		distance[p] = lanesSet(plane.w);
+		absX[p] = lanesSet(std::fabs(plane.x));
+		absY[p] = lanesSet(std::fabs(plane.y));
+		absZ[p] = lanesSet(std::fabs(plane.z));
+	}
+
+	size_t written = 0;
+	for (size_t i = begin; i < end; i += LANES) {
+		Lanes x = lanesLoad(&bounds.centerX[i]);
+		Lanes y = lanesLoad(&bounds.centerY[i]);
+		Lanes z = lanesLoad(&bounds.centerZ[i]);
+		Lanes ex, ey, ez, r;
+		if (Box) {
+			ex = lanesLoad(&bounds.extentX[i]);
+			ey = lanesLoad(&bounds.extentY[i]);
+			ez = lanesLoad(&bounds.extentZ[i]);
+		}
+		else {
+			r = lanesLoad(&bounds.radius[i]);
+		}
+
+		Lanes nearest = lanesSet(FLT_MAX);
+		for (int p = 0; p < 6; p++) {
+			Lanes d = lanesAdd(lanesAdd(lanesMul(normalX[p], x), lanesMul(normalY[p], y)), lanesAdd(lanesMul(normalZ[p], z), distance[p]));
+			Lanes reach = Box ? lanesAdd(lanesAdd(lanesMul(absX[p], ex), lanesMul(absY[p], ey)), lanesMul(absZ[p], ez)) : r;
+			nearest = lanesMin(nearest, lanesAdd(d, reach));
+		}
+
+		// Every lane is written and the cursor only advances past visible ones, so the list stays
+		// compact without a branch per object
+		int mask = lanesNonNegative(nearest);
+		for (size_t lane = 0; lane < LANES; lane++) {
+			visible[written] = (uint32_t)(i + lane);
+			written += (mask >> lane) & 1;
+		}
+	}
+	return written;
+}
+
+static size_t cullRange(const Frustum& frustum, const CullingBounds& bounds, CullShape shape, size_t begin, size_t end, uint32_t* visible) {
+	return shape == CullShape::AABB ? cullRange<true>(frustum, bounds, begin, end, visible) : cullRange<false>(frustum, bounds, begin, end, visible);
+}
+
+// Below this many bounds per worker, splitting costs more than it saves
+static const size_t CULL_MIN_GRAIN = 16384;
+
+// Writes the indices of the bounds inside or touching the frustum to visible, in increasing order,
+// and returns how many there are. visible needs room for bounds.PaddedSize() entries (every lane is
+// written before it is known to be visible). With a pool the array is split across its workers
+size_t FrustumCull(const Frustum& frustum, const CullingBounds& bounds, CullShape shape, uint32_t* visible, ThreadPool* pool) {
+	PROFILE_ZONE("FrustumCull");
+	size_t padded = bounds.PaddedSize();
+	if (!pool || pool->Size() == 0 || padded <= CULL_MIN_GRAIN) {
+		return cullRange(frustum, bounds, shape, 0, padded, visible);
+	}
+
+	// A few chunks per thread so uneven visibility balances; chunks start on a padding boundary
+	size_t threads = pool->Size() + 1;
+	size_t grain = std::max(CULL_MIN_GRAIN, (padded / (threads * 4) + CULLING_BOUNDS_PADDING - 1) / CULLING_BOUNDS_PADDING * CULLING_BOUNDS_PADDING);
+	std::vector<size_t> counts((padded + grain - 1) / grain);
+	pool->ParallelFor(padded, grain, [&](size_t begin, size_t end) {
+		counts[begin / grain] = cullRange(frustum, bounds, shape, begin, end, visible + begin);
+	});
+
+	// Each chunk wrote its list at its own offset; close the gaps in order
+	size_t written = counts[0];
+	for (size_t chunk = 1; chunk < counts.size(); chunk++) {
+		std::memmove(visible + written, visible + chunk * grain, counts[chunk] * sizeof(uint32_t));
+		written += counts[chunk];
+	}
+	return written;
+}
+
+// Instruction set FrustumCull() was compiled for ("AVX", "SSE2" or "scalar") and its width
+const char* FrustumCullPath() {
+#if defined(FRUSTUM_USE_AVX)
+	return "AVX";
+#elif defined(FRUSTUM_USE_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+size_t FrustumCullLanes() {
+	return LANES;
+}
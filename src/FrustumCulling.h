@@ -0,0 +1,72 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+// The six planes of a view frustum. Each plane is (normal, distance) with the normal pointing
+// inward, so a point p is inside when dot(normal, p) + distance >= 0 for every plane
+struct Frustum {
+	glm::vec4 planes[6];   // left, right, bottom, top, near, far
+
+	// Extracts the normalized planes of a projection * view matrix (Gribb & Hartmann), e.g.
+	// Camera::ViewProjection(); the planes are then in world space
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+	// Returns true if the sphere is inside or touches the frustum (conservative near the corners)
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+	// Returns true if the box (center and half extents) is inside or touches the frustum
+	bool IntersectsAABB(const glm::vec3& center, const glm::vec3& extent) const;
+};
+
+// Bounds are always stored in multiples of this many, so SIMD loops have no scalar tail
+static const size_t CULLING_BOUNDS_PADDING = 8;
+
+// Bounding volumes in structure-of-arrays layout, so the culling loops load 4 (SSE2) or 8 (AVX)
+// objects per instruction. Every entry holds both a sphere and a box; SetAABB() derives the
+// sphere around the box and SetSphere() the box around the sphere. Padding entries have negative
+// sizes and never pass a test
+class CullingBounds {
+public:
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;   // box half extents
+	std::vector<float> radius;                      // sphere radius
+
+	// Sets the number of bounds; new entries are empty boxes at the origin
+	void Resize(size_t count);
+
+	// Number of bounds, and the number stored including padding
+	size_t Size() const { return count; }
+	size_t PaddedSize() const { return radius.size(); }
+
+	// Stores a box given its corners
+	void SetAABB(size_t index, const glm::vec3& min, const glm::vec3& max);
+
+	// Stores a sphere
+	void SetSphere(size_t index, const glm::vec3& center, float sphereRadius);
+
+private:
+	size_t count = 0;
+};
+
+// Which volume of each entry is tested
+enum class CullShape {
+	Sphere,
+	AABB,
+};
+
+// Writes the indices of the bounds inside or touching the frustum to visible, in increasing order,
+// and returns how many there are. visible needs room for bounds.PaddedSize() entries (every lane is
+// written before it is known to be visible). With a pool the array is split across its workers
+size_t FrustumCull(const Frustum& frustum, const CullingBounds& bounds, CullShape shape, uint32_t* visible, ThreadPool* pool = nullptr);
+
+// Instruction set FrustumCull() was compiled for ("AVX", "SSE2" or "scalar") and its width
+const char* FrustumCullPath();
+size_t FrustumCullLanes();
+
+#endif
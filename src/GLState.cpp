@@ -0,0 +1,293 @@
+#include "GLState.h"
+
+#include <iostream>
+
+// Returns the calling thread's tracker
+GLState& GLState::Get() {
+	static thread_local GLState state;
+	return state;
+}
+
+GLState::GLState() {
+	Reset();
+}
+
+// Forgets everything, forcing the next call of every kind through to GL
+void GLState::Reset() {
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+	for (int slot = 0; slot < BUFFER_SLOTS; slot++) {
+		buffers[slot] = UNKNOWN;
+	}
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+		for (int slot = 0; slot < TEXTURE_SLOTS; slot++) {
+			textures[unit][slot] = UNKNOWN;
+		}
+	}
+	elementBuffers.clear();
+	capabilities.clear();
+}
+
+// Cached glUseProgram
+void GLState::UseProgram(GLuint program) {
+	if (GLState::program == program) {
+		if (validate) {
+			check("program", GL_CURRENT_PROGRAM, program);
+		}
+		stats.skipped++;
+		return;
+	}
+	glUseProgram(program);
+	GLState::program = program;
+	stats.issued++;
+}
+
+// Cached glBindVertexArray (the element buffer binding follows the VAO)
+void GLState::BindVertexArray(GLuint vertexArray) {
+	if (GLState::vertexArray == vertexArray) {
+		if (validate) {
+			check("vertex array", GL_VERTEX_ARRAY_BINDING, vertexArray);
+		}
+		stats.skipped++;
+		return;
+	}
+	glBindVertexArray(vertexArray);
+	GLState::vertexArray = vertexArray;
+	stats.issued++;
+}
+
+// Cached glBindBuffer
+void GLState::BindBuffer(GLenum target, GLuint buffer) {
+	GLuint* cached = nullptr;
+	if (target == GL_ELEMENT_ARRAY_BUFFER) {
+		// Only trackable while the bound VAO is known
+		if (vertexArray != UNKNOWN) {
+			cached = &elementBuffers.emplace(vertexArray, UNKNOWN).first->second;
+		}
+	}
+	else {
+		int slot = bufferSlot(target);
+		if (slot >= 0) {
+			cached = &buffers[slot];
+		}
+	}
+
+	if (cached && *cached == buffer) {
+		if (validate) {
+			check("buffer", bindingQuery(target), buffer);
+		}
+		stats.skipped++;
+		return;
+	}
+	glBindBuffer(target, buffer);
+	if (cached) {
+		*cached = buffer;
+	}
+	stats.issued++;
+}
+
+// glBindBufferRange, which also replaces the generic binding of target (always issued)
+void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+	glBindBufferRange(target, index, buffer, offset, size);
+	int slot = bufferSlot(target);
+	if (slot >= 0) {
+		buffers[slot] = buffer;
+	}
+	stats.issued++;
+}
+
+// glVertexArrayElementBuffer (DSA), keeping the per-VAO element buffer cache in sync
+void GLState::VertexArrayElementBuffer(GLuint vertexArray, GLuint buffer) {
+	glVertexArrayElementBuffer(vertexArray, buffer);
+	elementBuffers[vertexArray] = buffer;
+	stats.issued++;
+}
+
+// Cached glActiveTexture (unit is GL_TEXTURE0 + n)
+void GLState::ActiveTexture(GLenum unit) {
+	if (activeUnit == unit) {
+		if (validate) {
+			check("active texture", GL_ACTIVE_TEXTURE, unit);
+		}
+		stats.skipped++;
+		return;
+	}
+	glActiveTexture(unit);
+	activeUnit = unit;
+	stats.issued++;
+}
+
+// Cached glBindTexture on the active unit
+void GLState::BindTexture(GLenum target, GLuint texture) {
+	GLuint* cached = nullptr;
+	int slot = textureSlot(target);
+	if (slot >= 0 && activeUnit != UNKNOWN && activeUnit - GL_TEXTURE0 < (GLenum)MAX_TEXTURE_UNITS) {
+		cached = &textures[activeUnit - GL_TEXTURE0][slot];
+	}
+
+	if (cached && *cached == texture) {
+		if (validate) {
+			check("texture", bindingQuery(target), texture);
+		}
+		stats.skipped++;
+		return;
+	}
+	glBindTexture(target, texture);
+	if (cached) {
+		*cached = texture;
+	}
+	stats.issued++;
+}
+
+// Cached glEnable
+void GLState::Enable(GLenum capability) {
+	std::unordered_map<GLenum, bool>::iterator it = capabilities.find(capability);
+	if (it != capabilities.end() && it->second) {
+		if (validate && !glIsEnabled(capability)) {
+			std::cerr << "GLState: capability 0x" << std::hex << capability << std::dec << " cached as enabled but is disabled" << std::endl;
+			stats.mismatches++;
+			glEnable(capability);
+		}
+		stats.skipped++;
+		return;
+	}
+	glEnable(capability);
+	capabilities[capability] = true;
+	stats.issued++;
+}
+
+// Cached glDisable
+void GLState::Disable(GLenum capability) {
+	std::unordered_map<GLenum, bool>::iterator it = capabilities.find(capability);
+	if (it != capabilities.end() && !it->second) {
+		if (validate && glIsEnabled(capability)) {
+			std::cerr << "GLState: capability 0x" << std::hex << capability << std::dec << " cached as disabled but is enabled" << std::endl;
+			stats.mismatches++;
+			glDisable(capability);
+		}
+		stats.skipped++;
+		return;
+	}
+	glDisable(capability);
+	capabilities[capability] = false;
+	stats.issued++;
+}
+
+// Deleting the current program leaves it in use until another one is installed, so the cache stays valid;
+// only forget it so a recycled name isn't mistaken for the old program
+void GLState::DeleteProgram(GLuint program) {
+	if (GLState::program == program) {
+		GLState::program = UNKNOWN;
+	}
+}
+
+// A deleted VAO that was bound reverts the binding to 0
+void GLState::DeleteVertexArray(GLuint vertexArray) {
+	elementBuffers.erase(vertexArray);
+	if (GLState::vertexArray == vertexArray) {
+		GLState::vertexArray = 0;
+	}
+}
+
+// A deleted buffer is unbound from every target of the current context
+void GLState::DeleteBuffer(GLuint buffer) {
+	for (int slot = 0; slot < BUFFER_SLOTS; slot++) {
+		if (buffers[slot] == buffer) {
+			buffers[slot] = 0;
+		}
+	}
+	// Only the bound VAO is detached by GL; other VAOs keep referencing the (now orphaned) name
+	for (std::unordered_map<GLuint, GLuint>::iterator it = elementBuffers.begin(); it != elementBuffers.end(); ++it) {
+		if (it->second == buffer) {
+			it->second = it->first == vertexArray ? 0 : UNKNOWN;
+		}
+	}
+}
+
+// A deleted texture is unbound from every unit
+void GLState::DeleteTexture(GLuint texture) {
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+		for (int slot = 0; slot < TEXTURE_SLOTS; slot++) {
+			if (textures[unit][slot] == texture) {
+				textures[unit][slot] = 0;
+			}
+		}
+	}
+}
+
+// Maps a buffer target to its cache slot
+int GLState::bufferSlot(GLenum target) {
+	switch (target) {
+	case GL_ARRAY_BUFFER: return ARRAY;
+	case GL_PIXEL_PACK_BUFFER: return PIXEL_PACK;
+	case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK;
+	case GL_UNIFORM_BUFFER: return UNIFORM;
+	case GL_COPY_READ_BUFFER: return COPY_READ;
+	case GL_COPY_WRITE_BUFFER: return COPY_WRITE;
+	case GL_DRAW_INDIRECT_BUFFER: return DRAW_INDIRECT;
+	case GL_SHADER_STORAGE_BUFFER: return SHADER_STORAGE;
+	default: return -1;
+	}
+}
+
+// Maps a texture target to its cache slot
+int GLState::textureSlot(GLenum target) {
+	switch (target) {
+	case GL_TEXTURE_2D: return TEX_2D;
+	case GL_TEXTURE_2D_ARRAY: return TEX_2D_ARRAY;
+	case GL_TEXTURE_3D: return TEX_3D;
+	case GL_TEXTURE_CUBE_MAP: return TEX_CUBE;
+	default: return -1;
+	}
+}
+
+// Returns the glGet enum reporting a target's binding
+GLenum GLState::bindingQuery(GLenum target) {
+	switch (target) {
+	case GL_ARRAY_BUFFER: return GL_ARRAY_BUFFER_BINDING;
+	case GL_ELEMENT_ARRAY_BUFFER: return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+	case GL_PIXEL_PACK_BUFFER: return GL_PIXEL_PACK_BUFFER_BINDING;
+	case GL_PIXEL_UNPACK_BUFFER: return GL_PIXEL_UNPACK_BUFFER_BINDING;
+	case GL_UNIFORM_BUFFER: return GL_UNIFORM_BUFFER_BINDING;
+	case GL_COPY_READ_BUFFER: return GL_COPY_READ_BUFFER_BINDING;
+	case GL_COPY_WRITE_BUFFER: return GL_COPY_WRITE_BUFFER_BINDING;
+	case GL_DRAW_INDIRECT_BUFFER: return GL_DRAW_INDIRECT_BUFFER_BINDING;
+	case GL_SHADER_STORAGE_BUFFER: return GL_SHADER_STORAGE_BUFFER_BINDING;
+	case GL_TEXTURE_2D: return GL_TEXTURE_BINDING_2D;
+	case GL_TEXTURE_2D_ARRAY: return GL_TEXTURE_BINDING_2D_ARRAY;
+	case GL_TEXTURE_3D: return GL_TEXTURE_BINDING_3D;
+	case GL_TEXTURE_CUBE_MAP: return GL_TEXTURE_BINDING_CUBE_MAP;
+	default: return 0;
+	}
+}
+
+// Compares a cached value with the driver's, resyncing GL state if something changed it behind the cache's back
+void GLState::check(const char* what, GLenum query, GLint expected) {
+	GLint actual = 0;
+	glGetIntegerv(query, &actual);
+	if (actual == expected) {
+		return;
+	}
+	std::cerr << "GLState: " << what << " binding cached as " << expected << " but GL has " << actual << std::endl;
+	stats.mismatches++;
+
+	switch (query) {
+	case GL_CURRENT_PROGRAM: glUseProgram(expected); break;
+	case GL_VERTEX_ARRAY_BINDING: glBindVertexArray(expected); break;
+	case GL_ACTIVE_TEXTURE: glActiveTexture(expected); break;
+	case GL_TEXTURE_BINDING_2D: glBindTexture(GL_TEXTURE_2D, expected); break;
+	case GL_TEXTURE_BINDING_2D_ARRAY: glBindTexture(GL_TEXTURE_2D_ARRAY, expected); break;
+	case GL_TEXTURE_BINDING_3D: glBindTexture(GL_TEXTURE_3D, expected); break;
+	case GL_TEXTURE_BINDING_CUBE_MAP: glBindTexture(GL_TEXTURE_CUBE_MAP, expected); break;
+	case GL_ARRAY_BUFFER_BINDING: glBindBuffer(GL_ARRAY_BUFFER, expected); break;
+	case GL_ELEMENT_ARRAY_BUFFER_BINDING: glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, expected); break;
+	case GL_PIXEL_PACK_BUFFER_BINDING: glBindBuffer(GL_PIXEL_PACK_BUFFER, expected); break;
+	case GL_PIXEL_UNPACK_BUFFER_BINDING: glBindBuffer(GL_PIXEL_UNPACK_BUFFER, expected); break;
+	case GL_UNIFORM_BUFFER_BINDING: glBindBuffer(GL_UNIFORM_BUFFER, expected); break;
+	case GL_COPY_READ_BUFFER_BINDING: glBindBuffer(GL_COPY_READ_BUFFER, expected); break;
+	case GL_COPY_WRITE_BUFFER_BINDING: glBindBuffer(GL_COPY_WRITE_BUFFER, expected); break;
+	case GL_DRAW_INDIRECT_BUFFER_BINDING: glBindBuffer(GL_DRAW_INDIRECT_BUFFER, expected); break;
+	case GL_SHADER_STORAGE_BUFFER_BINDING: glBindBuffer(GL_SHADER_STORAGE_BUFFER, expected); break;
+	}
+}
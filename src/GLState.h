@@ -0,0 +1,109 @@
+#ifndef GL_STATE_CLASS_H
+#define GL_STATE_CLASS_H
+
+#include <glad/glad.h>
+#include <unordered_map>
+
+// Shadow copy of the bind points the engine touches, so wrapper classes only call into
+// the driver when a binding actually changes. There is one tracker per thread, matching
+// GL's one-current-context-per-thread rule; call Reset() whenever a context is made current.
+class GLState {
+public:
+	// Texture units tracked (bindings on higher units pass straight through)
+	static const int MAX_TEXTURE_UNITS = 32;
+
+	// Calls issued to / elided from the driver since the last ResetStats()
+	struct Stats {
+		unsigned int issued = 0;
+		unsigned int skipped = 0;
+		unsigned int mismatches = 0;
+	};
+
+	// Returns the calling thread's tracker
+	static GLState& Get();
+
+	// Forgets everything, forcing the next call of every kind through to GL
+	void Reset();
+
+	// Direct state access (GL 4.5): when available, the wrapper classes create and edit objects by
+	// name instead of binding them first. Disabling it, or a context older than 4.5, selects the
+	// bind-to-edit path. Objects are created differently by the two paths, so only switch while no
+	// wrapper objects exist
+	bool DirectStateAccess() const { return allowDSA && GLAD_GL_VERSION_4_5; }
+	void SetDirectStateAccess(bool enabled) { allowDSA = enabled; }
+
+	// When enabled, every call compares the cache against glGet* and reports divergence
+	void SetValidation(bool enabled) { validate = enabled; }
+	bool IsValidating() const { return validate; }
+
+	// Cached glUseProgram
+	void UseProgram(GLuint program);
+
+	// Cached glBindVertexArray (the element buffer binding follows the VAO)
+	void BindVertexArray(GLuint vertexArray);
+
+	// Cached glBindBuffer
+	void BindBuffer(GLenum target, GLuint buffer);
+
+	// glBindBufferRange, which also replaces the generic binding of target (always issued)
+	void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+	// glVertexArrayElementBuffer (DSA), keeping the per-VAO element buffer cache in sync
+	void VertexArrayElementBuffer(GLuint vertexArray, GLuint buffer);
+
+	// Cached glActiveTexture (unit is GL_TEXTURE0 + n)
+	void ActiveTexture(GLenum unit);
+
+	// Cached glBindTexture on the active unit
+	void BindTexture(GLenum target, GLuint texture);
+
+	// Cached glEnable / glDisable
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+
+	// Drop cached bindings of deleted objects (GL unbinds them and may reuse the name)
+	void DeleteProgram(GLuint program);
+	void DeleteVertexArray(GLuint vertexArray);
+	void DeleteBuffer(GLuint buffer);
+	void DeleteTexture(GLuint texture);
+
+	Stats stats;
+	void ResetStats() { stats = Stats(); }
+
+private:
+	// Marks a binding whose value isn't known
+	static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+	// Buffer targets that aren't VAO state
+	enum BufferSlot { ARRAY, PIXEL_PACK, PIXEL_UNPACK, UNIFORM, COPY_READ, COPY_WRITE, DRAW_INDIRECT, SHADER_STORAGE, BUFFER_SLOTS };
+
+	// Texture targets tracked per unit
+	enum TextureSlot { TEX_2D, TEX_2D_ARRAY, TEX_3D, TEX_CUBE, TEXTURE_SLOTS };
+
+	GLuint program = UNKNOWN;
+	GLuint vertexArray = UNKNOWN;
+	GLuint buffers[BUFFER_SLOTS];
+	GLenum activeUnit = UNKNOWN;
+	GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_SLOTS];
+
+	// GL_ELEMENT_ARRAY_BUFFER per VAO (element bindings are part of the VAO)
+	std::unordered_map<GLuint, GLuint> elementBuffers;
+
+	// Known enable state per capability
+	std::unordered_map<GLenum, bool> capabilities;
+
+	bool validate = false;
+	bool allowDSA = true;
+
+	GLState();
+
+	// Maps a target to its cache slot, -1 for targets that aren't tracked
+	static int bufferSlot(GLenum target);
+	static int textureSlot(GLenum target);
+	static GLenum bindingQuery(GLenum target);
+
+	// Compares a cached value with the driver's
+	void check(const char* what, GLenum query, GLint expected);
+};
+
+#endif
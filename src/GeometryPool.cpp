@@ -0,0 +1,274 @@
+#include "GeometryPool.h"
+#include "EBO.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+// Writes size bytes at offset into a buffer (by name with direct state access)
+static void writeBuffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+	if (GLState::Get().DirectStateAccess()) {
+		glNamedBufferSubData(buffer, offset, size, data);
+	}
+	else {
+		GLState::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	}
+}
+
+// Copies size bytes between buffers on the GPU (the copy targets stay bound for the next copy)
+static void copyBuffer(GLuint from, GLuint to, GLintptr fromOffset, GLintptr toOffset, GLsizeiptr size) {
+	if (GLState::Get().DirectStateAccess()) {
+		glCopyNamedBufferSubData(from, to, fromOffset, toOffset, size);
+	}
+	else {
+		GLState::Get().BindBuffer(GL_COPY_READ_BUFFER, from);
+		GLState::Get().BindBuffer(GL_COPY_WRITE_BUFFER, to);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, fromOffset, toOffset, size);
+	}
+}
+
+// Constructor that creates the buffers with room for the given number of vertices and indices
+GeometryPool::GeometryPool(const VertexFormat& format, uint32_t vertexCapacity, uint32_t indexCapacity, GLenum indexType)
+	: format(format), indexType(indexType), indexSize(indexType == GL_UNSIGNED_SHORT ? 2 : 4), vertexRanges(vertexCapacity), indexRanges(indexCapacity) {
+	createBuffers(vertexCapacity, indexCapacity, vertexBuffer, indexBuffer);
+	linkVAO();
+}
+
+// Uploads a mesh and returns its handle
+MeshHandle GeometryPool::Allocate(const void* vertices, uint32_t vertexCount, const GLuint* indices, uint32_t indexCount) {
+	PROFILE_ZONE("GeometryPool::Allocate");
+	if (vertexCount == 0 || indexCount == 0) {
+		return INVALID_MESH;
+	}
+	if (indexType == GL_UNSIGNED_SHORT && EBO::IndexTypeFor(indices, indexCount) != GL_UNSIGNED_SHORT) {
+		std::cerr << "GeometryPool: mesh indices don't fit the pool's 16-bit index type" << std::endl;
+		return INVALID_MESH;
+	}
+
+	uint32_t firstVertex = vertexRanges.Allocate(vertexCount);
+	uint32_t firstIndex = indexRanges.Allocate(indexCount);
+	if (firstVertex == RangeAllocator::INVALID || firstIndex == RangeAllocator::INVALID) {
+		if (firstVertex != RangeAllocator::INVALID) {
+			vertexRanges.Free(firstVertex, vertexCount);
+		}
+		if (firstIndex != RangeAllocator::INVALID) {
+			indexRanges.Free(firstIndex, indexCount);
+		}
+
+		// Compacting is enough if the space exists but is splintered, otherwise the buffers grow
+		if (vertexRanges.FreeSpace() >= vertexCount && indexRanges.FreeSpace() >= indexCount) {
+			Defragment();
+		}
+		if (vertexRanges.LargestFree() < vertexCount || indexRanges.LargestFree() < indexCount) {
+			grow(vertexCount, indexCount);
+		}
+		firstVertex = vertexRanges.Allocate(vertexCount);
+		firstIndex = indexRanges.Allocate(indexCount);
+	}
+
+	writeBuffer(vertexBuffer, (GLintptr)firstVertex * format.stride, (GLsizeiptr)vertexCount * format.stride, vertices);
+	if (indexType == GL_UNSIGNED_SHORT) {
+		std::vector<GLushort> narrow(indices, indices + indexCount);
+		writeBuffer(indexBuffer, (GLintptr)firstIndex * indexSize, (GLsizeiptr)indexCount * indexSize, narrow.data());
+	}
+	else {
+		writeBuffer(indexBuffer, (GLintptr)firstIndex * indexSize, (GLsizeiptr)indexCount * indexSize, indices);
+	}
+
+	Mesh mesh = { { (GLint)firstVertex, firstIndex, (GLsizei)indexCount, vertexCount }, true };
+	MeshHandle handle;
+	if (!freeHandles.empty()) {
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		meshes[handle] = mesh;
+	}
+	else {
+		handle = (MeshHandle)meshes.size();
+		meshes.push_back(mesh);
+	}
+	liveMeshes++;
+	return handle;
+}
+
+// Releases a mesh's ranges; may trigger Defragment()
+void GeometryPool::Free(MeshHandle handle) {
+	if (handle >= meshes.size() || !meshes[handle].live) {
+		std::cerr << "GeometryPool: freeing an invalid mesh handle " << handle << std::endl;
+		return;
+	}
+	Mesh& mesh = meshes[handle];
+	vertexRanges.Free((uint32_t)mesh.range.baseVertex, mesh.range.vertexCount);
+	indexRanges.Free(mesh.range.firstIndex, (uint32_t)mesh.range.indexCount);
+	mesh.live = false;
+	freeHandles.push_back(handle);
+	liveMeshes--;
+
+	// A handful of holes isn't worth a copy of the whole pool
+	size_t holes = std::max(vertexRanges.FreeRanges(), indexRanges.FreeRanges());
+	if (holes > 4 && std::max(vertexRanges.Fragmentation(), indexRanges.Fragmentation()) > defragmentThreshold) {
+		Defragment();
+	}
+}
+
+// Binds the pool's VAO
+void GeometryPool::Bind() {
+	vao.Bind();
+}
+
+// Draws one mesh (the pool must be bound)
+void GeometryPool::Draw(MeshHandle handle) {
+	const MeshRange& range = meshes[handle].range;
+	glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, indexType, (const void*)IndexOffset(handle), range.baseVertex);
+}
+
+// Moves every live mesh to the front of its buffers so the free space is one range
+void GeometryPool::Defragment() {
+	PROFILE_ZONE("GeometryPool::Defragment");
+
+	// Copies go into fresh buffers, since glCopyBufferSubData can't move overlapping ranges in place
+	GLuint newVertexBuffer, newIndexBuffer;
+	createBuffers(vertexRanges.Capacity(), indexRanges.Capacity(), newVertexBuffer, newIndexBuffer);
+
+	// Keeps the meshes in their current order so neighbours stay neighbours
+	std::vector<MeshHandle> order;
+	for (MeshHandle handle = 0; handle < meshes.size(); handle++) {
+		if (meshes[handle].live) {
+			order.push_back(handle);
+		}
+	}
+	std::sort(order.begin(), order.end(), [this](MeshHandle a, MeshHandle b) { return meshes[a].range.baseVertex < meshes[b].range.baseVertex; });
+
+	// Meshes that were already adjacent move together, so each run of them is a single copy
+	struct Copy {
+		GLintptr from, to;
+		GLsizeiptr size;
+	};
+	std::vector<Copy> vertexCopies, indexCopies;
+	vertexRanges.Reset(vertexRanges.Capacity());
+	indexRanges.Reset(indexRanges.Capacity());
+	for (MeshHandle handle : order) {
+		MeshRange& range = meshes[handle].range;
+		uint32_t firstVertex = vertexRanges.Allocate(range.vertexCount);
+		uint32_t firstIndex = indexRanges.Allocate((uint32_t)range.indexCount);
+
+		Copy vertices = { (GLintptr)range.baseVertex * format.stride, (GLintptr)firstVertex * format.stride, (GLsizeiptr)range.vertexCount * format.stride };
+		if (!vertexCopies.empty() && vertexCopies.back().from + vertexCopies.back().size == vertices.from) {
+			vertexCopies.back().size += vertices.size;
+		}
+		else {
+			vertexCopies.push_back(vertices);
+		}
+		Copy indices = { (GLintptr)range.firstIndex * indexSize, (GLintptr)firstIndex * indexSize, (GLsizeiptr)range.indexCount * indexSize };
+		if (!indexCopies.empty() && indexCopies.back().from + indexCopies.back().size == indices.from) {
+			indexCopies.back().size += indices.size;
+		}
+		else {
+			indexCopies.push_back(indices);
+		}
+
+		range.baseVertex = (GLint)firstVertex;
+		range.firstIndex = firstIndex;
+	}
+
+	for (const Copy& copy : vertexCopies) {
+		copyBuffer(vertexBuffer, newVertexBuffer, copy.from, copy.to, copy.size);
+	}
+	for (const Copy& copy : indexCopies) {
+		copyBuffer(indexBuffer, newIndexBuffer, copy.from, copy.to, copy.size);
+	}
+
+	GLState& state = GLState::Get();
+	state.DeleteBuffer(vertexBuffer);
+	state.DeleteBuffer(indexBuffer);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	vertexBuffer = newVertexBuffer;
+	indexBuffer = newIndexBuffer;
+	linkVAO();
+	defragmentations++;
+}
+
+// Returns the current utilization
+GeometryPool::Stats GeometryPool::GetStats() const {
+	Stats stats;
+	stats.meshes = liveMeshes;
+	stats.vertexCapacity = vertexRanges.Capacity();
+	stats.verticesUsed = vertexRanges.Used();
+	stats.indexCapacity = indexRanges.Capacity();
+	stats.indicesUsed = indexRanges.Used();
+	stats.freeVertexRanges = vertexRanges.FreeRanges();
+	stats.freeIndexRanges = indexRanges.FreeRanges();
+	stats.vertexFragmentation = vertexRanges.Fragmentation();
+	stats.indexFragmentation = indexRanges.Fragmentation();
+	stats.grows = grows;
+	stats.defragmentations = defragmentations;
+	return stats;
+}
+
+// Deletes the VAO and buffers
+void GeometryPool::Delete() {
+	vao.Delete();
+	GLState::Get().DeleteBuffer(vertexBuffer);
+	GLState::Get().DeleteBuffer(indexBuffer);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+}
+
+// Creates buffers of the given capacities (copying nothing)
+void GeometryPool::createBuffers(uint32_t vertexCapacity, uint32_t indexCapacity, GLuint& newVertexBuffer, GLuint& newIndexBuffer) {
+	GLState& state = GLState::Get();
+	if (state.DirectStateAccess()) {
+		// Growing replaces the buffers, so their storage can be immutable
+		glCreateBuffers(1, &newVertexBuffer);
+		glNamedBufferStorage(newVertexBuffer, (GLsizeiptr)vertexCapacity * format.stride, NULL, GL_DYNAMIC_STORAGE_BIT);
+		glCreateBuffers(1, &newIndexBuffer);
+		glNamedBufferStorage(newIndexBuffer, (GLsizeiptr)indexCapacity * indexSize, NULL, GL_DYNAMIC_STORAGE_BIT);
+		return;
+	}
+	glGenBuffers(1, &newVertexBuffer);
+	state.BindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * format.stride, NULL, GL_STATIC_DRAW);
+	glGenBuffers(1, &newIndexBuffer);
+	state.BindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * indexSize, NULL, GL_STATIC_DRAW);
+}
+
+// Points the VAO at the current buffers
+void GeometryPool::linkVAO() {
+	format.Link(vao.ID, vertexBuffer);
+	if (GLState::Get().DirectStateAccess()) {
+		GLState::Get().VertexArrayElementBuffer(vao.ID, indexBuffer);
+	}
+	else {
+		GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	}
+}
+
+// Grows the buffers so that the given counts fit in one free range each
+void GeometryPool::grow(uint32_t vertexCount, uint32_t indexCount) {
+	PROFILE_ZONE("GeometryPool grow");
+
+	// Doubling keeps the number of copies logarithmic; the free tail must fit the request on its own
+	uint32_t vertexCapacity = std::max(vertexRanges.Capacity() * 2, vertexRanges.Capacity() + vertexCount);
+	uint32_t indexCapacity = std::max(indexRanges.Capacity() * 2, indexRanges.Capacity() + indexCount);
+
+	GLuint newVertexBuffer, newIndexBuffer;
+	createBuffers(vertexCapacity, indexCapacity, newVertexBuffer, newIndexBuffer);
+
+	copyBuffer(vertexBuffer, newVertexBuffer, 0, 0, (GLsizeiptr)vertexRanges.Capacity() * format.stride);
+	copyBuffer(indexBuffer, newIndexBuffer, 0, 0, (GLsizeiptr)indexRanges.Capacity() * indexSize);
+
+	GLState& state = GLState::Get();
+	state.DeleteBuffer(vertexBuffer);
+	state.DeleteBuffer(indexBuffer);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	vertexBuffer = newVertexBuffer;
+	indexBuffer = newIndexBuffer;
+	vertexRanges.Grow(vertexCapacity);
+	indexRanges.Grow(indexCapacity);
+	linkVAO();
+	grows++;
+}
@@ -0,0 +1,123 @@
+#ifndef GEOMETRY_POOL_CLASS_H
+#define GEOMETRY_POOL_CLASS_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RangeAllocator.h"
+#include "VertexFormat.h"
+#include "VAO.h"
+
+// Index of a mesh inside a GeometryPool (stays valid across growth and defragmentation)
+typedef uint32_t MeshHandle;
+static const MeshHandle INVALID_MESH = 0xFFFFFFFFu;
+
+// Where a mesh lives inside the pool's shared buffers
+struct MeshRange {
+	GLint baseVertex;    // added to every index by glDrawElementsBaseVertex
+	GLuint firstIndex;   // in indices, not bytes
+	GLsizei indexCount;
+	GLuint vertexCount;
+};
+
+// Sub-allocates the vertices and indices of many meshes out of one vertex buffer and one
+// index buffer that share a vertex format, so every mesh draws from the same VAO (with
+// glDrawElementsBaseVertex, or an IndirectBatch attached to the pool's VAO). Buffers grow
+// by copying on the GPU; when freed ranges splinter past a threshold, live meshes are compacted.
+// Indices are relative to each mesh, so a GL_UNSIGNED_SHORT pool holds any number of meshes as long
+// as each one has fewer than 65535 vertices.
+class GeometryPool {
+public:
+	// Utilization snapshot
+	struct Stats {
+		unsigned int meshes = 0;
+		uint32_t vertexCapacity = 0;
+		uint32_t verticesUsed = 0;
+		uint32_t indexCapacity = 0;
+		uint32_t indicesUsed = 0;
+		size_t freeVertexRanges = 0;
+		size_t freeIndexRanges = 0;
+		float vertexFragmentation = 0.0f;
+		float indexFragmentation = 0.0f;
+		unsigned int grows = 0;
+		unsigned int defragmentations = 0;
+	};
+
+	// The VAO every mesh in the pool is drawn with
+	VAO vao;
+
+	// Constructor that creates the buffers with room for the given number of vertices and indices,
+	// stored as indexType (GL_UNSIGNED_INT or GL_UNSIGNED_SHORT)
+	GeometryPool(const VertexFormat& format, uint32_t vertexCapacity = 1 << 16, uint32_t indexCapacity = 1 << 18, GLenum indexType = GL_UNSIGNED_INT);
+
+	// Uploads a mesh (indices are relative to its own first vertex) and returns its handle, or
+	// INVALID_MESH if an index doesn't fit the pool's index type
+	MeshHandle Allocate(const void* vertices, uint32_t vertexCount, const GLuint* indices, uint32_t indexCount);
+
+	// Same, taking the counts from arrays
+	template <typename Vertex, size_t V, size_t I>
+	MeshHandle Allocate(const Vertex (&vertices)[V], const GLuint (&indices)[I]) {
+		return Allocate(vertices, (uint32_t)V, indices, (uint32_t)I);
+	}
+
+	// Releases a mesh's ranges; may trigger Defragment()
+	void Free(MeshHandle mesh);
+
+	// Returns where a mesh currently lives
+	const MeshRange& Get(MeshHandle mesh) const { return meshes[mesh].range; }
+
+	// Type of the pool's indices and the byte offset of a mesh's first index, for glDrawElements* calls
+	GLenum IndexType() const { return indexType; }
+	GLintptr IndexOffset(MeshHandle mesh) const { return (GLintptr)meshes[mesh].range.firstIndex * indexSize; }
+
+	// Binds the pool's VAO
+	void Bind();
+
+	// Draws one mesh (the pool must be bound)
+	void Draw(MeshHandle mesh);
+
+	// Moves every live mesh to the front of its buffers so the free space is one range
+	void Defragment();
+
+	// Fragmentation (see RangeAllocator::Fragmentation) above which Free() compacts the pool
+	void SetDefragmentThreshold(float threshold) { defragmentThreshold = threshold; }
+
+	// Returns the current utilization
+	Stats GetStats() const;
+
+	// Deletes the VAO and buffers
+	void Delete();
+
+private:
+	struct Mesh {
+		MeshRange range;
+		bool live;
+	};
+
+	VertexFormat format;
+	GLenum indexType;
+	GLsizeiptr indexSize;
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+	RangeAllocator vertexRanges;
+	RangeAllocator indexRanges;
+	std::vector<Mesh> meshes;
+	std::vector<MeshHandle> freeHandles;
+	float defragmentThreshold = 0.5f;
+	unsigned int liveMeshes = 0;
+	unsigned int grows = 0;
+	unsigned int defragmentations = 0;
+
+	// Replaces the buffers with new ones of the given capacities (copying nothing)
+	void createBuffers(uint32_t vertexCapacity, uint32_t indexCapacity, GLuint& newVertexBuffer, GLuint& newIndexBuffer);
+
+	// Points the VAO at the current buffers
+	void linkVAO();
+
+	// Grows the buffers so that the given counts fit in one free range each
+	void grow(uint32_t vertexCount, uint32_t indexCount);
+};
+
+#endif
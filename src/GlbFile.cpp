@@ -0,0 +1,307 @@
+#include "GlbFile.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+static const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+static const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+static const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+// Where an accessor's elements live inside the mapped BIN chunk
+struct GlbAccessor {
+	const unsigned char* data = nullptr;
+	size_t count = 0;
+	size_t stride = 0;
+	int components = 0;
+	int componentType = 0;
+	bool normalized = false;
+};
+
+// Everything the primitive readers need
+struct GlbContext {
+	const char* path;
+	const JsonValue& gltf;
+	const unsigned char* bin;
+	size_t binSize;
+};
+
+// Resolves accessor index to a view of the BIN chunk, checking that every element lies inside it
+static bool accessorView(const GlbContext& context, int index, GlbAccessor& view) {
+	const JsonValue& accessor = context.gltf["accessors"][(size_t)index];
+	if (index < 0 || accessor.IsNull()) {
+		std::cerr << context.path << ": missing accessor " << index << std::endl;
+		return false;
+	}
+	if (!accessor["sparse"].IsNull() || accessor["bufferView"].IsNull()) {
+		std::cerr << context.path << ": sparse or zero-filled accessors aren't supported" << std::endl;
+		return false;
+	}
+	const JsonValue& bufferView = context.gltf["bufferViews"][(size_t)accessor["bufferView"].Int()];
+	if (bufferView.IsNull() || bufferView["buffer"].Int() != 0 || !context.gltf["buffers"][(size_t)0]["uri"].IsNull()) {
+		std::cerr << context.path << ": only data in the file's own BIN chunk is supported" << std::endl;
+		return false;
+	}
+
+	const std::string& type = accessor["type"].String();
+	view.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+	view.componentType = accessor["componentType"].Int();
+	int componentSize = view.componentType == GL_BYTE || view.componentType == GL_UNSIGNED_BYTE ? 1
+		: view.componentType == GL_SHORT || view.componentType == GL_UNSIGNED_SHORT ? 2
+		: view.componentType == GL_UNSIGNED_INT || view.componentType == GL_FLOAT ? 4 : 0;
+	if (view.components == 0 || componentSize == 0) {
+		std::cerr << context.path << ": unsupported accessor type " << type << " / " << view.componentType << std::endl;
+		return false;
+	}
+
+	size_t elementSize = (size_t)view.components * componentSize;
+	size_t viewOffset = (size_t)bufferView["byteOffset"].Number();
+	size_t viewLength = (size_t)bufferView["byteLength"].Number();
+	size_t offset = (size_t)accessor["byteOffset"].Number();
+	view.count = (size_t)accessor["count"].Number();
+	view.stride = bufferView["byteStride"].IsNull() ? elementSize : (size_t)bufferView["byteStride"].Number();
+	view.normalized = accessor["normalized"].Bool();
+	if (viewOffset + viewLength > context.binSize || (view.count > 0 && offset + view.stride * (view.count - 1) + elementSize > viewLength)) {
+		std::cerr << context.path << ": accessor " << index << " reaches past its buffer view" << std::endl;
+		return false;
+	}
+	view.data = context.bin + viewOffset + offset;
+	return true;
+}
+
+// Reads element i of an accessor as floats (missing components default to 0, w to 1)
+static glm::vec4 readElement(const GlbAccessor& view, size_t i) {
+	const unsigned char* element = view.data + i * view.stride;
+	glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+	for (int c = 0; c < view.components; c++) {
+		switch (view.componentType) {
+		case GL_FLOAT: {
+			float f;
+			std::memcpy(&f, element + c * 4, 4);
+			value[c] = f;
+			break;
+		}
+		case GL_UNSIGNED_BYTE:
+			value[c] = view.normalized ? element[c] / 255.0f : (float)element[c];
+			break;
+		case GL_BYTE:
+			value[c] = view.normalized ? glm::max((int8_t)element[c] / 127.0f, -1.0f) : (float)(int8_t)element[c];
+			break;
+		case GL_UNSIGNED_SHORT: {
+			uint16_t u;
+			std::memcpy(&u, element + c * 2, 2);
+			value[c] = view.normalized ? u / 65535.0f : (float)u;
+			break;
+		}
+		case GL_SHORT: {
+			int16_t s;
+			std::memcpy(&s, element + c * 2, 2);
+			value[c] = view.normalized ? glm::max(s / 32767.0f, -1.0f) : (float)s;
+			break;
+		}
+		case GL_UNSIGNED_INT: {
+			uint32_t u;
+			std::memcpy(&u, element + c * 4, 4);
+			value[c] = (float)u;
+			break;
+		}
+		}
+	}
+	return value;
+}
+
+// Reads element i of an index accessor
+static uint32_t readIndex(const GlbAccessor& view, size_t i) {
+	const unsigned char* element = view.data + i * view.stride;
+	if (view.componentType == GL_UNSIGNED_BYTE) {
+		return element[0];
+	}
+	if (view.componentType == GL_UNSIGNED_SHORT) {
+		uint16_t index;
+		std::memcpy(&index, element, 2);
+		return index;
+	}
+	uint32_t index;
+	std::memcpy(&index, element, 4);
+	return index;
+}
+
+// Appends one primitive, transformed by world
+static bool appendPrimitive(const GlbContext& context, const JsonValue& primitive, const glm::mat4& world, MeshData& mesh) {
+	if (primitive["mode"].Int(4) != 4) {
+		// Points, lines and strips have no place in a triangle list
+		return true;
+	}
+	const JsonValue& attributes = primitive["attributes"];
+	GlbAccessor positions, normals, uvs, colors, indices;
+	if (!accessorView(context, attributes["POSITION"].Int(-1), positions)) {
+		return false;
+	}
+	bool hasNormals = !attributes["NORMAL"].IsNull();
+	bool hasUVs = !attributes["TEXCOORD_0"].IsNull();
+	bool hasColors = !attributes["COLOR_0"].IsNull();
+	bool hasIndices = !primitive["indices"].IsNull();
+	if ((hasNormals && !accessorView(context, attributes["NORMAL"].Int(), normals))
+		|| (hasUVs && !accessorView(context, attributes["TEXCOORD_0"].Int(), uvs))
+		|| (hasColors && !accessorView(context, attributes["COLOR_0"].Int(), colors))
+		|| (hasIndices && !accessorView(context, primitive["indices"].Int(), indices))) {
+		return false;
+	}
+	if ((hasNormals && normals.count < positions.count) || (hasUVs && uvs.count < positions.count) || (hasColors && colors.count < positions.count)) {
+		std::cerr << context.path << ": attribute accessors shorter than POSITION" << std::endl;
+		return false;
+	}
+
+	size_t firstVertex = mesh.vertices.size();
+	size_t firstIndex = mesh.indices.size();
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+	mesh.vertices.resize(firstVertex + positions.count);
+	for (size_t i = 0; i < positions.count; i++) {
+		MeshVertex& vertex = mesh.vertices[firstVertex + i];
+		vertex.position = glm::vec3(world * glm::vec4(glm::vec3(readElement(positions, i)), 1.0f));
+		vertex.normal = hasNormals ? glm::normalize(normalMatrix * glm::vec3(readElement(normals, i))) : glm::vec3(0.0f);
+		vertex.uv = hasUVs ? glm::vec2(readElement(uvs, i)) : glm::vec2(0.0f);
+		vertex.color = hasColors ? readElement(colors, i) : glm::vec4(1.0f);
+	}
+
+	size_t indexCount = hasIndices ? indices.count : positions.count;
+	mesh.indices.resize(firstIndex + indexCount / 3 * 3);
+	// A mirroring transform turns the triangles inside out unless their winding is flipped too
+	bool flip = glm::determinant(glm::mat3(world)) < 0.0f;
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		for (int k = 0; k < 3; k++) {
+			uint32_t index = hasIndices ? readIndex(indices, i + k) : (uint32_t)(i + k);
+			if (index >= positions.count) {
+				std::cerr << context.path << ": index " << index << " past the end of its primitive" << std::endl;
+				return false;
+			}
+			int corner = flip && k > 0 ? 3 - k : k;
+			mesh.indices[firstIndex + i + corner] = (GLuint)(firstVertex + index);
+		}
+	}
+	if (!hasNormals) {
+		GenerateNormals(mesh, firstIndex);
+	}
+	return true;
+}
+
+// Local transform of a node (a matrix or translation * rotation * scale)
+static glm::mat4 nodeTransform(const JsonValue& node) {
+	const JsonValue& matrix = node["matrix"];
+	if (matrix.Size() == 16) {
+		glm::mat4 result;
+		for (int i = 0; i < 16; i++) {
+			glm::value_ptr(result)[i] = (float)matrix[(size_t)i].Number();
+		}
+		return result;
+	}
+	const JsonValue& t = node["translation"];
+	const JsonValue& r = node["rotation"];
+	const JsonValue& s = node["scale"];
+	glm::vec3 translation((float)t[(size_t)0].Number(), (float)t[1].Number(), (float)t[2].Number());
+	glm::quat rotation((float)r[3].Number(1.0), (float)r[(size_t)0].Number(), (float)r[1].Number(), (float)r[2].Number());
+	glm::vec3 scale((float)s[(size_t)0].Number(1.0), (float)s[1].Number(1.0), (float)s[2].Number(1.0));
+	return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+}
+
+// Appends the meshes of a node and its descendants
+static bool appendNode(const GlbContext& context, size_t index, const glm::mat4& parent, MeshData& mesh, int depth) {
+	const JsonValue& node = context.gltf["nodes"][index];
+	// glTF forbids cycles, but a broken file shouldn't overflow the stack
+	if (node.IsNull() || depth > 64) {
+		return true;
+	}
+	glm::mat4 world = parent * nodeTransform(node);
+	if (!node["mesh"].IsNull()) {
+		const JsonValue& primitives = context.gltf["meshes"][(size_t)node["mesh"].Int()]["primitives"];
+		for (size_t p = 0; p < primitives.Size(); p++) {
+			if (!appendPrimitive(context, primitives[p], world, mesh)) {
+				return false;
+			}
+		}
+	}
+	const JsonValue& children = node["children"];
+	for (size_t c = 0; c < children.Size(); c++) {
+		if (!appendNode(context, (size_t)children[c].Int(), world, mesh, depth + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reads every triangle primitive of a .glb into one mesh
+bool LoadGlb(const char* path, MeshData& mesh) {
+	PROFILE_ZONE("LoadGlb");
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// 12-byte header, then chunks of { length, type, data padded to 4 bytes }
+	const unsigned char* data = file.Data();
+	size_t size = file.Size();
+	uint32_t header[3];
+	if (size < 20 || (std::memcpy(header, data, 12), header[0] != GLB_MAGIC) || header[1] != 2 || header[2] > size) {
+		std::cerr << path << ": not a glTF 2.0 binary file" << std::endl;
+		return false;
+	}
+	const unsigned char* json = nullptr;
+	const unsigned char* bin = nullptr;
+	size_t jsonSize = 0, binSize = 0;
+	for (size_t offset = 12; offset + 8 <= header[2];) {
+		uint32_t chunk[2];
+		std::memcpy(chunk, data + offset, 8);
+		if (offset + 8 + chunk[0] > header[2]) {
+			std::cerr << path << ": truncated chunk" << std::endl;
+			return false;
+		}
+		if (chunk[1] == GLB_CHUNK_JSON && !json) {
+			json = data + offset + 8;
+			jsonSize = chunk[0];
+		}
+		else if (chunk[1] == GLB_CHUNK_BIN && !bin) {
+			bin = data + offset + 8;
+			binSize = chunk[0];
+		}
+		offset += 8 + ((chunk[0] + 3) & ~3u);
+	}
+
+	JsonValue gltf;
+	if (!json || !ParseJson((const char*)json, jsonSize, gltf)) {
+		std::cerr << path << ": missing or invalid JSON chunk" << std::endl;
+		return false;
+	}
+	GlbContext context = { path, gltf, bin, binSize };
+
+	// Nodes of the default scene; files without scenes just list their meshes
+	const JsonValue& scene = gltf["scenes"][(size_t)gltf["scene"].Int(0)];
+	if (!scene.IsNull()) {
+		const JsonValue& roots = scene["nodes"];
+		for (size_t n = 0; n < roots.Size(); n++) {
+			if (!appendNode(context, (size_t)roots[n].Int(), glm::mat4(1.0f), mesh, 0)) {
+				return false;
+			}
+		}
+	}
+	else {
+		const JsonValue& meshes = gltf["meshes"];
+		for (size_t m = 0; m < meshes.Size(); m++) {
+			const JsonValue& primitives = meshes[m]["primitives"];
+			for (size_t p = 0; p < primitives.Size(); p++) {
+				if (!appendPrimitive(context, primitives[p], glm::mat4(1.0f), mesh)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
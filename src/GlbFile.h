@@ -0,0 +1,12 @@
+#ifndef GLB_FILE_H
+#define GLB_FILE_H
+
+#include "MeshData.h"
+
+// Reads every triangle primitive of a binary glTF 2.0 file (.glb) into one mesh, with the node
+// transforms of the default scene applied. The file is memory-mapped and accessors are read
+// straight out of its BIN chunk into the interleaved vertices, without loading it into a buffer
+// first. Buffers outside the file and sparse accessors aren't supported
+bool LoadGlb(const char* path, MeshData& mesh);
+
+#endif
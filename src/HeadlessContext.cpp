@@ -0,0 +1,167 @@
+#include "HeadlessContext.h"
+#include "GLState.h"
+
+#include <iostream>
+
+#ifdef GL_ENGINE_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// Creates the context, makes it current, loads GL functions and creates the framebuffer
+bool HeadlessContext::Create(int width, int height) {
+	HeadlessContext::width = width;
+	HeadlessContext::height = height;
+
+	if (!createEGL() && !createGLFW()) {
+		std::cerr << "Failed to create headless OpenGL context" << std::endl;
+		return false;
+	}
+
+	// Bindings cached for a previous context mean nothing in this one
+	GLState::Get().Reset();
+
+	std::cout << "Headless context: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+	// Render target standing in for the default framebuffer
+	framebuffer = new FBO(width, height);
+	if (!framebuffer->IsComplete()) {
+		std::cerr << "Headless framebuffer is incomplete" << std::endl;
+		Delete();
+		return false;
+	}
+	framebuffer->Bind();
+	glViewport(0, 0, width, height);
+	return true;
+}
+
+// Finishes all pending GL work for the frame (stands in for glfwSwapBuffers)
+void HeadlessContext::SwapBuffers() {
+	// Without a swap chain nothing throttles the CPU, so wait for the GPU here to make
+	// per-frame timings include the actual rendering work
+	glFinish();
+}
+
+// Returns true if the context comes from EGL rather than a hidden GLFW window
+bool HeadlessContext::IsEGL() {
+	return eglContext != nullptr;
+}
+
+// Deletes the framebuffer and destroys the context
+void HeadlessContext::Delete() {
+	if (framebuffer) {
+		framebuffer->Delete();
+		delete framebuffer;
+		framebuffer = nullptr;
+	}
+
+#ifdef GL_ENGINE_HAS_EGL
+	if (eglDisplay) {
+		eglMakeCurrent((EGLDisplay)eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (eglContext) {
+			eglDestroyContext((EGLDisplay)eglDisplay, (EGLContext)eglContext);
+		}
+		eglTerminate((EGLDisplay)eglDisplay);
+		eglDisplay = nullptr;
+		eglContext = nullptr;
+	}
+#endif
+
+	if (window) {
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		window = nullptr;
+	}
+}
+
+// Creates a surfaceless EGL context (no window system needed)
+bool HeadlessContext::createEGL() {
+#ifdef GL_ENGINE_HAS_EGL
+	// Prefer the Mesa surfaceless platform, which needs neither X11/Wayland nor a GPU
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		return false;
+	}
+	eglDisplay = display;
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		Delete();
+		return false;
+	}
+
+	// We never create an EGL surface, the FBO is the only render target
+	EGLint configAttribs[] = {
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_SURFACE_TYPE, 0,
+		EGL_NONE
+	};
+	EGLConfig config = nullptr;
+	EGLint numConfigs = 0;
+	eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
+
+	// Ask for the newest core profile first so optional GL 4.x paths are available, then fall back to 3.3
+	const EGLint versions[][2] = { { 4, 6 }, { 4, 5 }, { 3, 3 } };
+	for (const EGLint* version : versions) {
+		EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, version[0],
+			EGL_CONTEXT_MINOR_VERSION, version[1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		EGLContext context = eglCreateContext(display, numConfigs > 0 ? config : (EGLConfig)0, EGL_NO_CONTEXT, contextAttribs);
+		if (context != EGL_NO_CONTEXT) {
+			eglContext = context;
+			break;
+		}
+	}
+
+	if (!eglContext || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)eglContext)) {
+		Delete();
+		return false;
+	}
+
+	// Load OpenGL function pointers through EGL rather than GLX/WGL
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		Delete();
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Creates an invisible GLFW window whose context renders into the FBO
+bool HeadlessContext::createGLFW() {
+	if (!glfwInit()) {
+		return false;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	window = glfwCreateWindow(width, height, "Headless", NULL, NULL);
+	if (window == nullptr) {
+		glfwTerminate();
+		return false;
+	}
+
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGL()) {
+		Delete();
+		return false;
+	}
+	return true;
+}
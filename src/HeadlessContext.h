@@ -0,0 +1,46 @@
+#ifndef HEADLESS_CONTEXT_CLASS_H
+#define HEADLESS_CONTEXT_CLASS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "FBO.h"
+
+// Offscreen OpenGL context that renders into an FBO instead of a window.
+// Uses a surfaceless EGL context when the engine is built with EGL (works under Mesa llvmpipe
+// without any display or GPU), otherwise falls back to an invisible GLFW window.
+class HeadlessContext {
+public:
+	// Size of the offscreen framebuffer
+	int width = 0;
+	int height = 0;
+
+	// Offscreen render target, valid after a successful Create()
+	FBO* framebuffer = nullptr;
+
+	// Creates the context, makes it current, loads GL functions and creates the framebuffer
+	bool Create(int width, int height);
+
+	// Finishes all pending GL work for the frame (stands in for glfwSwapBuffers)
+	void SwapBuffers();
+
+	// Returns true if the context comes from EGL rather than a hidden GLFW window
+	bool IsEGL();
+
+	// Deletes the framebuffer and destroys the context
+	void Delete();
+
+private:
+	// EGL handles (kept as void* so EGL headers don't leak into the engine)
+	void* eglDisplay = nullptr;
+	void* eglContext = nullptr;
+
+	// Fallback hidden window
+	GLFWwindow* window = nullptr;
+
+	// Context creation backends
+	bool createEGL();
+	bool createGLFW();
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "IndirectBatch.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+// Picks the best mode the current context supports
+IndirectBatch::Mode IndirectBatch::BestMode() {
+	// glad leaves the pointer null when the context is older than 4.3
+	return glMultiDrawElementsIndirect ? Mode::MultiDrawIndirect : Mode::DrawLoop;
+}
+
+// Constructor that creates the command and per-draw buffers
+IndirectBatch::IndirectBatch(Mode mode) : mode(mode) {
+	if (mode == Mode::MultiDrawIndirect) {
+		glGenBuffers(1, &indirectBuffer);
+	}
+}
+
+// Links the per-draw data into the VAO holding the batch's geometry (leaves the VAO bound)
+void IndirectBatch::Attach(VAO& vao, GLuint location) {
+	IndirectBatch::location = location;
+	if (mode == Mode::MultiDrawIndirect) {
+		perDraw.Attach(vao, location);
+	}
+	else {
+		// The loop sets the attributes as constants, which only applies while their arrays are disabled
+		vao.Bind();
+		for (GLuint i = 0; i < 4; i++) {
+			glDisableVertexAttribArray(location + i);
+		}
+	}
+}
+
+// Appends a draw
+void IndirectBatch::Add(GLuint count, GLuint firstIndex, GLint baseVertex, const InstanceData& data) {
+	DrawElementsIndirectCommand command = { count, 1, firstIndex, baseVertex, (GLuint)commands.size() };
+	commands.push_back(command);
+	IndirectBatch::data.push_back(data);
+	dirty = true;
+}
+
+// Removes every draw
+void IndirectBatch::Clear() {
+	commands.clear();
+	data.clear();
+	dirty = true;
+}
+
+// Issues all draws; the batch's VAO must be bound
+void IndirectBatch::Draw(GLenum indexType) {
+	PROFILE_ZONE("IndirectBatch::Draw");
+	if (commands.empty()) {
+		return;
+	}
+	GLuint indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : indexType == GL_UNSIGNED_BYTE ? 1 : 4;
+
+	if (mode == Mode::MultiDrawIndirect) {
+		if (dirty) {
+			upload();
+		}
+		GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const void*)0, (GLsizei)commands.size(), 0);
+		return;
+	}
+
+	for (size_t i = 0; i < commands.size(); i++) {
+		const DrawElementsIndirectCommand& command = commands[i];
+		const InstanceData& instance = data[i];
+		glVertexAttrib4fv(location, &instance.rows[0].x);
+		glVertexAttrib4fv(location + 1, &instance.rows[1].x);
+		glVertexAttrib4fv(location + 2, &instance.rows[2].x);
+		glVertexAttrib4fv(location + 3, &instance.data.x);
+		glDrawElementsBaseVertex(GL_TRIANGLES, command.count, indexType, (const void*)((size_t)command.firstIndex * indexSize), command.baseVertex);
+	}
+}
+
+// Copies commands and per-draw data to their buffers
+void IndirectBatch::upload() {
+	PROFILE_ZONE("IndirectBatch upload");
+	GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	GLsizeiptr bytes = (GLsizeiptr)commands.size() * sizeof(DrawElementsIndirectCommand);
+	if ((GLsizei)commands.size() > indirectCapacity) {
+		indirectCapacity = std::max((GLsizei)commands.size(), indirectCapacity + indirectCapacity / 2);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)indirectCapacity * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+	}
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, bytes, commands.data());
+	perDraw.Update(data);
+	dirty = false;
+}
+
+// Deletes the buffers
+void IndirectBatch::Delete() {
+	if (indirectBuffer) {
+		GLState::Get().DeleteBuffer(indirectBuffer);
+		glDeleteBuffers(1, &indirectBuffer);
+	}
+	perDraw.Delete();
+}
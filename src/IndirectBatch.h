@@ -0,0 +1,73 @@
+#ifndef INDIRECT_BATCH_CLASS_H
+#define INDIRECT_BATCH_CLASS_H
+
+#include <glad/glad.h>
+#include <vector>
+
+#include "InstanceBuffer.h"
+#include "VAO.h"
+
+// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Many indexed draws out of one shared vertex/index buffer, submitted with a single
+// glMultiDrawElementsIndirect. Per-draw data (an InstanceData, so instanced.vert works as is)
+// lives in an instance stream and each command's baseInstance points at its own record, which
+// gives every draw its data without needing gl_DrawID.
+//
+// Contexts without GL 4.3 fall back to a loop of glDrawElementsBaseVertex that feeds the
+// per-draw data through constant attribute values instead.
+class IndirectBatch {
+public:
+	enum class Mode {
+		MultiDrawIndirect,
+		DrawLoop
+	};
+
+	// Picks the best mode the current context supports
+	static Mode BestMode();
+
+	// Constructor that creates the command and per-draw buffers
+	IndirectBatch(Mode mode = BestMode());
+
+	// Links the per-draw data into the VAO holding the batch's geometry (leaves the VAO bound)
+	void Attach(VAO& vao, GLuint location = InstanceBuffer::DEFAULT_LOCATION);
+
+	// Appends a draw of count indices starting at firstIndex (in indices, not bytes), with
+	// baseVertex added to every index
+	void Add(GLuint count, GLuint firstIndex, GLint baseVertex, const InstanceData& data);
+
+	// Removes every draw
+	void Clear();
+
+	// Issues all draws (uploading them first if they changed); the batch's VAO must be bound
+	void Draw(GLenum indexType = GL_UNSIGNED_INT);
+
+	// Number of draws in the batch
+	size_t Size() const { return commands.size(); }
+
+	Mode GetMode() const { return mode; }
+
+	// Deletes the buffers
+	void Delete();
+
+private:
+	Mode mode;
+	GLuint location = InstanceBuffer::DEFAULT_LOCATION;
+	GLuint indirectBuffer = 0;
+	GLsizei indirectCapacity = 0;
+	InstanceBuffer perDraw;
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<InstanceData> data;
+	bool dirty = false;
+
+	void upload();
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "InstanceBuffer.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+// Packs a model matrix (its last row is dropped) and the per-instance vec4
+InstanceData InstanceData::Make(const glm::mat4& model, const glm::vec4& data) {
+	// glm is column-major: row r is (model[0][r], model[1][r], model[2][r], model[3][r])
+	InstanceData instance;
+	for (int r = 0; r < 3; r++) {
+		instance.rows[r] = glm::vec4(model[0][r], model[1][r], model[2][r], model[3][r]);
+	}
+	instance.data = data;
+	return instance;
+}
+
+// Constructor that generates the buffer with room for capacity instances
+InstanceBuffer::InstanceBuffer(GLsizei capacity) : capacity(capacity) {
+	glGenBuffers(1, &ID);
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, ID);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+}
+
+// Links the per-instance attributes into a VAO (leaves the VAO bound)
+void InstanceBuffer::Attach(VAO& vao, GLuint location) {
+	vao.Bind();
+	Link(ID, 0, location);
+}
+
+// Points the per-instance attributes of the bound VAO at InstanceData records in any buffer
+void InstanceBuffer::Link(GLuint buffer, GLintptr offset, GLuint location) {
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (GLuint i = 0; i < 4; i++) {
+		glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + i * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(location + i);
+		// Advance once per instance instead of once per vertex
+		glVertexAttribDivisor(location + i, 1);
+	}
+}
+
+// Replaces the buffer contents, growing it if needed
+void InstanceBuffer::Update(const InstanceData* instances, GLsizei count) {
+	PROFILE_ZONE("InstanceBuffer::Update");
+	Bind();
+	if (count > capacity) {
+		capacity = std::max(count, capacity + capacity / 2);
+	}
+	// Orphan, then fill: the driver hands out fresh storage if the old one is still being read
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)count * sizeof(InstanceData), instances);
+	InstanceBuffer::count = count;
+}
+
+// Binds the buffer
+void InstanceBuffer::Bind() {
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, ID);
+}
+
+// Unbinds the buffer
+void InstanceBuffer::Unbind() {
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Deletes the buffer
+void InstanceBuffer::Delete() {
+	GLState::Get().DeleteBuffer(ID);
+	glDeleteBuffers(1, &ID);
+}
@@ -0,0 +1,62 @@
+#ifndef INSTANCE_BUFFER_CLASS_H
+#define INSTANCE_BUFFER_CLASS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "VAO.h"
+
+// Per-instance attributes: an affine model transform packed as the three rows of a 3x4 matrix
+// (the implicit fourth row is 0, 0, 0, 1) followed by a free vec4 (tint in instanced.vert).
+// 64 bytes instead of the 80 a mat4 + vec4 would take.
+struct InstanceData {
+	glm::vec4 rows[3];
+	glm::vec4 data;
+
+	// Packs a model matrix (its last row is dropped) and the per-instance vec4
+	static InstanceData Make(const glm::mat4& model, const glm::vec4& data = glm::vec4(1.0f));
+};
+
+// Vertex buffer holding one InstanceData per instance, read with glVertexAttribDivisor(1)
+class InstanceBuffer {
+public:
+	// Attribute locations used by Attach: rows at location .. location + 2, data at location + 3
+	static const GLuint DEFAULT_LOCATION = 3;
+
+	// Reference ID of the buffer
+	GLuint ID;
+
+	// Constructor that generates the buffer with room for capacity instances
+	InstanceBuffer(GLsizei capacity = 0);
+
+	// Links the per-instance attributes into a VAO (leaves the VAO bound)
+	void Attach(VAO& vao, GLuint location = DEFAULT_LOCATION);
+
+	// Points the per-instance attributes of the bound VAO at InstanceData records in any buffer
+	// (e.g. a StreamBuffer allocation), starting offset bytes in
+	static void Link(GLuint buffer, GLintptr offset, GLuint location = DEFAULT_LOCATION);
+
+	// Replaces the buffer contents, growing it if needed (the old storage is orphaned so
+	// in-flight draws never stall the upload)
+	void Update(const InstanceData* instances, GLsizei count);
+	void Update(const std::vector<InstanceData>& instances) { Update(instances.data(), (GLsizei)instances.size()); }
+
+	// Number of instances written by the last Update
+	GLsizei Count() const { return count; }
+
+	// Binds the buffer
+	void Bind();
+
+	// Unbinds the buffer
+	void Unbind();
+
+	// Deletes the buffer
+	void Delete();
+
+private:
+	GLsizei capacity;
+	GLsizei count = 0;
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Shared result of failed lookups
+static const JsonValue nullValue;
+
+// Member of an object (null when absent)
+const JsonValue& JsonValue::operator[](const char* key) const {
+	if (type == Type::Object) {
+		for (const std::pair<std::string, JsonValue>& member : object) {
+			if (member.first == key) {
+				return member.second;
+			}
+		}
+	}
+	return nullValue;
+}
+
+// Element of an array (null when out of range)
+const JsonValue& JsonValue::operator[](size_t index) const {
+	return type == Type::Array && index < array.size() ? array[index] : nullValue;
+}
+
+// Recursive descent parser over a bounded buffer
+class JsonParser {
+public:
+	JsonParser(const char* text, size_t length) : p(text), start(text), end(text + length) {}
+
+	bool Parse(JsonValue& value) {
+		if (!parseValue(value, 0)) {
+			return false;
+		}
+		skipSpaces();
+		return p == end || fail("trailing characters");
+	}
+
+private:
+	// Deeper documents are rejected rather than risking the stack
+	static const int MAX_DEPTH = 256;
+
+	const char* p;
+	const char* start;
+	const char* end;
+
+	bool fail(const char* message) {
+		std::cerr << "JSON error at byte " << (p - start) << ": " << message << std::endl;
+		return false;
+	}
+
+	void skipSpaces() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+			p++;
+		}
+	}
+
+	bool literal(const char* word) {
+		size_t length = std::strlen(word);
+		if ((size_t)(end - p) < length || std::memcmp(p, word, length) != 0) {
+			return fail("unexpected token");
+		}
+		p += length;
+		return true;
+	}
+
+	bool parseValue(JsonValue& value, int depth) {
+		skipSpaces();
+		if (p == end) {
+			return fail("unexpected end");
+		}
+		if (depth > MAX_DEPTH) {
+			return fail("nested too deeply");
+		}
+		switch (*p) {
+		case '{': return parseObject(value, depth);
+		case '[': return parseArray(value, depth);
+		case '"':
+			value.type = JsonValue::Type::String;
+			return parseString(value.string);
+		case 't':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = true;
+			return literal("true");
+		case 'f':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = false;
+			return literal("false");
+		case 'n':
+			value.type = JsonValue::Type::Null;
+			return literal("null");
+		default:
+			return parseNumber(value);
+		}
+	}
+
+	bool parseNumber(JsonValue& value) {
+		// strtod needs a terminated string; numbers are short
+		char buffer[64];
+		size_t length = 0;
+		while (p + length < end && length < sizeof(buffer) - 1 && std::strchr("+-0123456789.eE", p[length])) {
+			length++;
+		}
+		std::memcpy(buffer, p, length);
+		buffer[length] = '\0';
+		char* parsed;
+		value.number = std::strtod(buffer, &parsed);
+		if (length == 0 || parsed != buffer + length) {
+			return fail("invalid number");
+		}
+		value.type = JsonValue::Type::Number;
+		p += length;
+		return true;
+	}
+
+	bool parseString(std::string& out) {
+		p++;
+		while (p < end && *p != '"') {
+			if (*p != '\\') {
+				out += *p++;
+				continue;
+			}
+			if (++p == end) {
+				break;
+			}
+			char escape = *p++;
+			switch (escape) {
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u': {
+				if (end - p < 4) {
+					return fail("truncated \\u escape");
+				}
+				unsigned int code = (unsigned int)std::strtoul(std::string(p, 4).c_str(), nullptr, 16);
+				p += 4;
+				// UTF-8 encode (surrogate pairs are kept as two 3-byte sequences)
+				if (code < 0x80) {
+					out += (char)code;
+				}
+				else if (code < 0x800) {
+					out += (char)(0xC0 | (code >> 6));
+					out += (char)(0x80 | (code & 0x3F));
+				}
+				else {
+					out += (char)(0xE0 | (code >> 12));
+					out += (char)(0x80 | ((code >> 6) & 0x3F));
+					out += (char)(0x80 | (code & 0x3F));
+				}
+				break;
+			}
+			default: out += escape; break;
+			}
+		}
+		if (p == end) {
+			return fail("unterminated string");
+		}
+		p++;
+		return true;
+	}
+
+	bool parseArray(JsonValue& value, int depth) {
+		value.type = JsonValue::Type::Array;
+		p++;
+		skipSpaces();
+		if (p < end && *p == ']') {
+			p++;
+			return true;
+		}
+		while (true) {
+			value.array.emplace_back();
+			if (!parseValue(value.array.back(), depth + 1)) {
+				return false;
+			}
+			skipSpaces();
+			if (p < end && *p == ',') {
+				p++;
+			}
+			else if (p < end && *p == ']') {
+				p++;
+				return true;
+			}
+			else {
+				return fail("expected , or ]");
+			}
+		}
+	}
+
+	bool parseObject(JsonValue& value, int depth) {
+		value.type = JsonValue::Type::Object;
+		p++;
+		skipSpaces();
+		if (p < end && *p == '}') {
+			p++;
+			return true;
+		}
+		while (true) {
+			skipSpaces();
+			if (p == end || *p != '"') {
+				return fail("expected member name");
+			}
+			value.object.emplace_back();
+			if (!parseString(value.object.back().first)) {
+				return false;
+			}
+			skipSpaces();
+			if (p == end || *p != ':') {
+				return fail("expected :");
+			}
+			p++;
+			if (!parseValue(value.object.back().second, depth + 1)) {
+				return false;
+			}
+			skipSpaces();
+			if (p < end && *p == ',') {
+				p++;
+			}
+			else if (p < end && *p == '}') {
+				p++;
+				return true;
+			}
+			else {
+				return fail("expected , or }");
+			}
+		}
+	}
+};
+
+// Parses JSON text
+bool ParseJson(const char* text, size_t length, JsonValue& value) {
+	value = JsonValue();
+	JsonParser parser(text, length);
+	return parser.Parse(value);
+}
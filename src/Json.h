@@ -0,0 +1,44 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Parsed JSON document node, just enough for asset metadata such as glTF headers. Lookups of
+// missing members or out-of-range elements return a null value instead of failing, so optional
+// fields read as value["key"].Int(default)
+class JsonValue {
+public:
+	enum class Type { Null, Bool, Number, String, Array, Object };
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	// Member of an object (null when absent)
+	const JsonValue& operator[](const char* key) const;
+
+	// Element of an array (null when out of range)
+	const JsonValue& operator[](size_t index) const;
+
+	// Number of array elements or object members
+	size_t Size() const { return type == Type::Array ? array.size() : type == Type::Object ? object.size() : 0; }
+
+	bool IsNull() const { return type == Type::Null; }
+
+	// Typed reads with a fallback for nodes of another type
+	double Number(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+	int Int(int fallback = 0) const { return type == Type::Number ? (int)number : fallback; }
+	bool Bool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+	const std::string& String() const { return string; }
+};
+
+// Parses JSON text; prints the byte offset and returns false on syntax errors
+bool ParseJson(const char* text, size_t length, JsonValue& value);
+
+#endif
@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+// Maps a file
+bool MappedFile::Open(const char* path) {
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cerr << "Failed to open " << path << std::endl;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	fileHandle = file;
+	size = (size_t)fileSize.QuadPart;
+	if (size == 0) {
+		return true;
+	}
+	mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	data = mappingHandle ? (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		std::cerr << "Failed to open " << path << std::endl;
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0) {
+		close(file);
+		std::cerr << "Failed to stat " << path << std::endl;
+		return false;
+	}
+	size = (size_t)info.st_size;
+	if (size == 0) {
+		close(file);
+		return true;
+	}
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps its own reference to the file
+	close(file);
+	data = mapping == MAP_FAILED ? nullptr : (const unsigned char*)mapping;
+#endif
+	if (!data) {
+		std::cerr << "Failed to map " << path << std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// Unmaps the file
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle) {
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (data) {
+		munmap((void*)data, size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+// Hints that the whole file will be read front to back soon
+void MappedFile::PrefetchSequential() {
+#ifndef _WIN32
+	if (data) {
+		madvise((void*)data, size, MADV_SEQUENTIAL);
+		madvise((void*)data, size, MADV_WILLNEED);
+	}
+#endif
+}
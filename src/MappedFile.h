@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_CLASS_H
+#define MAPPED_FILE_CLASS_H
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file; pages are read from disk (or the page cache) on first
+// touch, so parsers can work on the bytes in place without copying them into a buffer first
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps a file; returns false (and prints why) when it can't be opened or mapped
+	bool Open(const char* path);
+
+	// Unmaps the file
+	void Close();
+
+	// Start and length of the mapping (null / 0 when nothing is mapped or the file is empty)
+	const unsigned char* Data() const { return data; }
+	size_t Size() const { return size; }
+
+	// Hints that the whole file will be read front to back soon
+	void PrefetchSequential();
+
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "MeshData.h"
+#include "GlbFile.h"
+#include "ObjFile.h"
+
+#include <cstring>
+#include <iostream>
+
+// Loads a mesh, picking the importer from the file extension
+bool LoadMesh(const char* path, MeshData& mesh, ThreadPool* pool) {
+	const char* extension = std::strrchr(path, '.');
+	if (extension && (std::strcmp(extension, ".obj") == 0 || std::strcmp(extension, ".OBJ") == 0)) {
+		return LoadObj(path, mesh, pool);
+	}
+	if (extension && (std::strcmp(extension, ".glb") == 0 || std::strcmp(extension, ".GLB") == 0)) {
+		return LoadGlb(path, mesh);
+	}
+	std::cerr << "Unsupported mesh format: " << path << std::endl;
+	return false;
+}
+
+// Replaces the normals of the vertices referenced from firstIndex on with area-weighted face normals
+void GenerateNormals(MeshData& mesh, size_t firstIndex) {
+	std::vector<bool> touched(mesh.vertices.size(), false);
+	for (size_t i = firstIndex; i < mesh.indices.size(); i++) {
+		if (!touched[mesh.indices[i]]) {
+			touched[mesh.indices[i]] = true;
+			mesh.vertices[mesh.indices[i]].normal = glm::vec3(0.0f);
+		}
+	}
+	for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3) {
+		MeshVertex& a = mesh.vertices[mesh.indices[i]];
+		MeshVertex& b = mesh.vertices[mesh.indices[i + 1]];
+		MeshVertex& c = mesh.vertices[mesh.indices[i + 2]];
+		glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+		a.normal += normal;
+		b.normal += normal;
+		c.normal += normal;
+	}
+	for (size_t v = 0; v < mesh.vertices.size(); v++) {
+		if (touched[v]) {
+			float length = glm::length(mesh.vertices[v].normal);
+			mesh.vertices[v].normal = length > 0.0f ? mesh.vertices[v].normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+	}
+}
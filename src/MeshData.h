@@ -0,0 +1,39 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "VertexLayout.h"
+
+class ThreadPool;
+
+// Full-precision mesh vertex (48 bytes), what importers produce and the layout read by mesh.vert
+struct MeshVertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec4 color;
+	glm::vec2 uv;
+
+	static constexpr std::array<VertexAttribute, 4> Attributes() {
+		return { { VERTEX_ATTRIBUTE(0, MeshVertex, position),
+				   VERTEX_ATTRIBUTE(1, MeshVertex, color),
+				   VERTEX_ATTRIBUTE(2, MeshVertex, uv),
+				   VERTEX_ATTRIBUTE(7, MeshVertex, normal) } };
+	}
+};
+
+// An indexed triangle list on the CPU, as loaded from a source file and handed to the cook stages
+struct MeshData {
+	std::vector<MeshVertex> vertices;
+	std::vector<GLuint> indices;
+};
+
+// Loads a .obj (parsed on the pool's threads when given) or .glb, picking the importer from the extension
+bool LoadMesh(const char* path, MeshData& mesh, ThreadPool* pool = nullptr);
+
+// Replaces the normals of the vertices referenced from firstIndex on with area-weighted face normals
+void GenerateNormals(MeshData& mesh, size_t firstIndex = 0);
+
+#endif
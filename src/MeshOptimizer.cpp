@@ -0,0 +1,426 @@
+#include "MeshOptimizer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// Size of the cache the vertex cache optimizer models (larger than the one AnalyzeVertexCache
+// simulates, so the order also suits hardware with bigger caches)
+static const int FORSYTH_CACHE_SIZE = 32;
+
+// Forsyth's "Linear-Speed Vertex Cache Optimisation" weights
+static const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+static const unsigned int FORSYTH_MAX_VALENCE = 64;
+
+// Score tables, filled once
+struct ForsythTables {
+	float cache[FORSYTH_CACHE_SIZE];
+	float valence[FORSYTH_MAX_VALENCE];
+
+	ForsythTables() {
+		for (int i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+			// The three vertices of the last triangle get a fixed score so the next triangle doesn't
+			// simply reuse its edge (which would favour long strips over compact fans)
+			cache[i] = i < 3 ? FORSYTH_LAST_TRIANGLE_SCORE
+				: std::pow(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+		}
+		valence[0] = 0.0f;
+		for (unsigned int i = 1; i < FORSYTH_MAX_VALENCE; i++) {
+			// Vertices with few triangles left are finished off first, so they can leave the cache
+			valence[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+		}
+	}
+};
+
+// Score of a vertex at cachePosition (-1 when not cached) still used by remaining triangles
+static float forsythScore(int cachePosition, unsigned int remaining) {
+	static const ForsythTables tables;
+	if (remaining == 0) {
+		return -1.0f;
+	}
+	float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+	return score + tables.valence[std::min(remaining, FORSYTH_MAX_VALENCE - 1)];
+}
+
+// Simulates a FIFO cache of cacheSize entries
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize) {
+	VertexCacheStats stats;
+	stats.triangles = (unsigned int)(indexCount / 3);
+
+	// A vertex is cached while fewer than cacheSize misses happened since it was loaded
+	std::vector<unsigned int> loadedAt(vertexCount, 0);
+	std::vector<bool> seen(vertexCount, false);
+	unsigned int time = cacheSize + 1;
+	for (size_t i = 0; i < indexCount; i++) {
+		GLuint v = indices[i];
+		if (!seen[v]) {
+			seen[v] = true;
+			stats.vertices++;
+		}
+		if (time - loadedAt[v] > cacheSize) {
+			loadedAt[v] = time++;
+			stats.misses++;
+		}
+	}
+	stats.acmr = stats.triangles ? (float)stats.misses / stats.triangles : 0.0f;
+	stats.atvr = stats.vertices ? (float)stats.misses / stats.vertices : 0.0f;
+	return stats;
+}
+
+// Writes indices reordered for the post-transform cache to destination
+void OptimizeVertexCache(GLuint* destination, const GLuint* indices, size_t indexCount, size_t vertexCount) {
+	PROFILE_ZONE("OptimizeVertexCache");
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+	// destination may alias indices
+	std::vector<GLuint> source(indices, indices + triangleCount * 3);
+
+	// Triangles around every vertex; the live ones are the first remaining[v] of each list
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (GLuint v : source) {
+		remaining[v]++;
+	}
+	std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) {
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+	}
+	std::vector<unsigned int> adjacency(source.size());
+	std::vector<unsigned int> filled(vertexCount, 0);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int k = 0; k < 3; k++) {
+			GLuint v = source[t * 3 + k];
+			adjacency[adjacencyOffset[v] + filled[v]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		vertexScore[v] = forsythScore(-1, remaining[v]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	size_t best = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScore[t] = vertexScore[source[t * 3]] + vertexScore[source[t * 3 + 1]] + vertexScore[source[t * 3 + 2]];
+		if (triangleScore[t] > triangleScore[best]) {
+			best = t;
+		}
+	}
+
+	std::vector<GLuint> cache, newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+	size_t nextUnemitted = 0;
+	for (size_t output = 0; output < triangleCount; output++) {
+		// Nothing in the cache touches a live triangle: continue with the next one in input order
+		if (best == (size_t)-1) {
+			while (emitted[nextUnemitted]) {
+				nextUnemitted++;
+			}
+			best = nextUnemitted;
+		}
+
+		const GLuint* triangle = &source[best * 3];
+		std::memcpy(&destination[output * 3], triangle, 3 * sizeof(GLuint));
+		emitted[best] = true;
+
+		// Drop the triangle from its vertices' live lists
+		for (int k = 0; k < 3; k++) {
+			GLuint v = triangle[k];
+			unsigned int* list = &adjacency[adjacencyOffset[v]];
+			for (unsigned int i = 0; i < remaining[v]; i++) {
+				if (list[i] == best) {
+					std::swap(list[i], list[remaining[v] - 1]);
+					remaining[v]--;
+					break;
+				}
+			}
+		}
+
+		// The triangle's vertices move to the front of the cache, pushing older entries back
+		newCache.assign(triangle, triangle + 3);
+		for (GLuint v : cache) {
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+				newCache.push_back(v);
+			}
+		}
+
+		// Rescore every vertex whose position or valence changed and carry the difference to its live triangles
+		for (size_t i = 0; i < newCache.size(); i++) {
+			GLuint v = newCache[i];
+			cachePosition[v] = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+			float score = forsythScore(cachePosition[v], remaining[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			const unsigned int* list = &adjacency[adjacencyOffset[v]];
+			for (unsigned int j = 0; j < remaining[v]; j++) {
+				triangleScore[list[j]] += delta;
+			}
+		}
+		if (newCache.size() > (size_t)FORSYTH_CACHE_SIZE) {
+			newCache.resize(FORSYTH_CACHE_SIZE);
+		}
+		cache.swap(newCache);
+
+		// The next triangle is the best one using a cached vertex
+		best = (size_t)-1;
+		float bestScore = -1.0f;
+		for (GLuint v : cache) {
+			const unsigned int* list = &adjacency[adjacencyOffset[v]];
+			for (unsigned int j = 0; j < remaining[v]; j++) {
+				if (triangleScore[list[j]] > bestScore) {
+					bestScore = triangleScore[list[j]];
+					best = list[j];
+				}
+			}
+		}
+	}
+}
+
+// Reorders cache-optimized triangles in place so outward-facing clusters draw first
+unsigned int OptimizeOverdraw(GLuint* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, float threshold) {
+	PROFILE_ZONE("OptimizeOverdraw");
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return 0;
+	}
+	const unsigned int cacheSize = 16;
+
+	// FIFO cache simulation that can be emptied by jumping the clock past every entry
+	std::vector<unsigned int> loadedAt(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	auto triangleMisses = [&](size_t t) {
+		unsigned int misses = 0;
+		for (int k = 0; k < 3; k++) {
+			GLuint v = indices[t * 3 + k];
+			if (time - loadedAt[v] > cacheSize) {
+				loadedAt[v] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	};
+	auto flushCache = [&]() { time += cacheSize + 1; };
+
+	// Hard boundaries: triangles that miss on all three vertices start over with a cold cache anyway,
+	// so the order can be broken there for free
+	std::vector<size_t> hardStarts;
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (triangleMisses(t) == 3 || t == 0) {
+			hardStarts.push_back(t);
+		}
+	}
+	hardStarts.push_back(triangleCount);
+
+	// Soft boundaries: each hard cluster is cut as soon as the part before the cut has an ACMR within
+	// threshold of the whole cluster's, so cutting there costs at most that much cache efficiency
+	std::vector<size_t> starts;
+	for (size_t h = 0; h + 1 < hardStarts.size(); h++) {
+		size_t begin = hardStarts[h], end = hardStarts[h + 1];
+		flushCache();
+		unsigned int clusterMisses = 0;
+		for (size_t t = begin; t < end; t++) {
+			clusterMisses += triangleMisses(t);
+		}
+		float target = (float)clusterMisses / (end - begin) * threshold;
+
+		flushCache();
+		starts.push_back(begin);
+		size_t start = begin;
+		unsigned int misses = 0;
+		for (size_t t = begin; t < end; t++) {
+			misses += triangleMisses(t);
+			if (t + 1 < end && (float)misses / (t + 1 - start) <= target) {
+				starts.push_back(t + 1);
+				start = t + 1;
+				misses = 0;
+				flushCache();
+			}
+		}
+	}
+	starts.push_back(triangleCount);
+	size_t clusterCount = starts.size() - 1;
+
+	auto position = [&](GLuint v) {
+		const float* p = (const float*)((const char*)positions + v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	// Area-weighted centroid and summed normal of every cluster
+	std::vector<glm::vec3> centroids(clusterCount), normals(clusterCount);
+	std::vector<float> areas(clusterCount);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusterCount; c++) {
+		glm::vec3 centroid(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t t = starts[c]; t < starts[c + 1]; t++) {
+			glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), c3 = position(indices[t * 3 + 2]);
+			glm::vec3 cross = glm::cross(b - a, c3 - a);
+			float triangleArea = glm::length(cross);
+			centroid += (a + b + c3) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+		centroids[c] = area > 0.0f ? centroid / area : position(indices[starts[c] * 3]);
+		normals[c] = normal;
+		areas[c] = area;
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) {
+		meshCentroid /= meshArea;
+	}
+
+	// Clusters facing away from the middle of the mesh, and far out along their normal, tend to
+	// occlude the rest from any viewpoint, so they go first
+	std::vector<float> keys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) {
+		float length = glm::length(normals[c]);
+		keys[c] = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+	}
+	std::vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) {
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+	std::vector<GLuint> sorted;
+	sorted.reserve(triangleCount * 3);
+	for (size_t c : order) {
+		sorted.insert(sorted.end(), indices + starts[c] * 3, indices + starts[c + 1] * 3);
+	}
+	std::memcpy(indices, sorted.data(), sorted.size() * sizeof(GLuint));
+	return (unsigned int)clusterCount;
+}
+
+// Reorders vertices by first use and remaps indices in place
+size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount) {
+	PROFILE_ZONE("OptimizeVertexFetch");
+	const GLuint UNUSED = 0xFFFFFFFFu;
+	std::vector<GLuint> remap(vertexCount, UNUSED);
+	GLuint next = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		GLuint& target = remap[indices[i]];
+		if (target == UNUSED) {
+			target = next++;
+		}
+		indices[i] = target;
+	}
+
+	std::vector<unsigned char> reordered((size_t)next * vertexSize);
+	const unsigned char* source = (const unsigned char*)vertices;
+	for (size_t v = 0; v < vertexCount; v++) {
+		if (remap[v] != UNUSED) {
+			std::memcpy(&reordered[remap[v] * vertexSize], source + v * vertexSize, vertexSize);
+		}
+	}
+	std::memcpy(vertices, reordered.data(), reordered.size());
+	return next;
+}
+
+// Computes the bounding sphere of a finished meshlet (centered on its bounding box)
+static void meshletBounds(Meshlet& meshlet, const uint32_t* vertices, const float* positions, size_t positionStride) {
+	const unsigned char* base = (const unsigned char*)positions;
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float* p = (const float*)(base + vertices[i] * positionStride);
+		boundsMin = glm::min(boundsMin, glm::vec3(p[0], p[1], p[2]));
+		boundsMax = glm::max(boundsMax, glm::vec3(p[0], p[1], p[2]));
+	}
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	float radius = 0.0f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float* p = (const float*)(base + vertices[i] * positionStride);
+		radius = std::max(radius, glm::length(glm::vec3(p[0], p[1], p[2]) - center));
+	}
+	meshlet.center[0] = center.x;
+	meshlet.center[1] = center.y;
+	meshlet.center[2] = center.z;
+	meshlet.radius = radius;
+}
+
+// Splits an index list into meshlets, walking triangles in order
+MeshletData BuildMeshlets(const GLuint* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+	size_t maxVertices, size_t maxTriangles) {
+	PROFILE_ZONE("BuildMeshlets");
+	maxVertices = std::min<size_t>(std::max<size_t>(maxVertices, 3), 255);
+	maxTriangles = std::max<size_t>(maxTriangles, 1);
+
+	MeshletData data;
+	// Local number of each vertex in the meshlet being filled (0xFF when it isn't in it)
+	std::vector<uint8_t> local(vertexCount, 0xFF);
+	Meshlet current = {};
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		const GLuint* triangle = indices + i;
+		unsigned int added = 0;
+		for (int corner = 0; corner < 3; corner++) {
+			added += local[triangle[corner]] == 0xFF && (corner < 1 || triangle[corner] != triangle[0]) && (corner < 2 || triangle[corner] != triangle[1]);
+		}
+		// Close the meshlet when the triangle doesn't fit
+		if (current.vertexCount + added > maxVertices || current.triangleCount + 1 > maxTriangles) {
+			meshletBounds(current, &data.vertices[current.vertexOffset], positions, positionStride);
+			for (uint32_t v = 0; v < current.vertexCount; v++) {
+				local[data.vertices[current.vertexOffset + v]] = 0xFF;
+			}
+			data.meshlets.push_back(current);
+			current = {};
+			current.vertexOffset = (uint32_t)data.vertices.size();
+			current.triangleOffset = (uint32_t)data.triangles.size();
+		}
+		for (int corner = 0; corner < 3; corner++) {
+			uint8_t& slot = local[triangle[corner]];
+			if (slot == 0xFF) {
+				slot = (uint8_t)current.vertexCount++;
+				data.vertices.push_back(triangle[corner]);
+			}
+			data.triangles.push_back(slot);
+		}
+		current.triangleCount++;
+	}
+	if (current.triangleCount > 0) {
+		meshletBounds(current, &data.vertices[current.vertexOffset], positions, positionStride);
+		data.meshlets.push_back(current);
+	}
+	return data;
+}
+
+// Runs all three stages on a mesh
+MeshOptimizationReport OptimizeMesh(MeshData& mesh, float overdrawThreshold) {
+	PROFILE_ZONE("OptimizeMesh");
+	MeshOptimizationReport report;
+	size_t vertexCount = mesh.vertices.size();
+	report.before = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+
+	OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(), vertexCount);
+	if (!mesh.vertices.empty()) {
+		report.clusters = OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position.x, vertexCount, sizeof(MeshVertex), overdrawThreshold);
+	}
+	size_t used = OptimizeVertexFetch(mesh.vertices.data(), vertexCount, sizeof(MeshVertex), mesh.indices.data(), mesh.indices.size());
+	mesh.vertices.resize(used);
+	report.unreferencedVertices = vertexCount - used;
+
+	report.after = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), used);
+	return report;
+}
+
+// Prints the before / after figures
+void PrintMeshOptimizationReport(std::ostream& out, const char* name, const MeshOptimizationReport& report) {
+	out << "Mesh optimization: " << name << " (" << report.after.triangles << " triangles, " << report.after.vertices << " vertices, "
+		<< report.clusters << " overdraw clusters";
+	if (report.unreferencedVertices) {
+		out << ", " << report.unreferencedVertices << " unreferenced vertices dropped";
+	}
+	out << ")" << std::endl;
+	out << "  ACMR  " << report.before.acmr << " -> " << report.after.acmr << std::endl;
+	out << "  ATVR  " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+}
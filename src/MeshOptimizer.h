@@ -0,0 +1,86 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "MeshData.h"
+
+// Offline index and vertex reordering for indexed triangle lists, run when meshes are imported or
+// cooked. OptimizeMesh() chains the three stages in the order they have to happen:
+//   1. OptimizeVertexCache  reorders triangles so recently transformed vertices are reused (Forsyth)
+//   2. OptimizeOverdraw     splits that order into clusters and sorts them outside-in, keeping the
+//                           cache efficiency within a threshold
+//   3. OptimizeVertexFetch  renumbers vertices in first-use order so fetches walk memory forward
+
+// How well an index order uses a FIFO post-transform cache of cacheSize vertices
+struct VertexCacheStats {
+	unsigned int triangles = 0;
+	unsigned int vertices = 0;  // distinct vertices referenced
+	unsigned int misses = 0;    // vertex shader invocations
+	float acmr = 0.0f;          // average cache miss ratio: misses per triangle (0.5 is ideal for large grids, 3 is worst)
+	float atvr = 0.0f;          // average transform to vertex ratio: misses per vertex (1 is ideal)
+};
+
+// Before and after figures of OptimizeMesh()
+struct MeshOptimizationReport {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	unsigned int clusters = 0;         // overdraw clusters the triangles were sorted in
+	size_t unreferencedVertices = 0;   // dropped by the fetch stage
+};
+
+// Simulates a FIFO cache of cacheSize entries (16 matches common hardware)
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+
+// Writes indices reordered for the post-transform cache to destination (may alias indices)
+void OptimizeVertexCache(GLuint* destination, const GLuint* indices, size_t indexCount, size_t vertexCount);
+
+// Reorders cache-optimized triangles in place so outward-facing clusters draw first; the ACMR of
+// each cluster may grow to threshold times that of the input. Positions are three floats at the
+// start of every positionStride bytes. Returns the number of clusters
+unsigned int OptimizeOverdraw(GLuint* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, float threshold = 1.05f);
+
+// Reorders vertices (vertexSize bytes each) by first use and remaps indices in place; vertices no
+// index refers to are dropped. Returns the new vertex count
+size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount);
+
+// Small cluster of triangles with its own local vertex list, the unit of cluster culling. Vertices
+// index MeshletData::vertices, triangles are three bytes each (local vertex numbers) in
+// MeshletData::triangles; the sphere bounds every vertex of the meshlet
+struct Meshlet {
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;  // in bytes
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	float center[3];
+	float radius;
+};
+
+// Meshlets of a mesh and the arrays they point into
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> vertices;
+	std::vector<uint8_t> triangles;
+};
+
+// Meshlet limits (64 vertices / 124 triangles keep a meshlet's data within common mesh shader budgets)
+static const size_t MESHLET_MAX_VERTICES = 64;
+static const size_t MESHLET_MAX_TRIANGLES = 124;
+
+// Splits an index list into meshlets, walking triangles in order (so run it on cache-optimized
+// indices, whose neighbouring triangles already share vertices). Positions are laid out as for
+// OptimizeOverdraw
+MeshletData BuildMeshlets(const GLuint* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+	size_t maxVertices = MESHLET_MAX_VERTICES, size_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+// Runs all three stages on a mesh
+MeshOptimizationReport OptimizeMesh(MeshData& mesh, float overdrawThreshold = 1.05f);
+
+// Prints the before / after figures
+void PrintMeshOptimizationReport(std::ostream& out, const char* name, const MeshOptimizationReport& report);
+
+#endif
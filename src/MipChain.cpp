@@ -0,0 +1,40 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Builds the mip chain of an RGBA8 image down to 1x1 using a 2x2 box filter
+MipChain BuildMipChain(const unsigned char* rgba, int width, int height) {
+	MipChain chain;
+
+	size_t total = 0;
+	for (int w = width, h = height;; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) {
+		chain.levels.push_back({ w, h, total });
+		total += (size_t)w * h * 4;
+		if (w == 1 && h == 1) {
+			break;
+		}
+	}
+	chain.pixels.resize(total);
+	std::memcpy(chain.pixels.data(), rgba, (size_t)width * height * 4);
+
+	// Each level averages 2x2 texels of the previous one (edges are clamped for odd sizes)
+	for (size_t l = 1; l < chain.levels.size(); l++) {
+		const MipChain::Level& src = chain.levels[l - 1];
+		const MipChain::Level& dst = chain.levels[l];
+		const unsigned char* in = chain.pixels.data() + src.offset;
+		unsigned char* out = chain.pixels.data() + dst.offset;
+		for (int y = 0; y < dst.height; y++) {
+			int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+			for (int x = 0; x < dst.width; x++) {
+				int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+				for (int c = 0; c < 4; c++) {
+					int sum = in[(y0 * src.width + x0) * 4 + c] + in[(y0 * src.width + x1) * 4 + c] +
+						in[(y1 * src.width + x0) * 4 + c] + in[(y1 * src.width + x1) * 4 + c];
+					out[(y * dst.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+	return chain;
+}
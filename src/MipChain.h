@@ -0,0 +1,22 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <cstddef>
+#include <vector>
+
+// RGBA8 image with its full mip chain stored back to back (level 0 first)
+struct MipChain {
+	struct Level {
+		int width;
+		int height;
+		size_t offset;
+	};
+
+	std::vector<unsigned char> pixels;
+	std::vector<Level> levels;
+};
+
+// Builds the mip chain of an RGBA8 image down to 1x1 using a 2x2 box filter
+MipChain BuildMipChain(const unsigned char* rgba, int width, int height);
+
+#endif
@@ -0,0 +1,425 @@
+#include "ObjFile.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+// Position, UV and normal index of a face corner (1-based, 0 = absent)
+struct ObjCorner {
+	int32_t position, uv, normal;
+
+	bool operator==(const ObjCorner& other) const {
+		return position == other.position && uv == other.uv && normal == other.normal;
+	}
+};
+
+// Negative (relative) indices can only be resolved once the chunks before are counted, so the
+// parser stores them as RELATIVE_INDEX + the index within the chunk. Absolute indices stay below
+// RELATIVE_INDEX / 2, which leaves room for relative ones pointing up to 2^29 elements back
+static const int32_t RELATIVE_INDEX = 1 << 30;
+
+// Open-addressing table assigning every distinct corner a dense id in first-insertion order
+class CornerTable {
+public:
+	std::vector<ObjCorner> corners;
+
+	// Constructor that sizes the table for up to capacity distinct corners
+	CornerTable(size_t capacity) {
+		size_t size = 16;
+		while (size < capacity * 2) {
+			size *= 2;
+		}
+		slots.assign(size, EMPTY);
+		mask = size - 1;
+		corners.reserve(capacity);
+	}
+
+	// Returns the id of a corner, adding it if it's new
+	uint32_t Insert(const ObjCorner& corner) {
+		uint32_t hash = (uint32_t)corner.position * 0x9E3779B1u ^ (uint32_t)corner.uv * 0x85EBCA77u ^ (uint32_t)corner.normal * 0xC2B2AE3Du;
+		hash ^= hash >> 15;
+		for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+			uint32_t id = slots[slot];
+			if (id == EMPTY) {
+				slots[slot] = (uint32_t)corners.size();
+				corners.push_back(corner);
+				return slots[slot];
+			}
+			if (corners[id] == corner) {
+				return id;
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+	std::vector<uint32_t> slots;
+	size_t mask;
+};
+
+// One line-aligned slice of the file and everything parsed from it
+struct ObjChunk {
+	const char* begin;
+	const char* end;
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<ObjCorner> corners;  // three per triangle
+
+	// Counts of the chunks before this one
+	size_t positionBase = 0, uvBase = 0, normalBase = 0, indexBase = 0;
+
+	// Distinct corners of this chunk, the chunk's indices into them and their ids in the whole mesh
+	std::vector<ObjCorner> unique;
+	std::vector<uint32_t> localIndices;
+	std::vector<GLuint> remap;
+
+	std::string error;
+};
+
+static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline const char* skipSpaces(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		p++;
+	}
+	return p;
+}
+
+static inline const char* nextLine(const char* p, const char* end) {
+	while (p < end && *p != '\n') {
+		p++;
+	}
+	return p < end ? p + 1 : end;
+}
+
+// Parses a decimal float without locale lookups or per-digit rounding (strtof is several times
+// slower); up to 19 significant digits are kept, which is exact for anything an exporter writes
+static const char* parseFloat(const char* p, const char* end, float& value) {
+	p = skipSpaces(p, end);
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool any = false;
+	for (; p < end && isDigit(*p); p++, any = true) {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+			digits += mantissa != 0;
+		}
+		else {
+			exponent++;
+		}
+	}
+	if (p < end && *p == '.') {
+		for (p++; p < end && isDigit(*p); p++, any = true) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				digits += mantissa != 0;
+				exponent--;
+			}
+		}
+	}
+	if (!any) {
+		// nan, inf and other oddities
+		std::string token(start, std::min<size_t>(end - start, 64));
+		char* parsed;
+		value = std::strtof(token.c_str(), &parsed);
+		return start + std::max<ptrdiff_t>(parsed - token.c_str(), 1);
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool negativeExponent = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negativeExponent = *p == '-';
+			p++;
+		}
+		int e = 0;
+		for (; p < end && isDigit(*p); p++) {
+			e = std::min(e * 10 + (*p - '0'), 10000);
+		}
+		exponent += negativeExponent ? -e : e;
+	}
+
+	double result = (double)mantissa;
+	if (exponent < 0) {
+		result = -exponent <= 22 ? result / POWERS_OF_TEN[-exponent] : result * std::pow(10.0, exponent);
+	}
+	else if (exponent > 0) {
+		result = exponent <= 22 ? result * POWERS_OF_TEN[exponent] : result * std::pow(10.0, exponent);
+	}
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+// Parses a face index, turning negative ones into RELATIVE_INDEX-based ones (see above); count is
+// the number of elements of that kind parsed so far in this chunk
+static inline const char* parseIndex(const char* p, const char* end, size_t count, int32_t& index) {
+	bool negative = p < end && *p == '-';
+	if (negative) {
+		p++;
+	}
+	int32_t value = 0;
+	for (; p < end && isDigit(*p); p++) {
+		value = value * 10 + (*p - '0');
+	}
+	index = negative ? RELATIVE_INDEX + (int32_t)count - value + 1 : value;
+	return p;
+}
+
+// Parses the lines of one chunk
+static void parseChunk(ObjChunk& chunk) {
+	std::vector<ObjCorner> face;
+	const char* end = chunk.end;
+	for (const char* line = chunk.begin; line < end; line = nextLine(line, end)) {
+		const char* p = skipSpaces(line, end);
+		if (p + 1 >= end) {
+			continue;
+		}
+		if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+			glm::vec3 position;
+			p = parseFloat(p + 2, end, position.x);
+			p = parseFloat(p, end, position.y);
+			parseFloat(p, end, position.z);
+			chunk.positions.push_back(position);
+		}
+		else if (p[0] == 'v' && p[1] == 't') {
+			glm::vec2 uv;
+			p = parseFloat(p + 2, end, uv.x);
+			parseFloat(p, end, uv.y);
+			chunk.uvs.push_back(uv);
+		}
+		else if (p[0] == 'v' && p[1] == 'n') {
+			glm::vec3 normal;
+			p = parseFloat(p + 2, end, normal.x);
+			p = parseFloat(p, end, normal.y);
+			parseFloat(p, end, normal.z);
+			chunk.normals.push_back(normal);
+		}
+		else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+			face.clear();
+			p = skipSpaces(p + 2, end);
+			while (p < end && (isDigit(*p) || *p == '-')) {
+				ObjCorner corner = { 0, 0, 0 };
+				p = parseIndex(p, end, chunk.positions.size(), corner.position);
+				if (p < end && *p == '/') {
+					p++;
+					if (p < end && *p != '/') {
+						p = parseIndex(p, end, chunk.uvs.size(), corner.uv);
+					}
+					if (p < end && *p == '/') {
+						p = parseIndex(p + 1, end, chunk.normals.size(), corner.normal);
+					}
+				}
+				face.push_back(corner);
+				p = skipSpaces(p, end);
+			}
+			if (p < end && *p != '\r' && *p != '\n' && *p != '#' && chunk.error.empty()) {
+				chunk.error = "malformed face \"" + std::string(line, nextLine(line, end) - line - 1) + "\"";
+			}
+			for (size_t i = 2; i < face.size(); i++) {
+				chunk.corners.push_back(face[0]);
+				chunk.corners.push_back(face[i - 1]);
+				chunk.corners.push_back(face[i]);
+			}
+		}
+	}
+}
+
+// Resolves a chunk's indices against the whole file and welds its corners locally
+static void weldChunk(ObjChunk& chunk, size_t positionCount, size_t uvCount, size_t normalCount) {
+	auto resolve = [](int32_t& index, size_t base, size_t count) {
+		if (index > RELATIVE_INDEX / 2) {
+			index = index - RELATIVE_INDEX + (int32_t)base;
+		}
+		return index >= 0 && (size_t)index <= count;
+	};
+
+	CornerTable table(chunk.corners.size());
+	chunk.localIndices.resize(chunk.corners.size());
+	for (size_t i = 0; i < chunk.corners.size(); i++) {
+		ObjCorner corner = chunk.corners[i];
+		bool valid = resolve(corner.position, chunk.positionBase, positionCount) && corner.position != 0;
+		valid = resolve(corner.uv, chunk.uvBase, uvCount) && valid;
+		valid = resolve(corner.normal, chunk.normalBase, normalCount) && valid;
+		if (!valid) {
+			if (chunk.error.empty()) {
+				chunk.error = "face index out of range";
+			}
+			corner = { 1, 0, 0 };
+		}
+		chunk.localIndices[i] = table.Insert(corner);
+	}
+	chunk.unique.swap(table.corners);
+	std::vector<ObjCorner>().swap(chunk.corners);
+}
+
+// Reads the triangles of a Wavefront .obj
+bool LoadObj(const char* path, MeshData& mesh, ThreadPool* pool) {
+	PROFILE_ZONE("LoadObj");
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	file.PrefetchSequential();
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	const char* text = (const char*)file.Data();
+	size_t size = file.Size();
+
+	// A few chunks per thread (of at least 1 MiB) keeps the workers busy when line density varies
+	size_t chunkCount = 1;
+	if (pool) {
+		chunkCount = std::max<size_t>(1, std::min<size_t>(size >> 20, (size_t)(pool->Size() + 1) * 4));
+	}
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* cursor = text;
+	for (size_t c = 0; c < chunkCount; c++) {
+		const char* end = c + 1 == chunkCount ? text + size : std::max(cursor, text + size * (c + 1) / chunkCount);
+		while (end > text && end < text + size && end[-1] != '\n') {
+			end++;
+		}
+		chunks[c].begin = cursor;
+		chunks[c].end = end;
+		cursor = end;
+	}
+
+	auto forEachChunk = [&](const std::function<void(ObjChunk&)>& function) {
+		if (pool && chunkCount > 1) {
+			pool->ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+				for (size_t c = begin; c < end; c++) {
+					function(chunks[c]);
+				}
+			});
+		}
+		else {
+			for (ObjChunk& chunk : chunks) {
+				function(chunk);
+			}
+		}
+	};
+
+	{
+		PROFILE_ZONE("LoadObj parse");
+		forEachChunk(parseChunk);
+	}
+
+	size_t positionCount = 0, uvCount = 0, normalCount = 0, indexCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.positionBase = positionCount;
+		chunk.uvBase = uvCount;
+		chunk.normalBase = normalCount;
+		chunk.indexBase = indexCount;
+		positionCount += chunk.positions.size();
+		uvCount += chunk.uvs.size();
+		normalCount += chunk.normals.size();
+		indexCount += chunk.corners.size();
+	}
+
+	{
+		PROFILE_ZONE("LoadObj weld");
+		forEachChunk([&](ObjChunk& chunk) { weldChunk(chunk, positionCount, uvCount, normalCount); });
+	}
+	for (const ObjChunk& chunk : chunks) {
+		if (!chunk.error.empty()) {
+			std::cerr << path << ": " << chunk.error << std::endl;
+			return false;
+		}
+	}
+
+	// Corners shared across chunks are merged here; only each chunk's distinct corners go through
+	// this serial pass, not every index
+	size_t uniqueCount = 0;
+	for (const ObjChunk& chunk : chunks) {
+		uniqueCount += chunk.unique.size();
+	}
+	CornerTable global(uniqueCount);
+	for (ObjChunk& chunk : chunks) {
+		chunk.remap.resize(chunk.unique.size());
+		for (size_t i = 0; i < chunk.unique.size(); i++) {
+			chunk.remap[i] = global.Insert(chunk.unique[i]);
+		}
+	}
+
+	// Gathers the attribute arrays so vertices can be built from global indices
+	std::vector<glm::vec3> positions(positionCount), normals(normalCount);
+	std::vector<glm::vec2> uvs(uvCount);
+	mesh.indices.resize(indexCount);
+	forEachChunk([&](ObjChunk& chunk) {
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+		std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uvBase);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+		for (size_t i = 0; i < chunk.localIndices.size(); i++) {
+			mesh.indices[chunk.indexBase + i] = chunk.remap[chunk.localIndices[i]];
+		}
+	});
+
+	const std::vector<ObjCorner>& corners = global.corners;
+	mesh.vertices.resize(corners.size());
+	auto buildVertices = [&](size_t begin, size_t end) {
+		for (size_t v = begin; v < end; v++) {
+			const ObjCorner& corner = corners[v];
+			MeshVertex& vertex = mesh.vertices[v];
+			vertex.position = positions[corner.position - 1];
+			vertex.normal = corner.normal ? normals[corner.normal - 1] : glm::vec3(0.0f);
+			vertex.color = glm::vec4(1.0f);
+			vertex.uv = corner.uv ? uvs[corner.uv - 1] : glm::vec2(0.0f);
+		}
+	};
+	if (pool) {
+		pool->ParallelFor(corners.size(), 1 << 16, buildVertices);
+	}
+	else {
+		buildVertices(0, corners.size());
+	}
+
+	if (normalCount == 0) {
+		PROFILE_ZONE("LoadObj normals");
+		GenerateNormals(mesh);
+	}
+	return true;
+}
+
+// Writes a mesh as .obj
+bool WriteObj(const char* path, const MeshData& mesh) {
+	FILE* file = std::fopen(path, "w");
+	if (!file) {
+		std::cerr << "Failed to write " << path << std::endl;
+		return false;
+	}
+	for (const MeshVertex& vertex : mesh.vertices) {
+		std::fprintf(file, "v %.9g %.9g %.9g\n", vertex.position.x, vertex.position.y, vertex.position.z);
+	}
+	for (const MeshVertex& vertex : mesh.vertices) {
+		std::fprintf(file, "vt %.9g %.9g\n", vertex.uv.x, vertex.uv.y);
+	}
+	for (const MeshVertex& vertex : mesh.vertices) {
+		std::fprintf(file, "vn %.9g %.9g %.9g\n", vertex.normal.x, vertex.normal.y, vertex.normal.z);
+	}
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+		GLuint a = mesh.indices[i] + 1, b = mesh.indices[i + 1] + 1, c = mesh.indices[i + 2] + 1;
+		std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+	}
+	bool ok = std::ferror(file) == 0;
+	std::fclose(file);
+	return ok;
+}
@@ -0,0 +1,17 @@
+#ifndef OBJ_FILE_H
+#define OBJ_FILE_H
+
+#include "MeshData.h"
+
+class ThreadPool;
+
+// Reads the triangles of a Wavefront .obj (v / vt / vn / f; polygons are fanned). Corners that share
+// position, UV and normal indices are welded into one vertex; normals are generated when the file
+// has none. With a pool, the memory-mapped file is split into chunks at line boundaries that are
+// parsed and welded in parallel, then merged (vertices end up in first-use order either way)
+bool LoadObj(const char* path, MeshData& mesh, ThreadPool* pool = nullptr);
+
+// Writes a mesh as .obj, keeping the vertex and index order
+bool WriteObj(const char* path, const MeshData& mesh);
+
+#endif
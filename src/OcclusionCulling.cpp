@@ -0,0 +1,346 @@
+#include "OcclusionCulling.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE2 1
+#endif
+
+// Pixels per rasterization job, and per block of the hierarchical depth (both divide the tile)
+static const int OCCLUSION_TILE_WIDTH = 64;
+static const int OCCLUSION_TILE_HEIGHT = 32;
+static const int OCCLUSION_BLOCK_SIZE = 8;
+
+// Candidates per job when testing in parallel
+static const size_t OCCLUSION_TEST_GRAIN = 4096;
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Constructor that allocates a depth buffer of the given size (rounded up to multiples of 8)
+OcclusionBuffer::OcclusionBuffer(int width, int height) {
+	OcclusionBuffer::width = (std::max(width, 1) + OCCLUSION_BLOCK_SIZE - 1) / OCCLUSION_BLOCK_SIZE * OCCLUSION_BLOCK_SIZE;
+	OcclusionBuffer::height = (std::max(height, 1) + OCCLUSION_BLOCK_SIZE - 1) / OCCLUSION_BLOCK_SIZE * OCCLUSION_BLOCK_SIZE;
+	tilesX = (OcclusionBuffer::width + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH;
+	tilesY = (OcclusionBuffer::height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+	depth.assign((size_t)OcclusionBuffer::width * OcclusionBuffer::height, 1.0f);
+	blockMax.assign((size_t)(OcclusionBuffer::width / OCCLUSION_BLOCK_SIZE) * (OcclusionBuffer::height / OCCLUSION_BLOCK_SIZE), 1.0f);
+	tileTriangles.resize((size_t)tilesX * tilesY);
+}
+
+// Starts a frame: drops last frame's occluders and resets the stats
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection) {
+	OcclusionBuffer::viewProjection = viewProjection;
+	triangles.clear();
+	for (std::vector<uint32_t>& list : tileTriangles) {
+		list.clear();
+	}
+	stats = Stats();
+}
+
+// Adds the triangles of a mesh as an occluder. Positions are three floats at the start of every
+// positionStride bytes. Triangles crossing the near plane are skipped (which only loses occlusion);
+// both windings are drawn, so meshes needn't be closed or consistently wound
+void OcclusionBuffer::AddOccluder(const float* positions, size_t vertexCount, size_t positionStride, const GLuint* indices, size_t indexCount,
+	const glm::mat4& model) {
+	PROFILE_ZONE("OcclusionBuffer::AddOccluder");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	glm::mat4 transform = viewProjection * model;
+	clipScratch.resize(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		const float* position = (const float*)((const unsigned char*)positions + v * positionStride);
+		clipScratch[v] = transform * glm::vec4(position[0], position[1], position[2], 1.0f);
+	}
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		stats.occluderTriangles++;
+		if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) {
+			continue;
+		}
+
+		// Pixel coordinates (x right, y up) and depth in [0, 1]
+		glm::vec3 corners[3];
+		bool behind = false;
+		for (int c = 0; c < 3; c++) {
+			const glm::vec4& clip = clipScratch[indices[i + c]];
+			behind = behind || clip.w <= 0.0f || clip.z < -clip.w;
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			corners[c] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+		}
+		if (behind) {
+			continue;
+		}
+
+		float area = (corners[1].x - corners[0].x) * (corners[2].y - corners[0].y) - (corners[2].x - corners[0].x) * (corners[1].y - corners[0].y);
+		if (std::fabs(area) < 1e-6f) {
+			continue;
+		}
+		if (area < 0.0f) {
+			std::swap(corners[1], corners[2]);
+			area = -area;
+		}
+
+		Triangle triangle;
+		triangle.minX = std::max(0, (int)std::floor(std::min(std::min(corners[0].x, corners[1].x), corners[2].x)));
+		triangle.minY = std::max(0, (int)std::floor(std::min(std::min(corners[0].y, corners[1].y), corners[2].y)));
+		triangle.maxX = std::min(width - 1, (int)std::ceil(std::max(std::max(corners[0].x, corners[1].x), corners[2].x)));
+		triangle.maxY = std::min(height - 1, (int)std::ceil(std::max(std::max(corners[0].y, corners[1].y), corners[2].y)));
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+			continue;
+		}
+
+		// Edge i runs from corner i to the next one; with counterclockwise corners the inside is positive
+		for (int e = 0; e < 3; e++) {
+			const glm::vec3& p = corners[e];
+			const glm::vec3& q = corners[(e + 1) % 3];
+			triangle.edgeA[e] = p.y - q.y;
+			triangle.edgeB[e] = q.x - p.x;
+			triangle.edgeC[e] = p.x * q.y - p.y * q.x;
+		}
+		float dz1 = corners[1].z - corners[0].z, dz2 = corners[2].z - corners[0].z;
+		triangle.depthA = (dz1 * (corners[2].y - corners[0].y) - dz2 * (corners[1].y - corners[0].y)) / area;
+		triangle.depthB = (dz2 * (corners[1].x - corners[0].x) - dz1 * (corners[2].x - corners[0].x)) / area;
+		triangle.depthC = corners[0].z - triangle.depthA * corners[0].x - triangle.depthB * corners[0].y;
+
+		uint32_t index = (uint32_t)triangles.size();
+		triangles.push_back(triangle);
+		for (int ty = triangle.minY / OCCLUSION_TILE_HEIGHT; ty <= triangle.maxY / OCCLUSION_TILE_HEIGHT; ty++) {
+			for (int tx = triangle.minX / OCCLUSION_TILE_WIDTH; tx <= triangle.maxX / OCCLUSION_TILE_WIDTH; tx++) {
+				tileTriangles[(size_t)ty * tilesX + tx].push_back(index);
+			}
+		}
+		stats.rasterizedTriangles++;
+	}
+	stats.rasterizeMs += millisecondsSince(start);
+}
+
+// Clears and rasterizes one tile, then updates its blocks
+void OcclusionBuffer::rasterizeTile(int tile) {
+	int x0 = (tile % tilesX) * OCCLUSION_TILE_WIDTH, x1 = std::min(width, x0 + OCCLUSION_TILE_WIDTH);
+	int y0 = (tile / tilesX) * OCCLUSION_TILE_HEIGHT, y1 = std::min(height, y0 + OCCLUSION_TILE_HEIGHT);
+	for (int y = y0; y < y1; y++) {
+		std::fill(depth.begin() + (size_t)y * width + x0, depth.begin() + (size_t)y * width + x1, 1.0f);
+	}
+
+	for (uint32_t index : tileTriangles[tile]) {
+		const Triangle& triangle = triangles[index];
+		// Rows start on a multiple of 4 so every group of 4 pixels lies inside the tile
+		int minX = std::max(triangle.minX, x0) & ~3, maxX = std::min(triangle.maxX, x1 - 1);
+		int minY = std::max(triangle.minY, y0), maxY = std::min(triangle.maxY, y1 - 1);
+		for (int y = minY; y <= maxY; y++) {
+			float centerY = y + 0.5f;
+			float row0 = triangle.edgeB[0] * centerY + triangle.edgeC[0];
+			float row1 = triangle.edgeB[1] * centerY + triangle.edgeC[1];
+			float row2 = triangle.edgeB[2] * centerY + triangle.edgeC[2];
+			float rowDepth = triangle.depthB * centerY + triangle.depthC;
+			float* line = depth.data() + (size_t)y * width;
+#ifdef OCCLUSION_USE_SSE2
+			// Four pixel centers per step: covered where all three edge functions are non-negative
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 a0 = _mm_set1_ps(triangle.edgeA[0]), a1 = _mm_set1_ps(triangle.edgeA[1]), a2 = _mm_set1_ps(triangle.edgeA[2]);
+			const __m128 depthA = _mm_set1_ps(triangle.depthA);
+			const __m128 r0 = _mm_set1_ps(row0), r1 = _mm_set1_ps(row1), r2 = _mm_set1_ps(row2), rz = _mm_set1_ps(rowDepth);
+			for (int x = minX; x <= maxX; x += 4) {
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, centerX), r0), zero),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, centerX), r1), zero)),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, centerX), r2), zero));
+				if (_mm_movemask_ps(inside) == 0) {
+					continue;
+				}
+				__m128 current = _mm_loadu_ps(line + x);
+				__m128 nearer = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthA, centerX), rz));
+				_mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+			}
+#else
+			for (int x = minX; x <= maxX; x++) {
+				float centerX = x + 0.5f;
+				if (triangle.edgeA[0] * centerX + row0 >= 0.0f && triangle.edgeA[1] * centerX + row1 >= 0.0f && triangle.edgeA[2] * centerX + row2 >= 0.0f) {
+					line[x] = std::min(line[x], triangle.depthA * centerX + rowDepth);
+				}
+			}
+#endif
+		}
+	}
+
+	// Farthest depth of every block in the tile
+	int blocksX = width / OCCLUSION_BLOCK_SIZE;
+	for (int by = y0 / OCCLUSION_BLOCK_SIZE; by < y1 / OCCLUSION_BLOCK_SIZE; by++) {
+		for (int bx = x0 / OCCLUSION_BLOCK_SIZE; bx < x1 / OCCLUSION_BLOCK_SIZE; bx++) {
+			float farthest = 0.0f;
+			for (int y = by * OCCLUSION_BLOCK_SIZE; y < (by + 1) * OCCLUSION_BLOCK_SIZE; y++) {
+				const float* line = depth.data() + (size_t)y * width + bx * OCCLUSION_BLOCK_SIZE;
+				for (int x = 0; x < OCCLUSION_BLOCK_SIZE; x++) {
+					farthest = std::max(farthest, line[x]);
+				}
+			}
+			blockMax[(size_t)by * blocksX + bx] = farthest;
+		}
+	}
+}
+
+// Clears the depth buffer and rasterizes every occluder, one tile per job when given a pool
+void OcclusionBuffer::Rasterize(ThreadPool* pool) {
+	PROFILE_ZONE("OcclusionBuffer::Rasterize");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int tiles = tilesX * tilesY;
+	if (pool && pool->Size() > 0) {
+		pool->ParallelFor((size_t)tiles, 1, [this](size_t begin, size_t end) {
+			for (size_t tile = begin; tile < end; tile++) {
+				rasterizeTile((int)tile);
+			}
+		});
+	}
+	else {
+		for (int tile = 0; tile < tiles; tile++) {
+			rasterizeTile(tile);
+		}
+	}
+	stats.rasterizeMs += millisecondsSince(start);
+}
+
+// Returns false only if the box is certainly hidden behind the occluders. Boxes off screen or
+// crossing the near plane count as visible (frustum culling deals with those)
+bool OcclusionBuffer::IsVisible(const glm::vec3& min, const glm::vec3& max) const {
+	// Screen rectangle and nearest depth of the projected corners, which are the projected center
+	// plus or minus the matrix columns scaled by the half extents
+	glm::vec3 halfSize = (max - min) * 0.5f;
+	glm::vec4 center = viewProjection * glm::vec4((min + max) * 0.5f, 1.0f);
+	glm::vec4 axisX = viewProjection[0] * halfSize.x, axisY = viewProjection[1] * halfSize.y, axisZ = viewProjection[2] * halfSize.z;
+	glm::vec2 rectMin, rectMax;
+	float nearest;
+#ifdef OCCLUSION_USE_SSE2
+	// All eight corners at once: lanes are corners 0-3 (low z) and 4-7 (high z)
+	const __m128 signX = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f), signY = _mm_set_ps(1.0f, 1.0f, -1.0f, -1.0f);
+	__m128 clip[4][2];
+	for (int component = 0; component < 4; component++) {
+		__m128 side = _mm_add_ps(_mm_set1_ps(center[component]),
+			_mm_add_ps(_mm_mul_ps(signX, _mm_set1_ps(axisX[component])), _mm_mul_ps(signY, _mm_set1_ps(axisY[component]))));
+		clip[component][0] = _mm_sub_ps(side, _mm_set1_ps(axisZ[component]));
+		clip[component][1] = _mm_add_ps(side, _mm_set1_ps(axisZ[component]));
+	}
+	__m128 pixelMinX = _mm_set1_ps(FLT_MAX), pixelMinY = pixelMinX, depthMin = pixelMinX;
+	__m128 pixelMaxX = _mm_set1_ps(-FLT_MAX), pixelMaxY = pixelMaxX;
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+	const __m128 halfWidth = _mm_set1_ps(width * 0.5f), halfHeight = _mm_set1_ps(height * 0.5f);
+	for (int h = 0; h < 2; h++) {
+		__m128 w = clip[3][h];
+		__m128 behind = _mm_or_ps(_mm_cmple_ps(w, zero), _mm_cmplt_ps(clip[2][h], _mm_sub_ps(zero, w)));
+		if (_mm_movemask_ps(behind) != 0) {
+			return true;
+		}
+		__m128 inverseW = _mm_div_ps(one, w);
+		__m128 pixelX = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[0][h], inverseW), halfWidth), halfWidth);
+		__m128 pixelY = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[1][h], inverseW), halfHeight), halfHeight);
+		pixelMinX = _mm_min_ps(pixelMinX, pixelX);
+		pixelMaxX = _mm_max_ps(pixelMaxX, pixelX);
+		pixelMinY = _mm_min_ps(pixelMinY, pixelY);
+		pixelMaxY = _mm_max_ps(pixelMaxY, pixelY);
+		depthMin = _mm_min_ps(depthMin, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[2][h], inverseW), half), half));
+	}
+	alignas(16) float lanes[5][4];
+	_mm_store_ps(lanes[0], pixelMinX);
+	_mm_store_ps(lanes[1], pixelMinY);
+	_mm_store_ps(lanes[2], pixelMaxX);
+	_mm_store_ps(lanes[3], pixelMaxY);
+	_mm_store_ps(lanes[4], depthMin);
+	rectMin = glm::vec2(std::min(std::min(lanes[0][0], lanes[0][1]), std::min(lanes[0][2], lanes[0][3])),
+		std::min(std::min(lanes[1][0], lanes[1][1]), std::min(lanes[1][2], lanes[1][3])));
+	rectMax = glm::vec2(std::max(std::max(lanes[2][0], lanes[2][1]), std::max(lanes[2][2], lanes[2][3])),
+		std::max(std::max(lanes[3][0], lanes[3][1]), std::max(lanes[3][2], lanes[3][3])));
+	nearest = std::min(std::min(std::min(lanes[4][0], lanes[4][1]), std::min(lanes[4][2], lanes[4][3])), 1.0f);
+#else
+	rectMin = glm::vec2(FLT_MAX);
+	rectMax = glm::vec2(-FLT_MAX);
+	nearest = 1.0f;
+	for (int c = 0; c < 8; c++) {
+		glm::vec4 clip = center + (c & 1 ? axisX : -axisX) + (c & 2 ? axisY : -axisY) + (c & 4 ? axisZ : -axisZ);
+		if (clip.w <= 0.0f || clip.z < -clip.w) {
+			return true;
+		}
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 pixel((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+		rectMin = glm::min(rectMin, pixel);
+		rectMax = glm::max(rectMax, pixel);
+		nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+#endif
+	int x0 = std::max(0, (int)std::floor(rectMin.x)), x1 = std::min(width - 1, (int)std::floor(rectMax.x));
+	int y0 = std::max(0, (int)std::floor(rectMin.y)), y1 = std::min(height - 1, (int)std::floor(rectMax.y));
+	if (x0 > x1 || y0 > y1) {
+		return true;
+	}
+
+	// Blocks whose farthest depth is nearer than the box hide their part of it outright; the
+	// others are checked pixel by pixel until one shows the box
+	int blocksX = width / OCCLUSION_BLOCK_SIZE;
+	for (int by = y0 / OCCLUSION_BLOCK_SIZE; by <= y1 / OCCLUSION_BLOCK_SIZE; by++) {
+		for (int bx = x0 / OCCLUSION_BLOCK_SIZE; bx <= x1 / OCCLUSION_BLOCK_SIZE; bx++) {
+			if (blockMax[(size_t)by * blocksX + bx] < nearest) {
+				continue;
+			}
+			int px0 = std::max(x0, bx * OCCLUSION_BLOCK_SIZE), px1 = std::min(x1, bx * OCCLUSION_BLOCK_SIZE + OCCLUSION_BLOCK_SIZE - 1);
+			int py0 = std::max(y0, by * OCCLUSION_BLOCK_SIZE), py1 = std::min(y1, by * OCCLUSION_BLOCK_SIZE + OCCLUSION_BLOCK_SIZE - 1);
+			for (int y = py0; y <= py1; y++) {
+				const float* line = depth.data() + (size_t)y * width;
+				for (int x = px0; x <= px1; x++) {
+					if (line[x] >= nearest) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Writes the candidates (indices into bounds, e.g. the output of FrustumCull() or BVH::Cull())
+// whose boxes may be visible to visible, in order, and returns how many there are. visible needs
+// room for count entries and may be candidates itself. With a pool the candidates are split
+// across its workers
+size_t OcclusionBuffer::Cull(const CullingBounds& bounds, const uint32_t* candidates, size_t count, uint32_t* visible, ThreadPool* pool) {
+	PROFILE_ZONE("OcclusionBuffer::Cull");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	auto cullRange = [&](size_t begin, size_t end, uint32_t* out) {
+		size_t written = 0;
+		for (size_t i = begin; i < end; i++) {
+			uint32_t object = candidates[i];
+			glm::vec3 center(bounds.centerX[object], bounds.centerY[object], bounds.centerZ[object]);
+			glm::vec3 extent(bounds.extentX[object], bounds.extentY[object], bounds.extentZ[object]);
+			out[written] = object;
+			written += IsVisible(center - extent, center + extent) ? 1 : 0;
+		}
+		return written;
+	};
+
+	size_t written;
+	if (!pool || pool->Size() == 0 || count <= OCCLUSION_TEST_GRAIN) {
+		written = cullRange(0, count, visible);
+	}
+	else {
+		// Each chunk writes its list at its own offset; the gaps are closed in order afterwards
+		std::vector<size_t> counts((count + OCCLUSION_TEST_GRAIN - 1) / OCCLUSION_TEST_GRAIN);
+		pool->ParallelFor(count, OCCLUSION_TEST_GRAIN, [&](size_t begin, size_t end) {
+			counts[begin / OCCLUSION_TEST_GRAIN] = cullRange(begin, end, visible + begin);
+		});
+		written = counts[0];
+		for (size_t chunk = 1; chunk < counts.size(); chunk++) {
+			std::memmove(visible + written, visible + chunk * OCCLUSION_TEST_GRAIN, counts[chunk] * sizeof(uint32_t));
+			written += counts[chunk];
+		}
+	}
+
+	stats.tested += count;
+	stats.culled += count - written;
+	stats.testMs += millisecondsSince(start);
+	return written;
+}
@@ -0,0 +1,90 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "FrustumCulling.h"
+
+class ThreadPool;
+
+// Software occlusion culling on the CPU, so hidden objects are dropped before any draw is submitted.
+// Each frame a few large occluder meshes (walls, buildings, terrain) are rasterized into a small
+// depth buffer, 4 pixels at a time with SSE2; the screen is split into tiles that rasterize in
+// parallel, and every 8x8 block keeps its farthest depth. Object boxes are then projected and tested
+// against the blocks first and the pixels only where a block doesn't settle it. Needs no GL context.
+//
+// Per frame:
+//   occlusion.Begin(camera.ViewProjection(...));
+//   occlusion.AddOccluder(...);   // for each occluder
+//   occlusion.Rasterize(pool);
+//   count = occlusion.Cull(bounds, candidates, candidateCount, visible, pool);
+class OcclusionBuffer {
+public:
+	// Counts and timings of the current frame
+	struct Stats {
+		unsigned int occluderTriangles = 0;   // handed to AddOccluder()
+		unsigned int rasterizedTriangles = 0; // left after near-plane and degenerate rejection
+		size_t tested = 0;
+		size_t culled = 0;
+		double rasterizeMs = 0.0;             // AddOccluder() setup and Rasterize()
+		double testMs = 0.0;
+	};
+
+	Stats stats;
+
+	// Constructor that allocates a depth buffer of the given size (rounded up to multiples of 8)
+	OcclusionBuffer(int width = 256, int height = 128);
+
+	// Starts a frame: drops last frame's occluders and resets the stats
+	void Begin(const glm::mat4& viewProjection);
+
+	// Adds the triangles of a mesh as an occluder. Positions are three floats at the start of every
+	// positionStride bytes. Triangles crossing the near plane are skipped (which only loses occlusion);
+	// both windings are drawn, so meshes needn't be closed or consistently wound
+	void AddOccluder(const float* positions, size_t vertexCount, size_t positionStride, const GLuint* indices, size_t indexCount,
+		const glm::mat4& model = glm::mat4(1.0f));
+
+	// Clears the depth buffer and rasterizes every occluder, one tile per job when given a pool
+	void Rasterize(ThreadPool* pool = nullptr);
+
+	// Returns false only if the box is certainly hidden behind the occluders. Boxes off screen or
+	// crossing the near plane count as visible (frustum culling deals with those)
+	bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+	// Writes the candidates (indices into bounds, e.g. the output of FrustumCull() or BVH::Cull())
+	// whose boxes may be visible to visible, in order, and returns how many there are. visible needs
+	// room for count entries and may be candidates itself. With a pool the candidates are split
+	// across its workers
+	size_t Cull(const CullingBounds& bounds, const uint32_t* candidates, size_t count, uint32_t* visible, ThreadPool* pool = nullptr);
+
+	// Depth of every pixel in [0, 1] (1 = far, nothing drawn), rows bottom to top
+	const float* Depth() const { return depth.data(); }
+	int Width() const { return width; }
+	int Height() const { return height; }
+
+private:
+	// A triangle set up for rasterization: edge functions and depth plane in pixel coordinates
+	struct Triangle {
+		float edgeA[3], edgeB[3], edgeC[3];  // edge i is edgeA[i] * x + edgeB[i] * y + edgeC[i] >= 0 inside
+		float depthA, depthB, depthC;        // depth = depthA * x + depthB * y + depthC
+		int minX, minY, maxX, maxY;          // pixel bounds, clamped to the buffer
+	};
+
+	int width, height;
+	int tilesX, tilesY;
+	glm::mat4 viewProjection = glm::mat4(1.0f);
+	std::vector<float> depth;
+	std::vector<float> blockMax;             // farthest depth of every 8x8 block
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<uint32_t>> tileTriangles;
+	std::vector<glm::vec4> clipScratch;
+
+	// Clears and rasterizes one tile, then updates its blocks
+	void rasterizeTile(int tile);
+};
+
+#endif
@@ -0,0 +1,244 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// Process ids used to separate the CPU and GPU tracks in the trace viewer
+static const int CPU_TRACE_PID = 0;
+static const int GPU_TRACE_PID = 1;
+
+// Per-thread stack of open CPU zone start times (and names)
+struct OpenZone {
+	const char* name;
+	double start;
+};
+static thread_local std::vector<OpenZone> openZones;
+
+// Returns the global profiler
+Profiler& Profiler::Get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+// Starts recording; GPU zones are only recorded if a GL context is current and gpu is true
+void Profiler::Enable(bool gpu) {
+	epoch = std::chrono::steady_clock::now();
+	events.clear();
+	events.reserve(4096);
+
+	gpuEnabled = gpu && glGetString != nullptr && glGenQueries != nullptr;
+	if (gpuEnabled) {
+		// Pair a GPU timestamp with the CPU epoch so both tracks share one timeline
+		glGetInteger64v(GL_TIMESTAMP, &gpuEpoch);
+		gpuEpochOffset = now();
+		for (GPUFrame& frame : gpuFrames) {
+			frame.zones.clear();
+			frame.usedQueries = 0;
+			frame.pending = false;
+		}
+		gpuFrameIndex = 0;
+	}
+	enabled = true;
+}
+
+// Stops recording and releases GPU queries
+void Profiler::Disable() {
+	if (gpuEnabled) {
+		for (GPUFrame& frame : gpuFrames) {
+			if (!frame.queries.empty()) {
+				glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+			}
+			frame.queries.clear();
+			frame.zones.clear();
+			frame.usedQueries = 0;
+			frame.pending = false;
+		}
+	}
+	gpuEnabled = false;
+	enabled = false;
+}
+
+// Marks the start of a frame
+void Profiler::BeginFrame() {
+	if (!enabled) {
+		return;
+	}
+	frameStart = std::chrono::steady_clock::now();
+
+	if (gpuEnabled) {
+		// Read back every older frame whose queries are done, without waiting
+		for (int i = 1; i < GPU_FRAMES_IN_FLIGHT; i++) {
+			GPUFrame& older = gpuFrames[(gpuFrameIndex + i) % GPU_FRAMES_IN_FLIGHT];
+			if (older.pending) {
+				resolveGPUFrame(older, false);
+			}
+		}
+
+		// The slot we are about to reuse is GPU_FRAMES_IN_FLIGHT frames old; if it still is not
+		// ready the GPU is hopelessly behind and we drop it rather than stall
+		GPUFrame& frame = gpuFrames[gpuFrameIndex];
+		if (frame.pending && !resolveGPUFrame(frame, false)) {
+			droppedGPUZones += frame.zones.size();
+		}
+		frame.zones.clear();
+		frame.usedQueries = 0;
+		frame.pending = true;
+		gpuZoneStack.clear();
+	}
+
+	BeginZone("Frame");
+	BeginGPUZone("Frame");
+}
+
+// Marks the end of a frame
+void Profiler::EndFrame() {
+	if (!enabled) {
+		return;
+	}
+	EndGPUZone();
+	EndZone();
+	gpuFrameIndex = (gpuFrameIndex + 1) % GPU_FRAMES_IN_FLIGHT;
+}
+
+// Opens a CPU zone on the calling thread
+void Profiler::BeginZone(const char* name) {
+	openZones.push_back({ name, now() });
+}
+
+// Closes the innermost CPU zone on the calling thread
+void Profiler::EndZone() {
+	if (openZones.empty()) {
+		return;
+	}
+	OpenZone zone = openZones.back();
+	openZones.pop_back();
+	addEvent({ zone.name, zone.start, now() - zone.start, 0.0, threadIndex(), 'X' });
+}
+
+// Opens a GPU zone (timestamp query pair, so zones can nest)
+void Profiler::BeginGPUZone(const char* name) {
+	if (!gpuEnabled) {
+		return;
+	}
+	GPUFrame& frame = gpuFrames[gpuFrameIndex];
+	GPUZone zone = { name, nextQuery(frame), 0 };
+	glQueryCounter(zone.beginQuery, GL_TIMESTAMP);
+	gpuZoneStack.push_back(frame.zones.size());
+	frame.zones.push_back(zone);
+}
+
+// Closes the innermost GPU zone
+void Profiler::EndGPUZone() {
+	if (!gpuEnabled || gpuZoneStack.empty()) {
+		return;
+	}
+	GPUFrame& frame = gpuFrames[gpuFrameIndex];
+	GPUZone& zone = frame.zones[gpuZoneStack.back()];
+	gpuZoneStack.pop_back();
+	zone.endQuery = nextQuery(frame);
+	glQueryCounter(zone.endQuery, GL_TIMESTAMP);
+}
+
+// Records the value of a named counter at the current time
+void Profiler::Counter(const char* name, double value) {
+	if (!enabled) {
+		return;
+	}
+	addEvent({ name, now(), 0.0, value, threadIndex(), 'C' });
+}
+
+// Writes all recorded events as Chrome trace-event JSON
+bool Profiler::WriteChromeTrace(const char* filename) {
+	// Pull in whatever GPU results are still outstanding (we are done rendering, stalling is fine)
+	if (gpuEnabled) {
+		for (GPUFrame& frame : gpuFrames) {
+			if (frame.pending) {
+				resolveGPUFrame(frame, true);
+			}
+		}
+	}
+
+	std::ofstream out(filename);
+	if (!out) {
+		std::cerr << "Failed to open trace file: " << filename << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(eventMutex);
+	out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << CPU_TRACE_PID << ",\"args\":{\"name\":\"CPU\"}},\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << GPU_TRACE_PID << ",\"args\":{\"name\":\"GPU\"}}";
+	for (const Event& event : events) {
+		bool gpu = event.thread == ~0u;
+		out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.start
+			<< ",\"pid\":" << (gpu ? GPU_TRACE_PID : CPU_TRACE_PID) << ",\"tid\":" << (gpu ? 0 : event.thread);
+		if (event.phase == 'X') {
+			out << ",\"dur\":" << event.duration;
+		}
+		else {
+			out << ",\"args\":{\"value\":" << event.value << "}";
+		}
+		out << "}";
+	}
+	out << "\n]}\n";
+	std::cout << "Wrote " << events.size() << " trace events to " << filename << std::endl;
+	return true;
+}
+
+// Microseconds since Enable()
+double Profiler::now() const {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// Small stable id for the calling thread
+unsigned int Profiler::threadIndex() {
+	static std::atomic<unsigned int> nextIndex(0);
+	static thread_local unsigned int index = nextIndex++;
+	return index;
+}
+
+void Profiler::addEvent(const Event& event) {
+	std::lock_guard<std::mutex> lock(eventMutex);
+	if (events.size() < MAX_EVENTS) {
+		events.push_back(event);
+	}
+}
+
+// Returns a query object from the frame's pool, growing it when needed
+GLuint Profiler::nextQuery(GPUFrame& frame) {
+	if (frame.usedQueries == frame.queries.size()) {
+		size_t grow = frame.queries.empty() ? 32 : frame.queries.size();
+		frame.queries.resize(frame.queries.size() + grow);
+		glGenQueries((GLsizei)grow, frame.queries.data() + frame.usedQueries);
+	}
+	return frame.queries[frame.usedQueries++];
+}
+
+// Converts a frame's finished queries into trace events; returns false if they are not ready yet
+bool Profiler::resolveGPUFrame(GPUFrame& frame, bool wait) {
+	if (frame.usedQueries > 0 && !wait) {
+		// Queries complete in order, so the last one being available means all of them are
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			return false;
+		}
+	}
+
+	for (const GPUZone& zone : frame.zones) {
+		if (zone.endQuery == 0) {
+			continue;
+		}
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+		double start = gpuEpochOffset + (double)((GLint64)begin - gpuEpoch) / 1000.0;
+		addEvent({ zone.name, start, (double)(end - begin) / 1000.0, 0.0, ~0u, 'X' });
+	}
+	frame.zones.clear();
+	frame.usedQueries = 0;
+	frame.pending = false;
+	return true;
+}
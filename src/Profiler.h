@@ -0,0 +1,149 @@
+#ifndef PROFILER_CLASS_H
+#define PROFILER_CLASS_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame profiler with nestable CPU zones, GPU timestamp zones and Chrome trace export.
+// GPU zones are resolved several frames later from a ring of query objects, so reading
+// them back never stalls the pipeline. Load the trace in chrome://tracing or Perfetto.
+class Profiler {
+public:
+	// Number of frames GPU queries stay in flight before being read back
+	static const int GPU_FRAMES_IN_FLIGHT = 4;
+
+	// Upper bound on stored trace events (older runs stop recording once reached)
+	static const size_t MAX_EVENTS = 1 << 20;
+
+	// One complete ("X") or counter ("C") trace event, timestamps in microseconds
+	struct Event {
+		const char* name;
+		double start;
+		double duration;
+		double value;
+		unsigned int thread;
+		char phase;
+	};
+
+	// Returns the global profiler
+	static Profiler& Get();
+
+	// Starts recording; GPU zones are only recorded if a GL context is current and gpu is true
+	void Enable(bool gpu = true);
+
+	// Stops recording and releases GPU queries
+	void Disable();
+
+	// Returns true while recording
+	bool IsEnabled() const { return enabled; }
+
+	// Marks the frame boundaries (rotates the GPU query ring and records a "Frame" zone)
+	void BeginFrame();
+	void EndFrame();
+
+	// CPU zones, prefer the ProfileZone RAII marker
+	void BeginZone(const char* name);
+	void EndZone();
+
+	// GPU zones, prefer the GPUProfileZone RAII marker
+	void BeginGPUZone(const char* name);
+	void EndGPUZone();
+
+	// Records the value of a named counter at the current time
+	void Counter(const char* name, double value);
+
+	// Writes all recorded events as Chrome trace-event JSON
+	bool WriteChromeTrace(const char* filename);
+
+	// Number of GPU zones dropped because their results were not ready in time
+	unsigned long long droppedGPUZones = 0;
+
+private:
+	struct GPUZone {
+		const char* name;
+		GLuint beginQuery;
+		GLuint endQuery;
+	};
+
+	// Queries issued during one frame, read back GPU_FRAMES_IN_FLIGHT frames later
+	struct GPUFrame {
+		std::vector<GLuint> queries;
+		std::vector<GPUZone> zones;
+		size_t usedQueries = 0;
+		bool pending = false;
+	};
+
+	bool enabled = false;
+	bool gpuEnabled = false;
+
+	std::mutex eventMutex;
+	std::vector<Event> events;
+
+	std::chrono::steady_clock::time_point epoch;
+	std::chrono::steady_clock::time_point frameStart;
+
+	// GPU timestamp (ns) matching the CPU epoch, used to place GPU zones on the CPU timeline
+	GLint64 gpuEpoch = 0;
+	double gpuEpochOffset = 0.0;
+
+	GPUFrame gpuFrames[GPU_FRAMES_IN_FLIGHT];
+	int gpuFrameIndex = 0;
+	std::vector<size_t> gpuZoneStack;
+
+	// Microseconds since Enable()
+	double now() const;
+	unsigned int threadIndex();
+	void addEvent(const Event& event);
+	GLuint nextQuery(GPUFrame& frame);
+	bool resolveGPUFrame(GPUFrame& frame, bool wait);
+};
+
+// RAII CPU zone: records the time between construction and destruction
+class ProfileZone {
+public:
+	ProfileZone(const char* name) {
+		active = Profiler::Get().IsEnabled();
+		if (active) {
+			Profiler::Get().BeginZone(name);
+		}
+	}
+	~ProfileZone() {
+		if (active) {
+			Profiler::Get().EndZone();
+		}
+	}
+private:
+	bool active;
+};
+
+// RAII GPU zone: records GPU time between construction and destruction (GL thread only)
+class GPUProfileZone {
+public:
+	GPUProfileZone(const char* name) {
+		active = Profiler::Get().IsEnabled();
+		if (active) {
+			Profiler::Get().BeginGPUZone(name);
+		}
+	}
+	~GPUProfileZone() {
+		if (active) {
+			Profiler::Get().EndGPUZone();
+		}
+	}
+private:
+	bool active;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Profiles the rest of the enclosing scope on the CPU
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+// Profiles the GL commands issued in the rest of the enclosing scope on the GPU
+#define PROFILE_GPU_ZONE(name) GPUProfileZone PROFILE_CONCAT(gpuProfileZone_, __LINE__)(name)
+
+#endif
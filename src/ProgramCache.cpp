@@ -0,0 +1,159 @@
+#include "ProgramCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Cache file header, followed by the program binary itself
+struct ProgramCacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint32_t binaryFormat;
+	uint32_t binaryLength;
+};
+
+static const char PROGRAM_CACHE_MAGIC[4] = { 'G', 'L', 'P', 'B' };
+static const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+// Returns the global program cache
+ProgramCache& ProgramCache::Get() {
+	static ProgramCache cache;
+	return cache;
+}
+
+// Enables the cache in the given directory (created if needed); an empty path disables it
+void ProgramCache::SetDirectory(const std::string& directory) {
+	ProgramCache::directory = directory;
+	driverString.clear();
+	if (!directory.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			std::cerr << "Failed to create program cache directory: " << directory << std::endl;
+			ProgramCache::directory.clear();
+		}
+	}
+}
+
+// Returns true if the cache is enabled and the current context supports program binaries
+bool ProgramCache::IsEnabled() {
+	if (directory.empty() || glGetProgramBinary == nullptr || glProgramBinary == nullptr) {
+		return false;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+// Computes the cache key for a program built from the given sources on the current driver
+uint64_t ProgramCache::Key(const std::string& vertexCode, const std::string& fragmentCode) {
+	if (driverString.empty()) {
+		driverString = std::string((const char*)glGetString(GL_VENDOR)) + "|" +
+			(const char*)glGetString(GL_RENDERER) + "|" + (const char*)glGetString(GL_VERSION);
+	}
+
+	// Hash the stage boundary too, so moving text between the two sources changes the key
+	const char separator = 0;
+	uint64_t hash = fnv1a64(driverString.data(), driverString.size());
+	hash = fnv1a64(vertexCode.data(), vertexCode.size(), hash);
+	hash = fnv1a64(&separator, 1, hash);
+	hash = fnv1a64(fragmentCode.data(), fragmentCode.size(), hash);
+	return hash;
+}
+
+// Tries to load a cached binary into program; returns true if it linked successfully
+bool ProgramCache::Load(uint64_t key, GLuint program) {
+	std::ifstream in(path(key), std::ios::binary);
+	if (!in) {
+		misses++;
+		return false;
+	}
+
+	ProgramCacheHeader header;
+	in.read((char*)&header, sizeof(header));
+	if (!in || std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) != 0 || header.version != PROGRAM_CACHE_VERSION || header.key != key) {
+		misses++;
+		return false;
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	in.read(binary.data(), binary.size());
+	if (!in) {
+		misses++;
+		return false;
+	}
+
+	// The driver may still refuse the binary (e.g. after an update that kept the version string)
+	glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE) {
+		rejected++;
+		misses++;
+		std::remove(path(key).c_str());
+		return false;
+	}
+
+	hits++;
+	return true;
+}
+
+// Stores the binary of a successfully linked program
+bool ProgramCache::Store(uint64_t key, GLuint program) {
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return false;
+	}
+
+	std::vector<char> binary(length);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+	ProgramCacheHeader header;
+	std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+	header.version = PROGRAM_CACHE_VERSION;
+	header.key = key;
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = (uint32_t)length;
+
+	// Write to a temporary file first so a crash never leaves a truncated entry behind
+	std::string finalPath = path(key);
+	std::string tempPath = finalPath + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			return false;
+		}
+		out.write((const char*)&header, sizeof(header));
+		out.write(binary.data(), length);
+		if (!out) {
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, finalPath, error);
+	if (error) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	stores++;
+	return true;
+}
+
+// Prints the hit/miss statistics
+void ProgramCache::Report() {
+	std::cout << "Program cache: " << hits << " hits, " << misses << " misses (" << rejected
+		<< " rejected by driver), " << stores << " stored" << std::endl;
+}
+
+std::string ProgramCache::path(uint64_t key) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return directory + "/" + name;
+}
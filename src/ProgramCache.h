@@ -0,0 +1,49 @@
+#ifndef PROGRAM_CACHE_CLASS_H
+#define PROGRAM_CACHE_CLASS_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+#include "Hash.h"
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+// Entries are keyed by a hash of the shader sources plus the driver vendor/renderer/version
+// strings, so a driver update or a shader edit simply misses and recompiles.
+class ProgramCache {
+public:
+	// Cache statistics
+	unsigned int hits = 0;
+	unsigned int misses = 0;
+	unsigned int rejected = 0;
+	unsigned int stores = 0;
+
+	// Returns the global program cache
+	static ProgramCache& Get();
+
+	// Enables the cache in the given directory (created if needed); an empty path disables it
+	void SetDirectory(const std::string& directory);
+
+	// Returns true if the cache is enabled and the current context supports program binaries
+	bool IsEnabled();
+
+	// Computes the cache key for a program built from the given sources on the current driver
+	uint64_t Key(const std::string& vertexCode, const std::string& fragmentCode);
+
+	// Tries to load a cached binary into program; returns true if it linked successfully
+	bool Load(uint64_t key, GLuint program);
+
+	// Stores the binary of a successfully linked program
+	bool Store(uint64_t key, GLuint program);
+
+	// Prints the hit/miss statistics
+	void Report();
+
+private:
+	std::string directory;
+	std::string driverString;
+
+	std::string path(uint64_t key);
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "RangeAllocator.h"
+
+#include <iterator>
+
+// Constructor that starts with the whole space free
+RangeAllocator::RangeAllocator(uint32_t capacity) {
+	Reset(capacity);
+}
+
+// Returns the offset of a new range, or INVALID
+uint32_t RangeAllocator::Allocate(uint32_t size) {
+	if (size == 0) {
+		return INVALID;
+	}
+
+	// Smallest free range that fits
+	std::multimap<uint32_t, uint32_t>::iterator fit = bySize.lower_bound(size);
+	if (fit == bySize.end()) {
+		return INVALID;
+	}
+	uint32_t offset = fit->second;
+	uint32_t rangeSize = fit->first;
+	eraseFree(byOffset.find(offset));
+
+	// Whatever is left stays free
+	if (rangeSize > size) {
+		insertFree(offset + size, rangeSize - size);
+	}
+	freeSpace -= size;
+	return offset;
+}
+
+// Returns a range to the free list, merging it with adjacent free ranges
+void RangeAllocator::Free(uint32_t offset, uint32_t size) {
+	if (size == 0) {
+		return;
+	}
+	freeSpace += size;
+
+	std::map<uint32_t, uint32_t>::iterator next = byOffset.lower_bound(offset);
+	if (next != byOffset.begin()) {
+		std::map<uint32_t, uint32_t>::iterator previous = std::prev(next);
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			size += previous->second;
+			eraseFree(previous);
+		}
+	}
+	if (next != byOffset.end() && offset + size == next->first) {
+		size += next->second;
+		eraseFree(next);
+	}
+	insertFree(offset, size);
+}
+
+// Extends the space to newCapacity (the new tail becomes free)
+void RangeAllocator::Grow(uint32_t newCapacity) {
+	if (newCapacity <= capacity) {
+		return;
+	}
+	uint32_t oldCapacity = capacity;
+	capacity = newCapacity;
+	Free(oldCapacity, newCapacity - oldCapacity);
+}
+
+// Frees everything and sets a new capacity
+void RangeAllocator::Reset(uint32_t capacity) {
+	RangeAllocator::capacity = capacity;
+	freeSpace = capacity;
+	byOffset.clear();
+	bySize.clear();
+	if (capacity > 0) {
+		insertFree(0, capacity);
+	}
+}
+
+void RangeAllocator::insertFree(uint32_t offset, uint32_t size) {
+	byOffset.emplace(offset, size);
+	bySize.emplace(size, offset);
+}
+
+void RangeAllocator::eraseFree(std::map<uint32_t, uint32_t>::iterator range) {
+	std::pair<std::multimap<uint32_t, uint32_t>::iterator, std::multimap<uint32_t, uint32_t>::iterator> sized = bySize.equal_range(range->second);
+	for (std::multimap<uint32_t, uint32_t>::iterator it = sized.first; it != sized.second; ++it) {
+		if (it->second == range->first) {
+			bySize.erase(it);
+			break;
+		}
+	}
+	byOffset.erase(range);
+}
@@ -0,0 +1,50 @@
+#ifndef RANGE_ALLOCATOR_CLASS_H
+#define RANGE_ALLOCATOR_CLASS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+// Hands out [offset, offset + size) ranges of a linear space (in whatever unit the caller uses:
+// vertices, indices, bytes). Free ranges are kept both by offset, so freeing coalesces with its
+// neighbours, and by size, so allocation is best-fit in O(log n).
+class RangeAllocator {
+public:
+	// Returned by Allocate when no free range is large enough
+	static const uint32_t INVALID = 0xFFFFFFFFu;
+
+	// Constructor that starts with the whole space free
+	RangeAllocator(uint32_t capacity = 0);
+
+	// Returns the offset of a new range, or INVALID
+	uint32_t Allocate(uint32_t size);
+
+	// Returns a range to the free list, merging it with adjacent free ranges
+	void Free(uint32_t offset, uint32_t size);
+
+	// Extends the space to newCapacity (the new tail becomes free)
+	void Grow(uint32_t newCapacity);
+
+	// Frees everything and sets a new capacity
+	void Reset(uint32_t capacity);
+
+	uint32_t Capacity() const { return capacity; }
+	uint32_t Used() const { return capacity - freeSpace; }
+	uint32_t FreeSpace() const { return freeSpace; }
+	uint32_t LargestFree() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+	size_t FreeRanges() const { return byOffset.size(); }
+
+	// 0 when all free space is one range, approaching 1 as it splinters into small pieces
+	float Fragmentation() const { return freeSpace == 0 ? 0.0f : 1.0f - (float)LargestFree() / (float)freeSpace; }
+
+private:
+	uint32_t capacity = 0;
+	uint32_t freeSpace = 0;
+	std::map<uint32_t, uint32_t> byOffset;     // offset -> size
+	std::multimap<uint32_t, uint32_t> bySize;  // size -> offset
+
+	void insertFree(uint32_t offset, uint32_t size);
+	void eraseFree(std::map<uint32_t, uint32_t>::iterator range);
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "RenderQueue.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+// Key segment widths
+static const int PASS_BITS = 4;
+static const int SHADER_BITS = 12;
+static const int TEXTURE_BITS = 16;
+static const int VAO_BITS = 12;
+static const int DEPTH_BITS = 20;
+
+static const int DEPTH_SHIFT = 0;
+static const int VAO_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+static const int TEXTURE_SHIFT = VAO_SHIFT + VAO_BITS;
+static const int SHADER_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+static const int PASS_SHIFT = SHADER_SHIFT + SHADER_BITS;
+
+static_assert(PASS_SHIFT + PASS_BITS == 64, "sort key segments must fill 64 bits");
+
+// Queues a draw
+void RenderQueue::Submit(const DrawCommand& command, unsigned int pass, float depth) {
+	keys.push_back(MakeKey(command, pass, depth));
+	commands.push_back(command);
+}
+
+// Builds the sort key for a draw
+uint64_t RenderQueue::MakeKey(const DrawCommand& command, unsigned int pass, float depth) {
+	uint64_t shader = denseId(shaderIds, command.shader->ID, 1u << SHADER_BITS);
+	uint64_t texture = command.texture ? denseId(textureIds, command.texture->ID, 1u << TEXTURE_BITS) : 0;
+	uint64_t vao = denseId(vaoIds, command.vao->ID, 1u << VAO_BITS);
+	uint64_t quantizedDepth = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * ((1u << DEPTH_BITS) - 1));
+
+	return ((uint64_t)std::min(pass, (1u << PASS_BITS) - 1) << PASS_SHIFT) |
+		(shader << SHADER_SHIFT) | (texture << TEXTURE_SHIFT) | (vao << VAO_SHIFT) | (quantizedDepth << DEPTH_SHIFT);
+}
+
+// Sorts and issues all queued draws, then clears the queue
+void RenderQueue::Flush(const std::function<void(Shader&)>& onShaderBound) {
+	PROFILE_ZONE("RenderQueue::Flush");
+	stats = Stats();
+
+	order.resize(commands.size());
+	for (uint32_t i = 0; i < (uint32_t)order.size(); i++) {
+		order[i] = i;
+	}
+	{
+		PROFILE_ZONE("RenderQueue sort");
+		RadixSort(keys, order);
+	}
+
+	// Sorted draws sharing a key segment share the object, so state only changes at segment boundaries
+	// (compared by GL name, which stays correct even when an id segment overflows)
+	GLuint program = 0, texture = 0, vertexArray = 0;
+	unsigned int naiveBinds = 0;
+	for (size_t i = 0; i < order.size(); i++) {
+		const DrawCommand& command = commands[order[i]];
+
+		if (i == 0 || command.shader->ID != program) {
+			command.shader->Activate();
+			program = command.shader->ID;
+			stats.shaderChanges++;
+			if (onShaderBound) {
+				onShaderBound(*command.shader);
+			}
+		}
+		if (command.texture && (i == 0 || command.texture->ID != texture)) {
+			command.texture->Bind();
+			texture = command.texture->ID;
+			stats.textureChanges++;
+		}
+		if (i == 0 || command.vao->ID != vertexArray) {
+			command.vao->Bind();
+			vertexArray = command.vao->ID;
+			stats.vaoChanges++;
+		}
+
+		if (command.instanceCount == 1) {
+			glDrawElementsBaseVertex(GL_TRIANGLES, command.count, command.indexType, (const void*)command.firstIndex, command.baseVertex);
+		}
+		else {
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, command.indexType, (const void*)command.firstIndex, command.instanceCount, command.baseVertex);
+		}
+		stats.draws++;
+		naiveBinds += command.texture ? 3 : 2;
+	}
+	stats.stateChangesSaved = naiveBinds - stats.shaderChanges - stats.textureChanges - stats.vaoChanges;
+	Profiler::Get().Counter("RenderQueue state changes saved", stats.stateChangesSaved);
+
+	commands.clear();
+	keys.clear();
+}
+
+// Sorts keys ascending with an 8-bit LSD radix sort, permuting values along
+void RenderQueue::RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values) {
+	const size_t count = keys.size();
+	if (count < 2) {
+		return;
+	}
+
+	// Histograms for all 8 digits in one pass over the keys
+	size_t histogram[8][256] = {};
+	for (uint64_t key : keys) {
+		for (int digit = 0; digit < 8; digit++) {
+			histogram[digit][(key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	std::vector<uint64_t> keyScratch(count);
+	std::vector<uint32_t> valueScratch(count);
+	for (int digit = 0; digit < 8; digit++) {
+		// A digit shared by every key (unused key bits, single pass, ...) doesn't change the order
+		size_t* counts = histogram[digit];
+		if (counts[(keys[0] >> (digit * 8)) & 0xFF] == count) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			size_t bucketCount = counts[bucket];
+			counts[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (size_t i = 0; i < count; i++) {
+			size_t destination = counts[(keys[i] >> (digit * 8)) & 0xFF]++;
+			keyScratch[destination] = keys[i];
+			valueScratch[destination] = values[i];
+		}
+		keys.swap(keyScratch);
+		values.swap(valueScratch);
+	}
+}
+
+uint32_t RenderQueue::denseId(std::unordered_map<GLuint, uint32_t>& ids, GLuint name, uint32_t limit) {
+	std::unordered_map<GLuint, uint32_t>::iterator it = ids.find(name);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	// Once a segment is full, further objects share its last id (they just sort together)
+	uint32_t id = std::min((uint32_t)ids.size(), limit - 1);
+	ids.emplace(name, id);
+	return id;
+}
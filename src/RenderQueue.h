@@ -0,0 +1,75 @@
+#ifndef RENDER_QUEUE_CLASS_H
+#define RENDER_QUEUE_CLASS_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "ShaderClass.h"
+#include "TextureClass.h"
+#include "VAO.h"
+
+// One indexed draw and the state it needs
+struct DrawCommand {
+	Shader* shader;
+	Texture* texture;   // may be null
+	VAO* vao;
+	GLsizei count;      // number of indices
+	GLenum indexType;   // GL_UNSIGNED_INT / GL_UNSIGNED_SHORT
+	GLintptr firstIndex; // byte offset into the element buffer
+	GLsizei instanceCount = 1; // > 1 draws with glDrawElementsInstanced (instance data comes from the VAO)
+	GLint baseVertex = 0;      // added to every index (meshes sub-allocated from a GeometryPool)
+};
+
+// Collects draws for a frame, sorts them by a packed 64-bit key and submits them so that
+// glUseProgram / glBindTexture / glBindVertexArray only run when the relevant key segment changes.
+//
+// Key layout (most significant first):
+//   pass 4 | shader 12 | texture 16 | vao 12 | depth 20
+class RenderQueue {
+public:
+	// Per-flush statistics
+	struct Stats {
+		unsigned int draws = 0;
+		unsigned int shaderChanges = 0;
+		unsigned int textureChanges = 0;
+		unsigned int vaoChanges = 0;
+		// Binds a naive loop would have issued (program, texture, VAO per draw) minus the ones actually issued
+		unsigned int stateChangesSaved = 0;
+	};
+
+	Stats stats;
+
+	// Queues a draw; pass orders groups of draws (lower first), depth in [0, 1] orders draws
+	// front to back within the same state
+	void Submit(const DrawCommand& command, unsigned int pass = 0, float depth = 0.0f);
+
+	// Sorts and issues all queued draws, then clears the queue; onShaderBound runs right after
+	// each program change so per-program uniforms (e.g. the camera matrix) can be set
+	void Flush(const std::function<void(Shader&)>& onShaderBound = nullptr);
+
+	// Number of queued draws
+	size_t Size() const { return commands.size(); }
+
+	// Builds the sort key for a draw
+	uint64_t MakeKey(const DrawCommand& command, unsigned int pass, float depth);
+
+	// Sorts keys ascending with an 8-bit LSD radix sort, permuting values along (exposed for benchmarks)
+	static void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
+private:
+	std::vector<DrawCommand> commands;
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> order;
+
+	// GL object names mapped to small dense ids so they fit their key segments
+	std::unordered_map<GLuint, uint32_t> shaderIds;
+	std::unordered_map<GLuint, uint32_t> textureIds;
+	std::unordered_map<GLuint, uint32_t> vaoIds;
+
+	static uint32_t denseId(std::unordered_map<GLuint, uint32_t>& ids, GLuint name, uint32_t limit);
+};
+
+#endif
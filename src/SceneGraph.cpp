@@ -0,0 +1,267 @@
+#include "SceneGraph.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+// Translation * rotation * scale, without going through three 4x4 products
+static glm::mat4 localMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	glm::mat3 basis = glm::mat3_cast(rotation);
+	return glm::mat4(glm::vec4(basis[0] * scale.x, 0.0f), glm::vec4(basis[1] * scale.y, 0.0f),
+		glm::vec4(basis[2] * scale.z, 0.0f), glm::vec4(position, 1.0f));
+}
+
+// Reorders v so that slot i holds what was in slot order[i]
+template <typename T>
+static void permute(std::vector<T>& v, const std::vector<uint32_t>& order) {
+	std::vector<T> sorted(order.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		sorted[i] = v[order[i]];
+	}
+	v.swap(sorted);
+}
+
+// Creates a node under parent (or a root) with the given local transform
+SceneNode SceneGraph::Create(SceneNode parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	if (parent != INVALID_NODE && !Alive(parent)) {
+		return INVALID_NODE;
+	}
+	uint32_t slot = (uint32_t)handles.size();
+	uint32_t parentSlot = parent == INVALID_NODE ? NO_SLOT : slotOf(parent);
+	uint32_t depth = parentSlot == NO_SLOT ? 0 : depths[parentSlot] + 1;
+	// Appending keeps the storage sorted as long as nodes are created shallowest first
+	if (!depths.empty() && depth < depths.back()) {
+		unsorted = true;
+	}
+
+	uint32_t index;
+	if (!freeIndices.empty()) {
+		index = freeIndices.back();
+		freeIndices.pop_back();
+		slots[index] = slot;
+	}
+	else {
+		index = (uint32_t)slots.size();
+		slots.push_back(slot);
+		generations.push_back(0);
+	}
+	SceneNode node = index | ((uint32_t)generations[index] << GENERATION_SHIFT);
+
+	positions.push_back(position);
+	rotations.push_back(rotation);
+	scales.push_back(scale);
+	worlds.push_back(glm::mat4(1.0f));
+	parents.push_back(parentSlot);
+	firstChildren.push_back(NO_SLOT);
+	nextSiblings.push_back(parentSlot == NO_SLOT ? NO_SLOT : firstChildren[parentSlot]);
+	depths.push_back(depth);
+	dirty.push_back(0);
+	handles.push_back(node);
+	if (parentSlot != NO_SLOT) {
+		firstChildren[parentSlot] = slot;
+	}
+	markDirty(slot);
+	return node;
+}
+
+// Destroys a node and its whole subtree (nothing if it was already destroyed)
+void SceneGraph::Destroy(SceneNode node) {
+	if (!Alive(node)) {
+		return;
+	}
+	uint32_t root = slotOf(node);
+	uint32_t parentSlot = parents[root];
+	if (parentSlot != NO_SLOT) {
+		uint32_t* link = &firstChildren[parentSlot];
+		while (*link != root) {
+			link = &nextSiblings[*link];
+		}
+		*link = nextSiblings[root];
+	}
+
+	// The slots stay behind, unreachable, until the next Update() compacts the storage
+	scratch.assign(1, root);
+	while (!scratch.empty()) {
+		uint32_t slot = scratch.back();
+		scratch.pop_back();
+		for (uint32_t child = firstChildren[slot]; child != NO_SLOT; child = nextSiblings[child]) {
+			scratch.push_back(child);
+		}
+		uint32_t index = handles[slot] & INDEX_MASK;
+		slots[index] = NO_SLOT;
+		generations[index]++;
+		freeIndices.push_back(index);
+		handles[slot] = INVALID_NODE;
+		deadCount++;
+	}
+	unsorted = true;
+}
+
+// Whether the handle refers to a live node
+bool SceneGraph::Alive(SceneNode node) const {
+	uint32_t index = node & INDEX_MASK;
+	return index < slots.size() && slots[index] != NO_SLOT && generations[index] == node >> GENERATION_SHIFT;
+}
+
+// Local transform setters, ignored for destroyed nodes; the world matrices follow on the next Update()
+void SceneGraph::SetPosition(SceneNode node, const glm::vec3& position) {
+	if (!Alive(node)) {
+		return;
+	}
+	uint32_t slot = slotOf(node);
+	positions[slot] = position;
+	markDirty(slot);
+}
+
+void SceneGraph::SetRotation(SceneNode node, const glm::quat& rotation) {
+	if (!Alive(node)) {
+		return;
+	}
+	uint32_t slot = slotOf(node);
+	rotations[slot] = rotation;
+	markDirty(slot);
+}
+
+void SceneGraph::SetScale(SceneNode node, const glm::vec3& scale) {
+	if (!Alive(node)) {
+		return;
+	}
+	uint32_t slot = slotOf(node);
+	scales[slot] = scale;
+	markDirty(slot);
+}
+
+// Parent of a live node, or INVALID_NODE for roots
+SceneNode SceneGraph::Parent(SceneNode node) const {
+	uint32_t parentSlot = parents[slotOf(node)];
+	return parentSlot == NO_SLOT ? INVALID_NODE : handles[parentSlot];
+}
+
+// Recomputes the world matrices of every node marked since the last call, and of their subtrees
+void SceneGraph::Update() {
+	PROFILE_ZONE("SceneGraph::Update");
+	if (unsorted) {
+		sortByDepth();
+	}
+	stats.nodes = handles.size();
+	stats.updated = 0;
+	if (dirtySlots.empty()) {
+		return;
+	}
+
+	size_t updated = 0;
+	if ((float)dirtySlots.size() > fullPassThreshold * (float)handles.size()) {
+		// Most of the graph moved: one forward pass, each node inheriting its parent's mark
+		for (uint32_t slot = 0; slot < (uint32_t)handles.size(); slot++) {
+			uint32_t parentSlot = parents[slot];
+			if (parentSlot != NO_SLOT && dirty[parentSlot]) {
+				dirty[slot] = 1;
+			}
+			if (dirty[slot]) {
+				glm::mat4 local = localMatrix(positions[slot], rotations[slot], scales[slot]);
+				worlds[slot] = parentSlot == NO_SLOT ? local : worlds[parentSlot] * local;
+				updated++;
+			}
+		}
+		std::fill(dirty.begin(), dirty.end(), (uint8_t)0);
+		stats.fullPasses++;
+	}
+	else {
+		// Walk down from each marked node. Slot order is depth order, so a marked ancestor comes first
+		// and its walk clears the marks of everything below it
+		std::sort(dirtySlots.begin(), dirtySlots.end());
+		for (uint32_t root : dirtySlots) {
+			if (!dirty[root]) {
+				continue;
+			}
+			scratch.assign(1, root);
+			while (!scratch.empty()) {
+				uint32_t slot = scratch.back();
+				scratch.pop_back();
+				uint32_t parentSlot = parents[slot];
+				glm::mat4 local = localMatrix(positions[slot], rotations[slot], scales[slot]);
+				worlds[slot] = parentSlot == NO_SLOT ? local : worlds[parentSlot] * local;
+				dirty[slot] = 0;
+				updated++;
+				for (uint32_t child = firstChildren[slot]; child != NO_SLOT; child = nextSiblings[child]) {
+					scratch.push_back(child);
+				}
+			}
+		}
+	}
+	dirtySlots.clear();
+	stats.updated = updated;
+}
+
+// Marks a slot for the next Update()
+void SceneGraph::markDirty(uint32_t slot) {
+	if (!dirty[slot]) {
+		dirty[slot] = 1;
+		dirtySlots.push_back(slot);
+	}
+}
+
+// Rewrites the storage in depth order, dropping destroyed nodes
+void SceneGraph::sortByDepth() {
+	PROFILE_ZONE("SceneGraph::sortByDepth");
+	// Counting sort of the live slots by depth, keeping creation order within a level
+	uint32_t maxDepth = 0;
+	for (uint32_t slot = 0; slot < (uint32_t)handles.size(); slot++) {
+		if (handles[slot] != INVALID_NODE) {
+			maxDepth = std::max(maxDepth, depths[slot]);
+		}
+	}
+	std::vector<uint32_t> offsets(maxDepth + 2, 0);
+	for (uint32_t slot = 0; slot < (uint32_t)handles.size(); slot++) {
+		if (handles[slot] != INVALID_NODE) {
+			offsets[depths[slot] + 1]++;
+		}
+	}
+	for (uint32_t depth = 1; depth < offsets.size(); depth++) {
+		offsets[depth] += offsets[depth - 1];
+	}
+	std::vector<uint32_t> order(offsets.back());
+	std::vector<uint32_t> remap(handles.size(), NO_SLOT);
+	for (uint32_t slot = 0; slot < (uint32_t)handles.size(); slot++) {
+		if (handles[slot] != INVALID_NODE) {
+			uint32_t sorted = offsets[depths[slot]]++;
+			order[sorted] = slot;
+			remap[slot] = sorted;
+		}
+	}
+
+	permute(positions, order);
+	permute(rotations, order);
+	permute(scales, order);
+	permute(worlds, order);
+	permute(parents, order);
+	permute(firstChildren, order);
+	permute(nextSiblings, order);
+	permute(depths, order);
+	permute(dirty, order);
+	permute(handles, order);
+
+	// Links only ever point at live nodes: Destroy() unhooks a dead subtree from its parent
+	for (uint32_t slot = 0; slot < (uint32_t)order.size(); slot++) {
+		if (parents[slot] != NO_SLOT) {
+			parents[slot] = remap[parents[slot]];
+		}
+		if (firstChildren[slot] != NO_SLOT) {
+			firstChildren[slot] = remap[firstChildren[slot]];
+		}
+		if (nextSiblings[slot] != NO_SLOT) {
+			nextSiblings[slot] = remap[nextSiblings[slot]];
+		}
+		slots[handles[slot] & INDEX_MASK] = slot;
+	}
+
+	size_t kept = 0;
+	for (uint32_t slot : dirtySlots) {
+		if (remap[slot] != NO_SLOT) {
+			dirtySlots[kept++] = remap[slot];
+		}
+	}
+	dirtySlots.resize(kept);
+	deadCount = 0;
+	unsorted = false;
+	stats.sorts++;
+}
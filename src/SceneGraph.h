@@ -0,0 +1,106 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Handle of a node in a SceneGraph (stays valid while the node lives, whatever the storage order):
+// index in the low 24 bits, generation in the high 8, so a handle kept after Destroy() stops
+// matching when the index is reused (until the generation wraps around), like Entity in ECS.h
+typedef uint32_t SceneNode;
+static const SceneNode INVALID_NODE = 0xFFFFFFFFu;
+
+// Parent/child transform hierarchy. Local transforms (position, rotation, scale) and world matrices
+// are kept in parallel arrays sorted by depth, so a parent is always stored before its children
+// and every world matrix can be recomputed in one forward pass. Setting a local transform only
+// marks the node; Update() then recomputes the marked nodes and their subtrees, so a frame in which
+// a few nodes move costs in proportion to what moved. When most of the graph is dirty it switches
+// to the single linear pass instead.
+class SceneGraph {
+public:
+	// What the last Update() did
+	struct Stats {
+		size_t nodes = 0;
+		size_t updated = 0;           // world matrices recomputed by the last Update()
+		unsigned int fullPasses = 0;  // Update() calls that walked the whole graph
+		unsigned int sorts = 0;       // storage re-sorts after nodes were created or destroyed
+	};
+
+	Stats stats;
+
+	// Creates a node under parent (or a root) with the given local transform. Returns INVALID_NODE
+	// if parent was destroyed
+	SceneNode Create(SceneNode parent = INVALID_NODE, const glm::vec3& position = glm::vec3(0.0f),
+		const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+	// Destroys a node and its whole subtree (nothing if it was already destroyed)
+	void Destroy(SceneNode node);
+
+	// Whether the handle refers to a live node
+	bool Alive(SceneNode node) const;
+
+	// Local transform setters, ignored for destroyed nodes; the world matrices follow on the next Update()
+	void SetPosition(SceneNode node, const glm::vec3& position);
+	void SetRotation(SceneNode node, const glm::quat& rotation);
+	void SetScale(SceneNode node, const glm::vec3& scale);
+
+	// Local transform getters (node must be alive)
+	const glm::vec3& Position(SceneNode node) const { return positions[slotOf(node)]; }
+	const glm::quat& Rotation(SceneNode node) const { return rotations[slotOf(node)]; }
+	const glm::vec3& Scale(SceneNode node) const { return scales[slotOf(node)]; }
+
+	// Parent of a live node, or INVALID_NODE for roots
+	SceneNode Parent(SceneNode node) const;
+
+	// World matrix of a live node as of the last Update()
+	const glm::mat4& World(SceneNode node) const { return worlds[slotOf(node)]; }
+
+	// Recomputes the world matrices of every node marked since the last call, and of their subtrees
+	void Update();
+
+	// Number of live nodes
+	size_t Size() const { return handles.size() - deadCount; }
+
+	// Fraction of nodes dirty above which Update() walks the whole graph
+	void SetFullPassThreshold(float fraction) { fullPassThreshold = fraction; }
+
+private:
+	static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+	static constexpr uint32_t INDEX_MASK = 0x00FFFFFFu;
+	static constexpr uint32_t GENERATION_SHIFT = 24;
+
+	// Storage order: indexed by slot, sorted by depth after Update()
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> rotations;
+	std::vector<glm::vec3> scales;
+	std::vector<glm::mat4> worlds;
+	std::vector<uint32_t> parents;       // slot of the parent, NO_SLOT for roots
+	std::vector<uint32_t> firstChildren; // slot of the first child, NO_SLOT for leaves
+	std::vector<uint32_t> nextSiblings;  // slot of the next child of the same parent
+	std::vector<uint32_t> depths;
+	std::vector<uint8_t> dirty;
+	std::vector<SceneNode> handles;      // handle stored in each slot, INVALID_NODE once destroyed
+
+	std::vector<uint32_t> slots;         // slot of each handle index, NO_SLOT once destroyed
+	std::vector<uint8_t> generations;    // current generation of each handle index
+	std::vector<uint32_t> freeIndices;
+	std::vector<uint32_t> dirtySlots;    // marked since the last Update(), in any order
+	std::vector<uint32_t> scratch;
+	size_t deadCount = 0;
+	bool unsorted = false;
+	float fullPassThreshold = 0.25f;
+
+	// Slot of a live node
+	uint32_t slotOf(SceneNode node) const { return slots[node & INDEX_MASK]; }
+
+	// Marks a slot for the next Update()
+	void markDirty(uint32_t slot);
+
+	// Rewrites the storage in depth order, dropping destroyed nodes
+	void sortByDepth();
+};
+
+#endif
@@ -1,5 +1,12 @@
 #include "ShaderClass.h"
+#include "ProgramCache.h"
+#include "Profiler.h"
+#include "GLState.h"
+#include <algorithm>
 #include <stdexcept>
+#include <glm/gtc/type_ptr.hpp>
+
+unsigned int Shader::fallbackLookups = 0;
 
 // Reads a text file and returns its contents as a string
 std::string get_file_contents(const char *filename)
@@ -28,6 +35,23 @@ Shader::Shader(const char *vertexFile, const char *fragmentFile)
 	std::string vertexCode = get_file_contents(vertexFile);
 	std::string fragmentCode = get_file_contents(fragmentFile);
 
+	// Create the Shader Program Object
+	ID = glCreateProgram();
+
+	// Try the program binary cache first, which skips compiling and linking entirely
+	ProgramCache& cache = ProgramCache::Get();
+	bool useCache = cache.IsEnabled();
+	uint64_t cacheKey = 0;
+	if (useCache)
+	{
+		cacheKey = cache.Key(vertexCode, fragmentCode);
+		if (cache.Load(cacheKey, ID))
+		{
+			reflectUniforms();
+			return;
+		}
+	}
+
 	// Convert the shader source strings into character arrays
 	const char *vertexSource = vertexCode.c_str();
 	const char *fragmentSource = fragmentCode.c_str();
@@ -52,36 +76,131 @@ Shader::Shader(const char *vertexFile, const char *fragmentFile)
 	glCompileShader(fragmentShader);
 	compileErrors(fragmentShader, "FRAGMENT");
 
-	// Create the Shader Program Object
-	ID = glCreateProgram();
-
 	// Attach the Vertex and Fragment Shaders to the Shader Program
 	glAttachShader(ID, vertexShader);
 	glAttachShader(ID, fragmentShader);
 
+	// Ask the driver to keep the binary around so it can be cached
+	if (useCache)
+		glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	// Link all the shaders together into the Shader Program
 	glLinkProgram(ID);
-	compileErrors(ID, "PROGRAM");
+	bool linked = compileErrors(ID, "PROGRAM");
 
 	// Delete the Shaders because we dont need them anymore (and they're already in the program)
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+
+	// Build the uniform table so per-frame lookups never go to the driver
+	if (linked)
+		reflectUniforms();
+
+	// Save the linked program for the next launch
+	if (useCache && linked)
+		cache.Store(cacheKey, ID);
 }
 
 // Activate the shader program
 void Shader::Activate()
 {
-	glUseProgram(ID);
+	GLState::Get().UseProgram(ID);
 }
 
 // Delete the shader program
 void Shader::Delete()
 {
+	GLState::Get().DeleteProgram(ID);
 	glDeleteProgram(ID);
 }
 
-// Checks for compilation errors
-void Shader::compileErrors(unsigned int shader, const char *type)
+// Returns the location of a uniform from the reflected table (-1 if it does not exist)
+GLint Shader::UniformLocation(UniformName name)
+{
+	std::vector<Uniform>::iterator it = std::lower_bound(uniforms.begin(), uniforms.end(), name.hash,
+		[](const Uniform &uniform, uint32_t hash) { return uniform.hash < hash; });
+	if (it != uniforms.end() && it->hash == name.hash)
+		return it->location;
+
+	// Not an active uniform (or a name spelled differently than the driver reports it):
+	// ask the driver once and remember the answer, so a miss costs one round-trip, not one per frame
+	fallbackLookups++;
+	Profiler::Get().Counter("Shader fallback lookups", fallbackLookups);
+	GLint location = glGetUniformLocation(ID, name.name);
+	uniforms.insert(it, { name.hash, location, GL_NONE, 0 });
+	return location;
+}
+
+// Typed uniform setters (the program must be active)
+void Shader::SetInt(UniformName name, GLint value)
+{
+	glUniform1i(UniformLocation(name), value);
+}
+
+void Shader::SetFloat(UniformName name, GLfloat value)
+{
+	glUniform1f(UniformLocation(name), value);
+}
+
+void Shader::SetVec3(UniformName name, const glm::vec3 &value)
+{
+	glUniform3fv(UniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec4(UniformName name, const glm::vec4 &value)
+{
+	glUniform4fv(UniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(UniformName name, const glm::mat4 &value)
+{
+	glUniformMatrix4fv(UniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+// Fills the uniform table from glGetActiveUniform
+void Shader::reflectUniforms()
+{
+	uniforms.clear();
+
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		Uniform uniform;
+		glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &uniform.size, &uniform.type, name.data());
+
+		// Uniform block members have no location and are not set through glUniform*
+		uniform.location = glGetUniformLocation(ID, name.data());
+		if (uniform.location < 0)
+			continue;
+
+		uniform.hash = hash_uniform_name(name.data());
+		uniforms.push_back(uniform);
+
+		// Arrays are reported as "name[0]"; make the plain name resolve too
+		if (length > 3 && std::string(name.data() + length - 3) == "[0]")
+		{
+			name[length - 3] = '\0';
+			uniform.hash = hash_uniform_name(name.data());
+			uniforms.push_back(uniform);
+		}
+	}
+
+	std::sort(uniforms.begin(), uniforms.end(), [](const Uniform &a, const Uniform &b) { return a.hash < b.hash; });
+
+	for (size_t i = 1; i < uniforms.size(); i++)
+	{
+		if (uniforms[i].hash == uniforms[i - 1].hash && uniforms[i].location != uniforms[i - 1].location)
+			std::cerr << "Uniform name hash collision in program " << ID << std::endl;
+	}
+}
+
+// Checks for compilation errors, returns true if there were none
+bool Shader::compileErrors(unsigned int shader, const char *type)
 {
 	GLint hasCompiled;
 	char infoLog[1024];
@@ -105,4 +224,5 @@ void Shader::compileErrors(unsigned int shader, const char *type)
 					  << infoLog << std::endl;
 		}
 	}
+	return hasCompiled == GL_TRUE;
 }
\ No newline at end of file
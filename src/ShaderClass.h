@@ -7,14 +7,49 @@
 #include <sstream>
 #include <iostream>
 #include <cerrno>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
 
 std::string get_file_contents(const char* filename);
 
+// 32-bit FNV-1a hash of a uniform name, usable at compile time
+constexpr uint32_t hash_uniform_name(const char* name, uint32_t hash = 2166136261u) {
+	return *name ? hash_uniform_name(name + 1, (hash ^ (uint32_t)(unsigned char)*name) * 16777619u) : hash;
+}
+
+// Uniform name with its precomputed hash; string literals convert implicitly,
+// and constexpr instances (or the _uniform literal) are hashed at compile time
+struct UniformName {
+	const char* name;
+	uint32_t hash;
+
+	constexpr UniformName(const char* name) : name(name), hash(hash_uniform_name(name)) {}
+};
+
+constexpr UniformName operator""_uniform(const char* name, size_t) {
+	return UniformName(name);
+}
+
 class Shader {
 public:
+	// Active uniform reflected after linking
+	struct Uniform {
+		uint32_t hash;
+		GLint location;
+		GLenum type;
+		GLint size;
+	};
+
 	// Reference ID of the Shader Program
 	GLuint ID;
 
+	// Active uniforms sorted by name hash
+	std::vector<Uniform> uniforms;
+
+	// Number of uniform lookups (across all shaders) that missed the reflected table and went to the driver
+	static unsigned int fallbackLookups;
+
 	// Constructor that builds the Shader Program from 2 different shaders
 	Shader(const char* vertexFile, const char* fragmentFile);
 
@@ -24,9 +59,22 @@ public:
 	// Delete the shader program
 	void Delete();
 
+	// Returns the location of a uniform from the reflected table (-1 if it does not exist)
+	GLint UniformLocation(UniformName name);
+
+	// Typed uniform setters (the program must be active)
+	void SetInt(UniformName name, GLint value);
+	void SetFloat(UniformName name, GLfloat value);
+	void SetVec3(UniformName name, const glm::vec3& value);
+	void SetVec4(UniformName name, const glm::vec4& value);
+	void SetMat4(UniformName name, const glm::mat4& value);
+
 private:
-	// Checks for compilation errors
-	void compileErrors(unsigned int shader, const char* type);
+	// Fills the uniform table from glGetActiveUniform
+	void reflectUniforms();
+
+	// Checks for compilation errors, returns true if there were none
+	bool compileErrors(unsigned int shader, const char* type);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <iostream>
+
+// Picks Persistent when glBufferStorage is available
+StreamBuffer::Mode StreamBuffer::BestMode() {
+	// glad leaves the pointer null when the context is older than 4.4
+	return glBufferStorage ? Mode::Persistent : Mode::Orphaning;
+}
+
+// Constructor that creates framesInFlight sections of bytesPerFrame each
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr bytesPerFrame, int framesInFlight, Mode mode)
+	: target(target), mode(mode), sectionSize(bytesPerFrame), sectionCount(framesInFlight < 1 ? 1 : framesInFlight) {
+	glGenBuffers(1, &ID);
+	Bind();
+
+	if (mode == Mode::Persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, sectionSize * sectionCount, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(target, 0, sectionSize * sectionCount, flags);
+		fences.assign(sectionCount, (GLsync)0);
+		if (!mapped) {
+			std::cerr << "StreamBuffer: persistent mapping failed" << std::endl;
+		}
+	}
+	else {
+		// The driver's renaming replaces the sections: one frame of storage, reallocated every frame
+		sectionCount = 1;
+		glBufferData(target, sectionSize, NULL, GL_STREAM_DRAW);
+		shadow.resize(sectionSize);
+	}
+}
+
+// Moves to the next section, waiting for the GPU if it is still reading it
+void StreamBuffer::BeginFrame() {
+	PROFILE_ZONE("StreamBuffer::BeginFrame");
+	section = (section + 1) % sectionCount;
+	cursor = 0;
+	flushed = 0;
+	stats.frames++;
+
+	if (mode == Mode::Orphaning) {
+		// Orphan: in-flight draws keep the old storage, the new frame gets fresh memory
+		Bind();
+		glBufferData(target, sectionSize, NULL, GL_STREAM_DRAW);
+		return;
+	}
+
+	GLsync& fence = fences[section];
+	if (!fence) {
+		return;
+	}
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+		// The GPU is more than framesInFlight frames behind: block until it frees the section
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+		}
+		stats.fenceWaits++;
+		stats.fenceWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	glDeleteSync(fence);
+	fence = 0;
+}
+
+// Returns size bytes (aligned to alignment) from the current section; data is null if it is full
+StreamBuffer::Allocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment) {
+	// Aligns the offset into the whole buffer, not just into the section: bytesPerFrame needn't be a
+	// multiple of the alignment, so later sections can start anywhere
+	GLintptr base = sectionSize * section;
+	GLsizeiptr start = alignment > 1 ? (base + cursor + alignment - 1) / alignment * alignment - base : cursor;
+	if (start + size > sectionSize) {
+		stats.failedAllocations++;
+		Allocation none = { nullptr, ID, 0, 0 };
+		return none;
+	}
+	cursor = start + size;
+	stats.allocations++;
+	stats.bytesAllocated += size;
+	if ((size_t)cursor > stats.peakFrameBytes) {
+		stats.peakFrameBytes = cursor;
+	}
+
+	GLintptr offset = base + start;
+	Allocation allocation = { mode == Mode::Persistent ? mapped + offset : shadow.data() + start, ID, offset, size };
+	return allocation;
+}
+
+// Makes the frame's writes so far visible to the GPU (only does work when orphaning)
+void StreamBuffer::Flush() {
+	// Coherent persistent mappings need nothing: the next draw sees the writes
+	if (mode == Mode::Persistent || cursor == flushed) {
+		return;
+	}
+	Bind();
+	glBufferSubData(target, flushed, cursor - flushed, shadow.data() + flushed);
+	flushed = cursor;
+}
+
+// Fences the current section so it is reused only once the GPU is done with it
+void StreamBuffer::EndFrame() {
+	Flush();
+	if (mode == Mode::Persistent) {
+		fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	Profiler::Get().Counter("StreamBuffer bytes", (double)cursor);
+}
+
+// Binds the buffer to its target
+void StreamBuffer::Bind() {
+	GLState::Get().BindBuffer(target, ID);
+}
+
+// Binds part of the buffer to an indexed target
+void StreamBuffer::BindRange(GLuint index, const Allocation& allocation) {
+	GLState::Get().BindBufferRange(target, index, ID, allocation.offset, allocation.size);
+}
+
+// Unmaps and deletes the buffer
+void StreamBuffer::Delete() {
+	for (GLsync fence : fences) {
+		if (fence) {
+			glDeleteSync(fence);
+		}
+	}
+	fences.clear();
+	if (mapped) {
+		Bind();
+		glUnmapBuffer(target);
+		mapped = nullptr;
+	}
+	GLState::Get().DeleteBuffer(ID);
+	glDeleteBuffers(1, &ID);
+}
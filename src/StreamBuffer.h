@@ -0,0 +1,88 @@
+#ifndef STREAM_BUFFER_CLASS_H
+#define STREAM_BUFFER_CLASS_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Ring buffer for data rewritten every frame (dynamic vertices, instance transforms, uniform blocks).
+// With GL 4.4 / ARB_buffer_storage the whole ring is mapped once, persistently and coherently, and
+// split into one section per frame in flight; a fence per section makes sure the CPU never writes
+// into memory the GPU is still reading, so allocations are a pointer bump with no driver call.
+// On older contexts it falls back to orphaning: writes land in a CPU copy that Flush() uploads
+// into storage the driver renames each frame.
+class StreamBuffer {
+public:
+	enum class Mode {
+		Persistent,
+		Orphaning
+	};
+
+	// Region handed out by Allocate; write through data, draw from buffer at offset
+	struct Allocation {
+		void* data;
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// Totals since construction (or ResetStats)
+	struct Stats {
+		unsigned int frames = 0;
+		unsigned int allocations = 0;
+		size_t bytesAllocated = 0;
+		unsigned int failedAllocations = 0;   // didn't fit in the frame's section
+		unsigned int fenceWaits = 0;          // frames that had to wait for the GPU
+		double fenceWaitMs = 0.0;
+		size_t peakFrameBytes = 0;
+	};
+
+	// Reference ID of the buffer
+	GLuint ID;
+
+	// Picks Persistent when glBufferStorage is available
+	static Mode BestMode();
+
+	// Constructor that creates framesInFlight sections of bytesPerFrame each
+	StreamBuffer(GLenum target, GLsizeiptr bytesPerFrame, int framesInFlight = 3, Mode mode = BestMode());
+
+	// Moves to the next section, waiting for the GPU if it is still reading it
+	void BeginFrame();
+
+	// Returns size bytes (aligned to alignment) from the current section; data is null if it is full
+	Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 256);
+
+	// Makes the frame's writes so far visible to the GPU (only does work when orphaning)
+	void Flush();
+
+	// Fences the current section so it is reused only once the GPU is done with it
+	void EndFrame();
+
+	// Binds the buffer to its target
+	void Bind();
+
+	// Binds part of the buffer to an indexed target (GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER)
+	void BindRange(GLuint index, const Allocation& allocation);
+
+	Mode GetMode() const { return mode; }
+
+	Stats stats;
+	void ResetStats() { stats = Stats(); }
+
+	// Unmaps and deletes the buffer
+	void Delete();
+
+private:
+	GLenum target;
+	Mode mode;
+	GLsizeiptr sectionSize;
+	int sectionCount;
+	int section = 0;
+	GLsizeiptr cursor = 0;
+	GLsizeiptr flushed = 0;
+	unsigned char* mapped = nullptr;
+	std::vector<unsigned char> shadow;
+	std::vector<GLsync> fences;
+};
+
+#endif
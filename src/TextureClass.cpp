@@ -1,25 +1,93 @@
 #include "TextureClass.h"
+#include "CookedTexture.h"
+#include "Profiler.h"
+#include "GLState.h"
+
+#include <algorithm>
 
 Texture::Texture(const char *image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
 {
 	// Set texture type
 	type = texType;
 
-	// Load image
-	int widthImg, heightImg, numColCh;
-	stbi_set_flip_vertically_on_load(true); // Flip image on y-axis
-	unsigned char *bytes = stbi_load(image, &widthImg, &heightImg, &numColCh, STBI_rgb_alpha);
-	if (!bytes)
+	// Cooked textures (.ctex from the AssetCooker) already hold GPU-compressed blocks and their mip chain
+	CookedTexture cooked;
+	bool isCooked = IsCookedTexturePath(image);
+	if (isCooked && !ReadCookedTexture(image, cooked))
 	{
 		std::cerr << "Failed to load texture: " << image << std::endl;
+		isCooked = false;
+	}
+	else if (isCooked && !IsCompressedFormatSupported(cooked.header.glFormat))
+	{
+		std::cerr << "Failed to load texture: " << image << " (compressed format 0x" << std::hex
+			<< cooked.header.glFormat << std::dec << " is not supported)" << std::endl;
+		isCooked = false;
+	}
+
+	// Load image (stb can't read .ctex files, so a cooked texture that failed above skips this)
+	int widthImg = 0, heightImg = 0, numColCh;
+	unsigned char *bytes = nullptr;
+	if (!isCooked && !IsCookedTexturePath(image))
+	{
+		stbi_set_flip_vertically_on_load(true); // Flip image on y-axis
+		bytes = stbi_load(image, &widthImg, &heightImg, &numColCh, STBI_rgb_alpha);
+		if (!bytes)
+		{
+			std::cerr << "Failed to load texture: " << image << std::endl;
+		}
+	}
+
+	// Anything that failed to load gets a 2x2 grey checker, so the texture is always complete
+	static const unsigned char placeholder[] = {
+		160, 160, 160, 255,  96,  96,  96, 255,
+		 96,  96,  96, 255, 160, 160, 160, 255
+	};
+	const unsigned char *pixels = bytes;
+	if (!isCooked && !bytes)
+	{
+		pixels = placeholder;
+		widthImg = heightImg = 2;
+		format = GL_RGBA;
+		pixelType = GL_UNSIGNED_BYTE;
+	}
+
+	if (GLState::Get().DirectStateAccess())
+	{
+		// Created, configured and filled by name. The unit is still made active, as on the bind path,
+		// so a later Bind() lands on slot whichever path built the texture
+		glCreateTextures(texType, 1, &ID);
+		GLState::Get().ActiveTexture(slot);
+		glTextureParameteri(ID, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(ID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTextureParameteri(ID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(ID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		if (isCooked)
+		{
+			StoreCookedTexture(ID, cooked);
+		}
+		else
+		{
+			// Immutable storage for the full mip chain, filled from level 0
+			GLsizei levels = 1;
+			while ((std::max(widthImg, heightImg) >> levels) > 0)
+				levels++;
+			glTextureStorage2D(ID, levels, GL_RGBA8, widthImg, heightImg);
+			glTextureSubImage2D(ID, 0, 0, 0, widthImg, heightImg, format, pixelType, pixels);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glGenerateTextureMipmap(ID);
+			stbi_image_free(bytes);
+		}
+		return;
 	}
 
 	// Generate texture
 	glGenTextures(1, &ID);
 
 	// Assign texture to a Texture Unit
-	glActiveTexture(slot);
-	glBindTexture(texType, ID);
+	GLState::Get().ActiveTexture(slot);
+	GLState::Get().BindTexture(texType, ID);
 
 	// Set texture parameters
 	glTexParameteri(texType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -32,40 +100,56 @@ Texture::Texture(const char *image, GLenum texType, GLenum slot, GLenum format,
 	// float flatColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	// glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, flatColor);
 
-	// Assigns the image to the OpenGL Texture object
-	glTexImage2D(texType, 0, GL_RGBA, widthImg, heightImg, 0, format, pixelType, bytes);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glGenerateMipmap(texType);
+	if (isCooked)
+	{
+		// Uploads the precomputed mip chain as-is (the cooker already flipped the image)
+		UploadCookedTexture(texType, cooked);
+	}
+	else
+	{
+		// Assigns the image to the OpenGL Texture object
+		glTexImage2D(texType, 0, GL_RGBA, widthImg, heightImg, 0, format, pixelType, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glGenerateMipmap(texType);
 
-	// Free image memory
-	stbi_image_free(bytes);
+		// Free image memory
+		stbi_image_free(bytes);
+	}
 
 	// Unbind texture
-	glBindTexture(texType, 0);
+	GLState::Get().BindTexture(texType, 0);
+}
+
+// Constructor that wraps an existing texture object (e.g. one created by TextureLoader)
+Texture::Texture(GLuint ID, GLenum texType)
+{
+	Texture::ID = ID;
+	type = texType;
 }
 
 // Assigns a texture unit to a uniform sampler
-void Texture::texUnit(Shader &shader, const char *uniform, GLuint unit)
+void Texture::texUnit(Shader &shader, UniformName uniform, GLuint unit)
 {
-	GLuint texUni = glGetUniformLocation(shader.ID, uniform);
 	shader.Activate();
-	glUniform1i(texUni, unit);
+	shader.SetInt(uniform, unit);
 }
 
 // Binds the texture
 void Texture::Bind()
 {
-	glBindTexture(type, ID);
+	PROFILE_ZONE("Texture::Bind");
+	GLState::Get().BindTexture(type, ID);
 }
 
 // Unbinds the texture
 void Texture::Unbind()
 {
-	glBindTexture(type, 0);
+	GLState::Get().BindTexture(type, 0);
 }
 
 // Deletes the texture
 void Texture::Delete()
 {
+	GLState::Get().DeleteTexture(ID);
 	glDeleteTextures(1, &ID);
 }
\ No newline at end of file
@@ -11,10 +11,14 @@ public:
 	GLuint ID;
 	GLenum type;
 
+	// Constructor that loads an image (or a cooked .ctex texture, uploaded compressed) into a new texture
 	Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
 
+	// Constructor that wraps an existing texture object (e.g. one created by TextureLoader)
+	Texture(GLuint ID, GLenum texType);
+
 	// Assigns a texture unit to a uniform sampler
-	void texUnit(Shader& shader, const char* uniform, GLuint unit);
+	void texUnit(Shader& shader, UniformName uniform, GLuint unit);
 
 	// Binds the texture
 	void Bind();
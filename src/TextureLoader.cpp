@@ -0,0 +1,267 @@
+#include "TextureLoader.h"
+#include "Profiler.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+AsyncTexture::AsyncTexture(const std::string& path, GLuint placeholderID)
+	: texture(placeholderID, GL_TEXTURE_2D), path(path) {
+}
+
+// Constructor that starts the decode workers and creates the placeholder texture and PBO ring
+TextureLoader::TextureLoader(unsigned int threadCount, size_t uploadBudgetPerFrame, int pboCount)
+	: pool(threadCount), uploadBudget(uploadBudgetPerFrame) {
+	// 2x2 grey checker shown while the real image streams in
+	const unsigned char placeholder[] = {
+		160, 160, 160, 255,  96,  96,  96, 255,
+		 96,  96,  96, 255, 160, 160, 160, 255
+	};
+	glGenTextures(1, &placeholderID);
+	GLState::Get().BindTexture(GL_TEXTURE_2D, placeholderID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+
+	// Ring of staging buffers; each holds a slice of the frame budget and is reused once its fence signals
+	size_t capacity = std::max(uploadBudget / std::max(pboCount, 1), (size_t)4096);
+	pixelBuffers.resize(std::max(pboCount, 1));
+	for (PixelBuffer& buffer : pixelBuffers) {
+		glGenBuffers(1, &buffer.ID);
+		GLState::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+		buffer.capacity = capacity;
+		buffer.fence = 0;
+	}
+	GLState::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// Starts loading an RGBA texture; the handle is usable immediately
+TextureHandle TextureLoader::Load(const char* image, Callback onComplete) {
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->handle = std::make_shared<AsyncTexture>(image, placeholderID);
+	job->onComplete = onComplete;
+	loading++;
+
+	pool.Submit([this, job]() {
+		decode(*job);
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decoded.push_back(job);
+	});
+	return job->handle;
+}
+
+// Uploads decoded images within the per-frame budget and finalizes finished ones
+void TextureLoader::Update() {
+	PROFILE_ZONE("TextureLoader::Update");
+	bytesUploadedLastFrame = 0;
+
+	// Collect everything the workers finished since last frame
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		for (std::shared_ptr<Job>& job : decoded) {
+			if (job->decoded) {
+				job->handle->state = AsyncTexture::Uploading;
+				uploads.push_back(job);
+			}
+			else {
+				complete(*job, false);
+			}
+		}
+		decoded.clear();
+	}
+
+	// Stream as many rows as the budget and the free staging buffers allow
+	size_t budget = uploadBudget;
+	while (!uploads.empty() && budget > 0) {
+		Job& job = *uploads.front();
+		if (!uploadChunk(job, budget)) {
+			break;
+		}
+		if (job.level == job.image.levels.size()) {
+			// All levels submitted; it becomes resident once the GPU has consumed the uploads
+			job.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			finishing.push_back(uploads.front());
+			uploads.pop_front();
+		}
+	}
+	bytesUploadedTotal += bytesUploadedLastFrame;
+
+	// Swap in textures whose uploads have completed, without waiting on the GPU
+	for (size_t i = 0; i < finishing.size();) {
+		Job& job = *finishing[i];
+		if (glClientWaitSync(job.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+			i++;
+			continue;
+		}
+		glDeleteSync(job.fence);
+		job.fence = 0;
+		complete(job, true);
+		finishing.erase(finishing.begin() + i);
+	}
+
+	Profiler::Get().Counter("Texture upload bytes", (double)bytesUploadedLastFrame);
+}
+
+// Returns true while any texture is still loading
+bool TextureLoader::IsBusy() {
+	return loading > 0;
+}
+
+// Blocks until every queued texture is resident or failed
+void TextureLoader::Finish() {
+	while (IsBusy()) {
+		Update();
+		if (IsBusy()) {
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	}
+}
+
+// Deletes the placeholder, the PBO ring and any textures that never finished
+void TextureLoader::Delete() {
+	pool.WaitIdle();
+	decoded.clear();
+	for (std::deque<std::shared_ptr<Job>>::iterator it = uploads.begin(); it != uploads.end(); ++it) {
+		if ((*it)->textureID) {
+			GLState::Get().DeleteTexture((*it)->textureID);
+			glDeleteTextures(1, &(*it)->textureID);
+		}
+	}
+	uploads.clear();
+	for (std::shared_ptr<Job>& job : finishing) {
+		glDeleteSync(job->fence);
+		GLState::Get().DeleteTexture(job->textureID);
+		glDeleteTextures(1, &job->textureID);
+	}
+	finishing.clear();
+
+	for (PixelBuffer& buffer : pixelBuffers) {
+		if (buffer.fence) {
+			glDeleteSync(buffer.fence);
+		}
+		GLState::Get().DeleteBuffer(buffer.ID);
+		glDeleteBuffers(1, &buffer.ID);
+	}
+	pixelBuffers.clear();
+	GLState::Get().DeleteTexture(placeholderID);
+	glDeleteTextures(1, &placeholderID);
+}
+
+// Decodes the image and builds its mip chain (worker thread)
+void TextureLoader::decode(Job& job) {
+	PROFILE_ZONE("Decode texture");
+
+	int width, height, numColCh;
+	stbi_set_flip_vertically_on_load_thread(true); // Flip image on y-axis, like Texture does
+	unsigned char* bytes = stbi_load(job.handle->path.c_str(), &width, &height, &numColCh, STBI_rgb_alpha);
+	if (!bytes) {
+		std::cerr << "Failed to load texture: " << job.handle->path << std::endl;
+		return;
+	}
+
+	job.image = BuildMipChain(bytes, width, height);
+	stbi_image_free(bytes);
+
+	job.handle->width = width;
+	job.handle->height = height;
+	job.decoded = true;
+}
+
+// Copies the next rows of the job through a staging buffer; returns false if no buffer is free
+bool TextureLoader::uploadChunk(Job& job, size_t& budget) {
+	PixelBuffer& buffer = pixelBuffers[nextPixelBuffer];
+	if (buffer.fence) {
+		// Still being read by the GPU: stop for this frame instead of stalling
+		if (glClientWaitSync(buffer.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+			return false;
+		}
+		glDeleteSync(buffer.fence);
+		buffer.fence = 0;
+	}
+
+	// Create the real texture with storage for every level on its first chunk
+	if (job.textureID == 0) {
+		glGenTextures(1, &job.textureID);
+		GLState::Get().BindTexture(GL_TEXTURE_2D, job.textureID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)job.image.levels.size() - 1);
+		for (size_t l = 0; l < job.image.levels.size(); l++) {
+			glTexImage2D(GL_TEXTURE_2D, (GLint)l, GL_RGBA8, job.image.levels[l].width, job.image.levels[l].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+	else {
+		GLState::Get().BindTexture(GL_TEXTURE_2D, job.textureID);
+	}
+
+	// As many rows as fit in the staging buffer and the remaining budget (at least one row)
+	const MipChain::Level& level = job.image.levels[job.level];
+	size_t rowBytes = (size_t)level.width * 4;
+	size_t maxRows = std::max(std::min(budget, buffer.capacity) / rowBytes, (size_t)1);
+	int rows = (int)std::min(maxRows, (size_t)(level.height - job.row));
+	size_t bytes = rowBytes * rows;
+
+	GLState::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+	if (bytes > buffer.capacity) {
+		// A single row wider than the buffer: grow it (the old storage is orphaned)
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+		buffer.capacity = bytes;
+	}
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (mapped) {
+		std::memcpy(mapped, job.image.pixels.data() + level.offset + rowBytes * job.row, bytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glTexSubImage2D(GL_TEXTURE_2D, (GLint)job.level, 0, job.row, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	}
+	else {
+		// Mapping failed (out of memory?): fall back to a direct upload
+		GLState::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glTexSubImage2D(GL_TEXTURE_2D, (GLint)job.level, 0, job.row, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+			job.image.pixels.data() + level.offset + rowBytes * job.row);
+	}
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	GLState::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+	nextPixelBuffer = (nextPixelBuffer + 1) % pixelBuffers.size();
+
+	budget = bytes >= budget ? 0 : budget - bytes;
+	bytesUploadedLastFrame += bytes;
+
+	job.row += rows;
+	if (job.row == level.height) {
+		job.row = 0;
+		job.level++;
+	}
+	return true;
+}
+
+// Finalizes a job on the GL thread and runs its callback
+void TextureLoader::complete(Job& job, bool success) {
+	AsyncTexture& texture = *job.handle;
+	if (success) {
+		texture.texture.ID = job.textureID;
+		texture.state = AsyncTexture::Resident;
+		completed++;
+	}
+	else {
+		texture.state = AsyncTexture::Failed;
+		failed++;
+	}
+	loading--;
+
+	// Nobody else holds the handle anymore, so nobody will ever delete the texture
+	if (success && job.handle.use_count() == 1 && !job.onComplete) {
+		texture.texture.Delete();
+	}
+
+	if (job.onComplete) {
+		job.onComplete(texture);
+	}
+	job.image = MipChain();
+}
@@ -0,0 +1,115 @@
+#ifndef TEXTURE_LOADER_CLASS_H
+#define TEXTURE_LOADER_CLASS_H
+
+#include <glad/glad.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MipChain.h"
+#include "TextureClass.h"
+#include "ThreadPool.h"
+
+// Texture being streamed in by a TextureLoader
+class AsyncTexture {
+public:
+	enum State {
+		Loading,   // decoding on a worker thread
+		Uploading, // decoded, being copied to the GPU a few rows at a time
+		Resident,  // fully uploaded, texture.ID is the real texture
+		Failed     // could not be decoded, texture keeps pointing at the placeholder
+	};
+
+	// Bindable texture; wraps the shared placeholder until the real texture is resident
+	Texture texture;
+
+	// Source file and decoded size
+	std::string path;
+	int width = 0;
+	int height = 0;
+
+	State state = Loading;
+
+	AsyncTexture(const std::string& path, GLuint placeholderID);
+
+	// Returns true once the real texture is bound by texture.Bind()
+	bool IsResident() const { return state == Resident; }
+};
+
+typedef std::shared_ptr<AsyncTexture> TextureHandle;
+
+// Loads textures without blocking the GL thread: images are decoded (and mipmapped) on a
+// thread pool, then streamed to the GPU through a ring of pixel buffer objects guarded by
+// fences, with a per-frame byte budget so big batches don't cause frame hitches.
+class TextureLoader {
+public:
+	typedef std::function<void(AsyncTexture&)> Callback;
+
+	// Statistics
+	unsigned int loading = 0;
+	unsigned int completed = 0;
+	unsigned int failed = 0;
+	size_t bytesUploadedLastFrame = 0;
+	size_t bytesUploadedTotal = 0;
+
+	// Constructor that starts the decode workers and creates the placeholder texture and PBO ring
+	TextureLoader(unsigned int threadCount = 0, size_t uploadBudgetPerFrame = 8 << 20, int pboCount = 4);
+
+	// Starts loading an RGBA texture; the handle is usable (bound to the placeholder) immediately
+	// and onComplete runs on the GL thread inside Update() once it is resident (or has failed)
+	TextureHandle Load(const char* image, Callback onComplete = nullptr);
+
+	// Uploads decoded images within the per-frame budget and finalizes finished ones (GL thread, once per frame)
+	void Update();
+
+	// Returns true while any texture is still loading
+	bool IsBusy();
+
+	// Blocks until every queued texture is resident or failed (e.g. behind a loading screen)
+	void Finish();
+
+	// Deletes the placeholder, the PBO ring and any textures that never finished
+	void Delete();
+
+private:
+	// Work item shared between the worker threads and the GL thread
+	struct Job {
+		TextureHandle handle;
+		Callback onComplete;
+		MipChain image;
+		bool decoded = false;
+
+		// Upload progress (GL thread only)
+		GLuint textureID = 0;
+		size_t level = 0;
+		int row = 0;
+		GLsync fence = 0;
+	};
+
+	struct PixelBuffer {
+		GLuint ID;
+		size_t capacity;
+		GLsync fence;
+	};
+
+	ThreadPool pool;
+	size_t uploadBudget;
+	GLuint placeholderID = 0;
+
+	std::vector<PixelBuffer> pixelBuffers;
+	size_t nextPixelBuffer = 0;
+
+	std::mutex decodedMutex;
+	std::vector<std::shared_ptr<Job>> decoded;
+	std::deque<std::shared_ptr<Job>> uploads;
+	std::vector<std::shared_ptr<Job>> finishing;
+
+	void decode(Job& job);
+	bool uploadChunk(Job& job, size_t& budget);
+	void complete(Job& job, bool success);
+};
+
+#endif
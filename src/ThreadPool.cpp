@@ -0,0 +1,108 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+// Constructor that starts the workers (0 = one per hardware thread, minus the calling thread)
+ThreadPool::ThreadPool(unsigned int threadCount) {
+	if (threadCount == 0) {
+		unsigned int hardware = std::thread::hardware_concurrency();
+		threadCount = hardware > 1 ? hardware - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+// Waits for queued jobs to finish and joins the workers
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+// Queues a job to run on a worker thread
+void ThreadPool::Submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+// Blocks until the queue is empty and no job is running
+void ThreadPool::WaitIdle() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+// Runs function(begin, end) over [0, count) in chunks on the workers and the calling thread
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& function) {
+	if (count == 0) {
+		return;
+	}
+	grain = std::max(grain, (size_t)1);
+	const size_t chunks = (count + grain - 1) / grain;
+
+	// Chunks are claimed dynamically so uneven work still balances across threads
+	struct Progress {
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	std::shared_ptr<Progress> progress = std::make_shared<Progress>();
+	const std::function<void(size_t, size_t)>* body = &function;
+
+	std::function<void()> work = [progress, body, chunks, count, grain]() {
+		size_t chunk;
+		while ((chunk = progress->next++) < chunks) {
+			(*body)(chunk * grain, std::min(count, (chunk + 1) * grain));
+			if (++progress->done == chunks) {
+				std::lock_guard<std::mutex> lock(progress->mutex);
+				progress->finished.notify_all();
+			}
+		}
+	};
+
+	size_t helpers = std::min((size_t)workers.size(), chunks - 1);
+	for (size_t i = 0; i < helpers; i++) {
+		Submit(work);
+	}
+	work();
+
+	std::unique_lock<std::mutex> lock(progress->mutex);
+	progress->finished.wait(lock, [&] { return progress->done == chunks; });
+}
+
+void ThreadPool::workerLoop() {
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			running++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running--;
+			if (jobs.empty() && running == 0) {
+				idle.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_CLASS_H
+#define THREAD_POOL_CLASS_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads executing queued jobs in FIFO order
+class ThreadPool {
+public:
+	// Constructor that starts the workers (0 = one per hardware thread, minus the calling thread)
+	ThreadPool(unsigned int threadCount = 0);
+
+	// Waits for queued jobs to finish and joins the workers
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Queues a job to run on a worker thread
+	void Submit(std::function<void()> job);
+
+	// Blocks until the queue is empty and no job is running
+	void WaitIdle();
+
+	// Runs function(begin, end) over [0, count) in chunks of grain items on the workers and the
+	// calling thread, and returns once every chunk is done
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& function);
+
+	// Number of worker threads
+	unsigned int Size() const { return (unsigned int)workers.size(); }
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable idle;
+	unsigned int running = 0;
+	bool stopping = false;
+
+	void workerLoop();
+};
+
+#endif
@@ -1,29 +1,52 @@
 #include "VAO.h"
+#include "GLState.h"
 
 // Constructor that generates a Vertex Array Object
 VAO::VAO() {
-	glGenVertexArrays(1, &ID);
+	if (GLState::Get().DirectStateAccess()) {
+		glCreateVertexArrays(1, &ID);
+	}
+	else {
+		glGenVertexArrays(1, &ID);
+	}
 }
 
 // Links a VBO Attribute to the VAO using a certain layout
 void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset) {
+	if (GLState::Get().DirectStateAccess()) {
+		// Binding point = location, as glVertexAttribPointer does; stride 0 means tightly packed there
+		if (stride == 0) {
+			stride = (GLsizeiptr)VertexAttributeBytes({ layout, (GLint)numComponents, type, GL_FALSE, 0 });
+		}
+		glVertexArrayVertexBuffer(ID, layout, VBO.ID, (GLintptr)offset, (GLsizei)stride);
+		glVertexArrayAttribFormat(ID, layout, numComponents, type, GL_FALSE, 0);
+		glVertexArrayAttribBinding(ID, layout, layout);
+		glEnableVertexArrayAttrib(ID, layout);
+		return;
+	}
+	// The VBO stays bound afterwards so linking several attributes of one buffer binds it only once
 	VBO.Bind();
 	glVertexAttribPointer(layout, numComponents, type, GL_FALSE, stride, offset);
 	glEnableVertexAttribArray(layout);
-	VBO.Unbind();
+}
+
+// Links every attribute of a layout only known at run time
+void VAO::LinkFormat(const VertexFormat& format, VBO& VBO) {
+	format.Link(ID, VBO.ID);
 }
 
 // Binds the VAO
 void VAO::Bind() {
-	glBindVertexArray(ID);
+	GLState::Get().BindVertexArray(ID);
 }
 
 // Unbinds the VAO
 void VAO::Unbind() {
-	glBindVertexArray(0);
+	GLState::Get().BindVertexArray(0);
 }
 
 // Deletes the VAO
 void VAO::Delete() {
+	GLState::Get().DeleteVertexArray(ID);
 	glDeleteVertexArrays(1, &ID);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <glad/glad.h>
 #include "VBO.h"
+#include "VertexLayout.h"
 
 class VAO {
 public:
@@ -14,6 +15,16 @@ public:
 	// Links a VBO Attribute to the VAO using a certain layout
 	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
 
+	// Links every attribute of a vertex struct (see VertexLayout.h); stride, types and offsets
+	// come from the struct's declaration
+	template <typename Vertex>
+	void LinkVertex(VBO& VBO) {
+		VertexFormatOf<Vertex>().Link(ID, VBO.ID);
+	}
+
+	// Links every attribute of a layout only known at run time (e.g. read from a cooked mesh)
+	void LinkFormat(const VertexFormat& format, VBO& VBO);
+
 	// Binds the VAO
 	void Bind();
 
@@ -1,23 +1,47 @@
 #include "VBO.h"
+#include "GLState.h"
 
 // Constructor that generates a Vertex Buffer Object and links it to vertices
-VBO::VBO(GLfloat* vertices, GLsizeiptr size) {
+VBO::VBO(GLfloat* vertices, GLsizeiptr size) : VBO((const void*)vertices, size) {
+}
+
+// Constructor that generates a Vertex Buffer Object holding size bytes of any vertex data
+VBO::VBO(const void* data, GLsizeiptr size) {
+	if (GLState::Get().DirectStateAccess()) {
+		// Immutable storage that Update() can still write to
+		glCreateBuffers(1, &ID);
+		if (size > 0) {
+			glNamedBufferStorage(ID, size, data, GL_DYNAMIC_STORAGE_BIT);
+		}
+		return;
+	}
 	glGenBuffers(1, &ID);
-	glBindBuffer(GL_ARRAY_BUFFER, ID);
-	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, ID);
+	glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+}
+
+// Replaces size bytes of the buffer starting at offset
+void VBO::Update(GLintptr offset, GLsizeiptr size, const void* data) {
+	if (GLState::Get().DirectStateAccess()) {
+		glNamedBufferSubData(ID, offset, size, data);
+		return;
+	}
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, ID);
+	glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
 }
 
 // Binds the VBO
 void VBO::Bind() {
-	glBindBuffer(GL_ARRAY_BUFFER, ID);
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, ID);
 }
 
 // Unbinds the VBO
 void VBO::Unbind() {
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 // Deletes the VBO
 void VBO::Delete() {
+	GLState::Get().DeleteBuffer(ID);
 	glDeleteBuffers(1, &ID);
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define VBO_CLASS_H
 
 #include <glad/glad.h>
+#include <cstddef>
+#include <vector>
 
 class VBO {
 public:
@@ -11,6 +13,18 @@ public:
 	// Constructor that generates a Vertex Buffer Object and links it to vertices
 	VBO(GLfloat* vertices, GLsizeiptr size);
 
+	// Constructor that generates a Vertex Buffer Object holding size bytes of any vertex data
+	VBO(const void* data, GLsizeiptr size);
+
+	// Constructors that generate a Vertex Buffer Object from vertex structs (see VertexLayout.h)
+	template <typename Vertex, size_t N>
+	VBO(const Vertex (&vertices)[N]) : VBO((const void*)vertices, (GLsizeiptr)sizeof(vertices)) {}
+	template <typename Vertex>
+	VBO(const std::vector<Vertex>& vertices) : VBO((const void*)vertices.data(), (GLsizeiptr)(vertices.size() * sizeof(Vertex))) {}
+
+	// Replaces size bytes of the buffer starting at offset
+	void Update(GLintptr offset, GLsizeiptr size, const void* data);
+
 	// Binds the VBO
 	void Bind();
 
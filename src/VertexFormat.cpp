@@ -0,0 +1,35 @@
+#include "VertexFormat.h"
+#include "GLState.h"
+#include "VertexLayout.h"
+
+#include <cstddef>
+
+// Links every attribute of a buffer to the currently bound VAO
+void VertexFormat::Link(GLuint buffer) const {
+	GLState::Get().BindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (const VertexAttribute& attribute : attributes) {
+		glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized, stride, (void*)(size_t)attribute.offset);
+		glEnableVertexAttribArray(attribute.location);
+	}
+}
+
+// Links every attribute of a buffer to the given VAO
+void VertexFormat::Link(GLuint vertexArray, GLuint buffer) const {
+	if (!GLState::Get().DirectStateAccess()) {
+		GLState::Get().BindVertexArray(vertexArray);
+		Link(buffer);
+		return;
+	}
+	// One binding point per location, like glVertexAttribPointer, so VAOs can mix both kinds of link
+	for (const VertexAttribute& attribute : attributes) {
+		glVertexArrayVertexBuffer(vertexArray, attribute.location, buffer, (GLintptr)attribute.offset, stride);
+		glVertexArrayAttribFormat(vertexArray, attribute.location, attribute.components, attribute.type, attribute.normalized, 0);
+		glVertexArrayAttribBinding(vertexArray, attribute.location, attribute.location);
+		glEnableVertexArrayAttrib(vertexArray, attribute.location);
+	}
+}
+
+// The demo layout: position (3 floats), color (3 floats), UV (2 floats)
+VertexFormat VertexFormat::PositionColorUV() {
+	return VertexFormatOf<PositionColorUVVertex>();
+}
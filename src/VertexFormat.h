@@ -0,0 +1,32 @@
+#ifndef VERTEX_FORMAT_CLASS_H
+#define VERTEX_FORMAT_CLASS_H
+
+#include <glad/glad.h>
+#include <vector>
+
+// One vertex attribute inside an interleaved vertex
+struct VertexAttribute {
+	GLuint location;
+	GLint components;
+	GLenum type;
+	GLboolean normalized;
+	GLuint offset;  // bytes from the start of the vertex
+};
+
+// Interleaved vertex layout, used to link a buffer into a VAO
+struct VertexFormat {
+	GLsizei stride = 0;
+	std::vector<VertexAttribute> attributes;
+
+	// Links every attribute of a buffer to the currently bound VAO
+	void Link(GLuint buffer) const;
+
+	// Links every attribute of a buffer to the given VAO, by name when direct state access is
+	// available (the VAO is bound otherwise)
+	void Link(GLuint vertexArray, GLuint buffer) const;
+
+	// The demo layout: position (3 floats), color (3 floats), UV (2 floats)
+	static VertexFormat PositionColorUV();
+};
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "VertexFormat.h"
+
+// Compile-time vertex layouts. A vertex struct lists its attributes once:
+//
+//   struct MyVertex {
+//       glm::vec3 position;
+//       Unorm8x4 color;
+//       Half2 uv;
+//       static constexpr std::array<VertexAttribute, 3> Attributes() {
+//           return { { VERTEX_ATTRIBUTE(0, MyVertex, position),
+//                      VERTEX_ATTRIBUTE(1, MyVertex, color),
+//                      VERTEX_ATTRIBUTE(2, MyVertex, uv) } };
+//       }
+//   };
+//
+// and the GL type, component count, normalized flag and offset of every attribute, as well as the
+// stride, follow from the member types. VertexFormatOf<MyVertex>() turns it into a VertexFormat;
+// VBO and VAO accept such structs directly.
+
+// Two / four half floats (GL_HALF_FLOAT)
+struct Half2 {
+	uint32_t bits;
+	static Half2 FromFloat(const glm::vec2& value) { return { glm::packHalf2x16(value) }; }
+};
+struct Half4 {
+	uint16_t bits[4];
+	static Half4 FromFloat(const glm::vec4& value) {
+		uint32_t xy = glm::packHalf2x16(glm::vec2(value.x, value.y));
+		uint32_t zw = glm::packHalf2x16(glm::vec2(value.z, value.w));
+		return { { (uint16_t)xy, (uint16_t)(xy >> 16), (uint16_t)zw, (uint16_t)(zw >> 16) } };
+	}
+};
+
+// Three shorts read as [0, 1] (positions quantized within mesh bounds)
+struct Unorm16x3 {
+	uint16_t bits[3];
+	static Unorm16x3 FromFloat(const glm::vec3& value) {
+		glm::vec3 scaled = glm::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f);
+		return { { (uint16_t)scaled.x, (uint16_t)scaled.y, (uint16_t)scaled.z } };
+	}
+};
+
+// Two bytes / two shorts read as [-1, 1] (octahedral normals and tangents)
+struct Snorm8x2 {
+	int8_t bits[2];
+	static Snorm8x2 FromFloat(const glm::vec2& value) {
+		glm::vec2 scaled = glm::round(glm::clamp(value, -1.0f, 1.0f) * 127.0f);
+		return { { (int8_t)scaled.x, (int8_t)scaled.y } };
+	}
+};
+struct Snorm16x2 {
+	int16_t bits[2];
+	static Snorm16x2 FromFloat(const glm::vec2& value) {
+		glm::vec2 scaled = glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+		return { { (int16_t)scaled.x, (int16_t)scaled.y } };
+	}
+};
+
+// Four bytes read as [0, 1] (colors)
+struct Unorm8x4 {
+	uint32_t bits;
+	static Unorm8x4 FromFloat(const glm::vec4& value) { return { glm::packUnorm4x8(value) }; }
+};
+
+// Four bytes read as [-1, 1]
+struct Snorm8x4 {
+	uint32_t bits;
+	static Snorm8x4 FromFloat(const glm::vec4& value) { return { glm::packSnorm4x8(value) }; }
+};
+
+// x, y, z in 10 bits and w in 2, read as [-1, 1] (normals, tangents with a handedness sign)
+struct Snorm10_10_10_2 {
+	uint32_t bits;
+	static Snorm10_10_10_2 FromFloat(const glm::vec4& value) { return { glm::packSnorm3x10_1x2(value) }; }
+};
+
+// The same packing read as [0, 1]
+struct Unorm10_10_10_2 {
+	uint32_t bits;
+	static Unorm10_10_10_2 FromFloat(const glm::vec4& value) { return { glm::packUnorm3x10_1x2(value) }; }
+};
+
+// How each attribute type is handed to glVertexAttribPointer
+template <typename T>
+struct VertexAttributeTraits {
+	static_assert(sizeof(T) == 0, "Unsupported vertex attribute type");
+};
+
+#define VERTEX_ATTRIBUTE_TRAITS(T, COMPONENTS, TYPE, NORMALIZED) \
+	template <> \
+	struct VertexAttributeTraits<T> { \
+		static constexpr GLint components = COMPONENTS; \
+		static constexpr GLenum type = TYPE; \
+		static constexpr GLboolean normalized = NORMALIZED; \
+	};
+
+VERTEX_ATTRIBUTE_TRAITS(float, 1, GL_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(glm::vec2, 2, GL_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(glm::vec3, 3, GL_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(glm::vec4, 4, GL_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(Half2, 2, GL_HALF_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(Half4, 4, GL_HALF_FLOAT, GL_FALSE)
+VERTEX_ATTRIBUTE_TRAITS(Unorm16x3, 3, GL_UNSIGNED_SHORT, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm8x2, 2, GL_BYTE, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm16x2, 2, GL_SHORT, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Unorm8x4, 4, GL_UNSIGNED_BYTE, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm8x4, 4, GL_BYTE, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Snorm10_10_10_2, 4, GL_INT_2_10_10_10_REV, GL_TRUE)
+VERTEX_ATTRIBUTE_TRAITS(Unorm10_10_10_2, 4, GL_UNSIGNED_INT_2_10_10_10_REV, GL_TRUE)
+
+#undef VERTEX_ATTRIBUTE_TRAITS
+
+// Describes one member of type T at the given offset
+template <typename T>
+constexpr VertexAttribute MakeVertexAttribute(GLuint location, size_t offset) {
+	return { location, VertexAttributeTraits<T>::components, VertexAttributeTraits<T>::type, VertexAttributeTraits<T>::normalized, (GLuint)offset };
+}
+
+// Descriptor for Vertex::member bound to a shader location (use inside Vertex::Attributes())
+#define VERTEX_ATTRIBUTE(LOCATION, VERTEX, MEMBER) \
+	MakeVertexAttribute<std::remove_cv_t<decltype(VERTEX::MEMBER)>>(LOCATION, offsetof(VERTEX, MEMBER))
+
+// Size in bytes GL reads for an attribute
+constexpr size_t VertexAttributeBytes(const VertexAttribute& attribute) {
+	switch (attribute.type) {
+	case GL_INT_2_10_10_10_REV:
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+		return 4;
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:
+		return (size_t)attribute.components;
+	case GL_HALF_FLOAT:
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT:
+		return 2 * (size_t)attribute.components;
+	default:
+		return 4 * (size_t)attribute.components;
+	}
+}
+
+// True when every attribute lies inside the vertex and no two locations repeat
+template <typename Vertex>
+constexpr bool VertexLayoutIsValid() {
+	constexpr auto attributes = Vertex::Attributes();
+	for (size_t i = 0; i < attributes.size(); i++) {
+		if (attributes[i].offset + VertexAttributeBytes(attributes[i]) > sizeof(Vertex)) {
+			return false;
+		}
+		for (size_t j = i + 1; j < attributes.size(); j++) {
+			if (attributes[i].location == attributes[j].location) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Stride and attributes of a vertex struct, checked at compile time
+template <typename Vertex>
+VertexFormat VertexFormatOf() {
+	static_assert(std::is_standard_layout<Vertex>::value, "Vertex structs must be standard layout (offsetof)");
+	static_assert(VertexLayoutIsValid<Vertex>(), "Vertex attribute overruns the struct or reuses a location");
+
+	constexpr auto attributes = Vertex::Attributes();
+	VertexFormat format;
+	format.stride = (GLsizei)sizeof(Vertex);
+	format.attributes.assign(attributes.begin(), attributes.end());
+	return format;
+}
+
+// The demo vertex: position, color and UV as floats (32 bytes)
+struct PositionColorUVVertex {
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 uv;
+
+	static constexpr std::array<VertexAttribute, 3> Attributes() {
+		return { { VERTEX_ATTRIBUTE(0, PositionColorUVVertex, position),
+				   VERTEX_ATTRIBUTE(1, PositionColorUVVertex, color),
+				   VERTEX_ATTRIBUTE(2, PositionColorUVVertex, uv) } };
+	}
+};
+
+// The same attributes packed: float position, unorm8 color, half UV (20 bytes)
+struct PackedPositionColorUVVertex {
+	glm::vec3 position;
+	Unorm8x4 color;
+	Half2 uv;
+
+	static constexpr std::array<VertexAttribute, 3> Attributes() {
+		return { { VERTEX_ATTRIBUTE(0, PackedPositionColorUVVertex, position),
+				   VERTEX_ATTRIBUTE(1, PackedPositionColorUVVertex, color),
+				   VERTEX_ATTRIBUTE(2, PackedPositionColorUVVertex, uv) } };
+	}
+
+	// Packs a float vertex
+	static PackedPositionColorUVVertex FromFloat(const PositionColorUVVertex& vertex) {
+		return { vertex.position, Unorm8x4::FromFloat(glm::vec4(vertex.color, 1.0f)), Half2::FromFloat(vertex.uv) };
+	}
+};
+
+#endif
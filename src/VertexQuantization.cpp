@@ -0,0 +1,137 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Sets the dequantization uniforms on the active shader
+void QuantizedMesh::SetUniforms(Shader& shader) const {
+	shader.SetVec3("positionOffset"_uniform, boundsMin);
+	shader.SetVec3("positionScale"_uniform, boundsSize);
+}
+
+// Projects the normal onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the upper one
+glm::vec2 OctahedralEncode(const glm::vec3& normal) {
+	glm::vec3 n = normal / (std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z));
+	glm::vec2 encoded(n.x, n.y);
+	if (n.z < 0.0f) {
+		encoded.x = (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return encoded;
+}
+
+// Inverse of OctahedralEncode (quantized.vert has the same code in GLSL)
+glm::vec3 OctahedralDecode(const glm::vec2& encoded) {
+	glm::vec3 n(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+	float t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return glm::normalize(n);
+}
+
+// Tries the four codes around the encoded value and keeps the one that decodes closest
+template <typename Code, typename Component, int MAX>
+static Code octahedralNearest(const glm::vec3& normal) {
+	glm::vec3 unit = glm::normalize(normal);
+	glm::vec2 scaled = OctahedralEncode(unit) * (float)MAX;
+	glm::vec2 base = glm::floor(scaled);
+
+	Code best = {};
+	float bestDot = -2.0f;
+	for (int dy = 0; dy < 2; dy++) {
+		for (int dx = 0; dx < 2; dx++) {
+			glm::vec2 code = glm::clamp(base + glm::vec2((float)dx, (float)dy), -(float)MAX, (float)MAX);
+			float d = glm::dot(OctahedralDecode(code / (float)MAX), unit);
+			if (d > bestDot) {
+				bestDot = d;
+				best.bits[0] = (Component)code.x;
+				best.bits[1] = (Component)code.y;
+			}
+		}
+	}
+	return best;
+}
+
+// Octahedral normal rounded to snorm8
+Snorm8x2 OctahedralSnorm8(const glm::vec3& normal) {
+	return octahedralNearest<Snorm8x2, int8_t, 127>(normal);
+}
+
+// Octahedral normal rounded to snorm16
+Snorm16x2 OctahedralSnorm16(const glm::vec3& normal) {
+	return octahedralNearest<Snorm16x2, int16_t, 32767>(normal);
+}
+
+// Decodes a quantized vertex the way the vertex shader does
+MeshVertex DequantizeVertex(const QuantizedVertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsSize) {
+	MeshVertex decoded;
+	glm::vec3 position(vertex.position.bits[0], vertex.position.bits[1], vertex.position.bits[2]);
+	decoded.position = boundsMin + position / 65535.0f * boundsSize;
+	glm::vec2 normal(vertex.normal.bits[0], vertex.normal.bits[1]);
+	decoded.normal = OctahedralDecode(glm::max(normal / 32767.0f, glm::vec2(-1.0f)));
+	decoded.color = glm::unpackUnorm4x8(vertex.color.bits);
+	decoded.uv = glm::unpackHalf2x16(vertex.uv.bits);
+	return decoded;
+}
+
+// Quantizes a mesh and measures the error it introduced
+QuantizedMesh QuantizeMesh(const MeshVertex* vertices, size_t count) {
+	QuantizedMesh mesh;
+	if (count == 0) {
+		return mesh;
+	}
+
+	glm::vec3 boundsMax = vertices[0].position;
+	mesh.boundsMin = vertices[0].position;
+	for (size_t i = 1; i < count; i++) {
+		mesh.boundsMin = glm::min(mesh.boundsMin, vertices[i].position);
+		boundsMax = glm::max(boundsMax, vertices[i].position);
+	}
+	mesh.boundsSize = boundsMax - mesh.boundsMin;
+	// A flat axis still needs a non-zero scale to divide by
+	glm::vec3 divisor = glm::max(mesh.boundsSize, glm::vec3(1e-20f));
+
+	mesh.vertices.resize(count);
+	double squaredPositionError = 0.0;
+	QuantizationError& error = mesh.error;
+	for (size_t i = 0; i < count; i++) {
+		const MeshVertex& source = vertices[i];
+		QuantizedVertex& vertex = mesh.vertices[i];
+		vertex.position = Unorm16x3::FromFloat((source.position - mesh.boundsMin) / divisor);
+		vertex.padding = 0;
+		vertex.normal = OctahedralSnorm16(source.normal);
+		vertex.color = Unorm8x4::FromFloat(source.color);
+		vertex.uv = Half2::FromFloat(source.uv);
+
+		MeshVertex decoded = DequantizeVertex(vertex, mesh.boundsMin, mesh.boundsSize);
+		float positionError = glm::length(decoded.position - source.position);
+		squaredPositionError += (double)positionError * positionError;
+		error.maxPosition = std::max(error.maxPosition, positionError);
+		float cosine = glm::clamp(glm::dot(decoded.normal, glm::normalize(source.normal)), -1.0f, 1.0f);
+		error.maxNormalDegrees = std::max(error.maxNormalDegrees, glm::degrees(std::acos(cosine)));
+		glm::vec4 colorError = glm::abs(decoded.color - glm::clamp(source.color, 0.0f, 1.0f));
+		error.maxColor = std::max(error.maxColor, std::max(std::max(colorError.x, colorError.y), std::max(colorError.z, colorError.w)));
+		glm::vec2 uvError = glm::abs(decoded.uv - source.uv);
+		error.maxUV = std::max(error.maxUV, std::max(uvError.x, uvError.y));
+	}
+	error.rmsPosition = (float)std::sqrt(squaredPositionError / count);
+	float diagonal = glm::length(mesh.boundsSize);
+	error.maxPositionRelative = diagonal > 0.0f ? error.maxPosition / diagonal : 0.0f;
+	return mesh;
+}
+
+QuantizedMesh QuantizeMesh(const std::vector<MeshVertex>& vertices) {
+	return QuantizeMesh(vertices.data(), vertices.size());
+}
+
+// Prints one line per metric
+void PrintQuantizationReport(std::ostream& out, const char* name, const QuantizedMesh& mesh, size_t sourceVertexBytes) {
+	const QuantizationError& error = mesh.error;
+	size_t count = mesh.vertices.size();
+	out << "Quantization report: " << name << " (" << count << " vertices, " << sourceVertexBytes << " -> " << sizeof(QuantizedVertex) << " bytes per vertex, "
+		<< count * sourceVertexBytes / 1024 << " -> " << count * sizeof(QuantizedVertex) / 1024 << " KB)" << std::endl;
+	out << "  position  max " << error.maxPosition << " (" << error.maxPositionRelative * 100.0f << "% of bounds diagonal), rms " << error.rmsPosition << std::endl;
+	out << "  normal    max " << error.maxNormalDegrees << " degrees" << std::endl;
+	out << "  color     max " << error.maxColor << std::endl;
+	out << "  uv        max " << error.maxUV << std::endl;
+}
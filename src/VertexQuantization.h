@@ -0,0 +1,72 @@
+#ifndef VERTEX_QUANTIZATION_H
+#define VERTEX_QUANTIZATION_H
+
+#include <glm/glm.hpp>
+#include <ostream>
+#include <vector>
+
+#include "MeshData.h"
+#include "ShaderClass.h"
+#include "VertexLayout.h"
+
+// A MeshVertex in 20 bytes, read by quantized.vert:
+//   position  3 x unorm16 within the mesh bounds (dequantized with the positionOffset/positionScale uniforms)
+//   padding   2 bytes (zero), keeping the other attributes and the stride 4-byte aligned
+//   normal    octahedral, 2 x snorm16
+//   color     4 x unorm8
+//   uv        2 x half
+struct QuantizedVertex {
+	Unorm16x3 position;
+	uint16_t padding;
+	Snorm16x2 normal;
+	Unorm8x4 color;
+	Half2 uv;
+
+	static constexpr std::array<VertexAttribute, 4> Attributes() {
+		return { { VERTEX_ATTRIBUTE(0, QuantizedVertex, position),
+				   VERTEX_ATTRIBUTE(1, QuantizedVertex, color),
+				   VERTEX_ATTRIBUTE(2, QuantizedVertex, uv),
+				   VERTEX_ATTRIBUTE(7, QuantizedVertex, normal) } };
+	}
+};
+
+// Largest and RMS differences between a mesh and its quantized version
+struct QuantizationError {
+	float maxPosition = 0.0f;        // world units
+	float rmsPosition = 0.0f;
+	float maxPositionRelative = 0.0f; // maxPosition over the bounds diagonal
+	float maxNormalDegrees = 0.0f;
+	float maxColor = 0.0f;           // per channel, [0, 1] scale
+	float maxUV = 0.0f;
+};
+
+// A quantized mesh and what is needed to draw and judge it
+struct QuantizedMesh {
+	std::vector<QuantizedVertex> vertices;
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsSize = glm::vec3(0.0f);
+	QuantizationError error;
+
+	// Sets the dequantization uniforms (positionOffset, positionScale) on the active shader
+	void SetUniforms(Shader& shader) const;
+};
+
+// Octahedral mapping of a unit vector onto [-1, 1]^2 and back
+glm::vec2 OctahedralEncode(const glm::vec3& normal);
+glm::vec3 OctahedralDecode(const glm::vec2& encoded);
+
+// Octahedral normal rounded to snorm8 / snorm16, picking whichever neighbouring code decodes closest
+Snorm8x2 OctahedralSnorm8(const glm::vec3& normal);
+Snorm16x2 OctahedralSnorm16(const glm::vec3& normal);
+
+// Quantizes a mesh and measures the error it introduced
+QuantizedMesh QuantizeMesh(const MeshVertex* vertices, size_t count);
+QuantizedMesh QuantizeMesh(const std::vector<MeshVertex>& vertices);
+
+// Decodes a quantized vertex the way the vertex shader does
+MeshVertex DequantizeVertex(const QuantizedVertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsSize);
+
+// Prints one line per metric
+void PrintQuantizationReport(std::ostream& out, const char* name, const QuantizedMesh& mesh, size_t sourceVertexBytes = sizeof(MeshVertex));
+
+#endif
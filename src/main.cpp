@@ -1,4 +1,9 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <stb/stb_image.h>
@@ -7,74 +12,104 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "ShaderClass.h"
-#include "VAO.h"
-#include "VBO.h"
-#include "EBO.h"
+#include "GeometryPool.h"
 #include "TextureClass.h"
+#include "TextureLoader.h"
 #include "CameraClass.h"
+#include "HeadlessContext.h"
+#include "FrameTimer.h"
+#include "Profiler.h"
+#include "ProgramCache.h"
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "InstanceBuffer.h"
+#include "StreamBuffer.h"
+#include "CookedMesh.h"
+#include "MeshData.h"
+#include "ThreadPool.h"
+#include "VBO.h"
+#include "EBO.h"
+#include "FrustumCulling.h"
+#include "BVH.h"
+#include "OcclusionCulling.h"
+#include "SceneGraph.h"
 
-int main()
+int main(int argc, char **argv)
 {
+	// Command line options
+	// --headless     render into an offscreen FBO (surfaceless EGL) instead of a window
+	// --frames N     number of frames to render in headless mode
+	// --width W, --height H   framebuffer size
+	// --trace FILE   record CPU/GPU profiler zones and write them as a Chrome trace
+	// --validate-gl-state   check the GL state cache against glGet* on every elided call
+	// --instances N  also draw a grid of N pyramids with a single instanced draw
+	// --mesh FILE    also draw a mesh imported from an .obj, .glb or cooked .cmesh file
+	// --no-dsa       create and edit GL objects by binding them even on GL 4.5 contexts
+	// --occlusion    also hide grid instances behind the pyramid and the mesh with CPU occlusion culling
+	bool headless = false;
+	const char *meshFile = nullptr;
+	int instanceCount = 0;
+	bool validateGLState = false;
+	bool directStateAccess = true;
+	bool occlusionCulling = false;
+	const char *traceFile = nullptr;
+	int frameCount = 600;
+	int width = 800;
+	int height = 800;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frameCount = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+			width = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+			height = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			traceFile = argv[++i];
+		else if (std::strcmp(argv[i], "--validate-gl-state") == 0)
+			validateGLState = true;
+		else if (std::strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+			instanceCount = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+			meshFile = argv[++i];
+		else if (std::strcmp(argv[i], "--no-dsa") == 0)
+			directStateAccess = false;
+		else if (std::strcmp(argv[i], "--occlusion") == 0)
+			occlusionCulling = true;
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--headless] [--frames N] [--width W] [--height H] [--trace FILE] [--validate-gl-state] [--instances N] [--mesh FILE] [--no-dsa] [--occlusion]" << std::endl;
+			return -1;
+		}
+	}
 
-	// Initialize GLFW
-	glfwInit();
+	// Initialize GLFW (the headless context takes care of its own setup)
+	if (!headless)
+	{
+		glfwInit();
 
-	// Set GLFW window hints (OpenGL version, profile, etc...)
+		// Set GLFW window hints (OpenGL version, profile, etc...)
 
-	// This tells OpenGL we want to use OpenGL 3.3
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		// This tells OpenGL we want to use OpenGL 3.3
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
-	// This tells OpenGL we want to use the core profile (modern functions only)
-	// Compatibility profile would give us access to deprecated functions, as well as modern ones
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		// This tells OpenGL we want to use the core profile (modern functions only)
+		// Compatibility profile would give us access to deprecated functions, as well as modern ones
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	}
 
 	// Vertices coordinates
-	// Format: x, y, z, r, g, b, u, v
-	// Layout: 3 position floats, 3 color floats, 2 UV floats (Texture Coordinates) (total 8 floats per vertex)
-	GLfloat vertices[] = {
-		-0.5f,
-		0.0f,
-		0.5f,
-		0.83f,
-		0.70f,
-		0.44f,
-		0.0f,
-		0.0f,
-		-0.5f,
-		0.0f,
-		-0.5f,
-		0.83f,
-		0.70f,
-		0.44f,
-		5.0f,
-		0.0f,
-
-		0.5f,
-		0.0f,
-		-0.5f,
-		0.83f,
-		0.70f,
-		0.44f,
-		0.0f,
-		0.0f,
-		0.5f,
-		0.0f,
-		0.5f,
-		0.83f,
-		0.70f,
-		0.44f,
-		5.0f,
-		0.0f,
-
-		0.0f,
-		0.8f,
-		0.0f,
-		0.92f,
-		0.86f,
-		0.76f,
-		2.5f,
-		5.0f,
+	// Each vertex is a position, a color and a UV (Texture Coordinates); the struct declares its own
+	// attribute layout (see VertexLayout.h), so strides and offsets are worked out at compile time
+	PositionColorUVVertex vertices[] = {
+		{glm::vec3(-0.5f, 0.0f, 0.5f), glm::vec3(0.83f, 0.70f, 0.44f), glm::vec2(0.0f, 0.0f)},
+		{glm::vec3(-0.5f, 0.0f, -0.5f), glm::vec3(0.83f, 0.70f, 0.44f), glm::vec2(5.0f, 0.0f)},
+		{glm::vec3(0.5f, 0.0f, -0.5f), glm::vec3(0.83f, 0.70f, 0.44f), glm::vec2(0.0f, 0.0f)},
+		{glm::vec3(0.5f, 0.0f, 0.5f), glm::vec3(0.83f, 0.70f, 0.44f), glm::vec2(5.0f, 0.0f)},
+		{glm::vec3(0.0f, 0.8f, 0.0f), glm::vec3(0.92f, 0.86f, 0.76f), glm::vec2(2.5f, 5.0f)},
 	};
 
 	// Indices for vertices order
@@ -87,110 +122,401 @@ int main()
 		2, 3, 4,
 		3, 0, 4};
 
-	// Create a windowed mode window (Res, Title, Monitor <if we want fullscreen or smt>, Share <idk what that is yet>)
-	GLFWwindow *window = glfwCreateWindow(800, 800, "OpenGL Window", NULL, NULL);
+	// A wall standing in the middle of the instanced grid, drawn with --occlusion to hide the
+	// instances behind it
+	PositionColorUVVertex wallVertices[8];
+	for (int corner = 0; corner < 8; corner++)
+		wallVertices[corner] = {glm::vec3(corner & 1 ? 1.5f : -1.5f, corner & 2 ? 0.5f : -1.0f, corner & 4 ? -6.0f : -6.4f),
+								glm::vec3(0.55f, 0.55f, 0.6f), glm::vec2(corner & 1 ? 4.0f : 0.0f, corner & 2 ? 1.0f : 0.0f)};
+	GLuint wallIndices[] = {
+		0, 1, 3, 0, 3, 2,
+		4, 5, 7, 4, 7, 6,
+		0, 1, 5, 0, 5, 4,
+		2, 3, 7, 2, 7, 6,
+		0, 2, 6, 0, 6, 4,
+		1, 3, 7, 1, 7, 5};
+
+	GLFWwindow *window = nullptr;
+	HeadlessContext headlessContext;
+	int fbWidth, fbHeight;
 
-	// Check if the window was created successfully, if not, terminate GLFW
-	if (window == nullptr)
+	if (headless)
 	{
-		std::cerr << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
+		// Create an offscreen context rendering into a width x height FBO
+		if (!headlessContext.Create(width, height))
+			return -1;
+		fbWidth = width;
+		fbHeight = height;
+	}
+	else
+	{
+		// Create a windowed mode window (Res, Title, Monitor <if we want fullscreen or smt>, Share <idk what that is yet>)
+		window = glfwCreateWindow(width, height, "OpenGL Window", NULL, NULL);
+
+		// Check if the window was created successfully, if not, terminate GLFW
+		if (window == nullptr)
+		{
+			std::cerr << "Failed to create GLFW window" << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+
+		// Make the window's context current (since we can have multiple windows and glfw is a bit stupid)
+		glfwMakeContextCurrent(window);
+
+		// Load OpenGL function pointers using GLAD
+		gladLoadGL();
+		GLState::Get().Reset();
+
+		// Set the viewport size (the part of the window OpenGL will render to)
+		glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+		glViewport(0, 0, fbWidth, fbHeight); // Set viewport to match the framebuffer size (handles high-DPI displays)
 	}
 
-	// Make the window's context current (since we can have multiple windows and glfw is a bit stupid)
-	glfwMakeContextCurrent(window);
+	// Debug mode: compare every cached binding with what the driver reports
+	GLState::Get().SetValidation(validateGLState);
 
-	// Load OpenGL function pointers using GLAD
-	gladLoadGL();
+	// Direct state access on GL 4.5 contexts, bind-to-edit otherwise
+	GLState::Get().SetDirectStateAccess(directStateAccess);
+	std::cout << "GL objects: " << (GLState::Get().DirectStateAccess() ? "direct state access" : "bind-to-edit") << std::endl;
 
-	// Set the viewport size (the part of the window OpenGL will render to)
-	int fbWidth, fbHeight;
-	glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
-	glViewport(0, 0, fbWidth, fbHeight); // Set viewport to match the framebuffer size (handles high-DPI displays)
+	// Cache linked program binaries on disk so later launches skip shader compilation
+	ProgramCache::Get().SetDirectory("shader_cache");
 
 	// Creates a Shader object using the default vertex and fragment shaders
 	// The Shader class compiles and links the given shader files and exposes the program ID
 	Shader shaderProgram("shaders/default.vert", "shaders/default.frag");
 
-	// Generates the Vertex Array Object and binds it
-	// VAO encapsulates vertex attribute state (bindings, formats)
-	VAO VAO1;
-	VAO1.Bind();
-
-	// Generates the Vertex Buffer Object and Element Buffer Object and links them to vertices/indices
-	// VBO contains the interleaved vertex attributes; EBO contains triangle indices
-	VBO VBO1(vertices, sizeof(vertices));
-	EBO EBO1(indices, sizeof(indices));
-
-	// Links the VBO attributes to the VAO
-	// Attribute 0: position (3 floats) at offset 0
-	// Attribute 1: color    (3 floats) at offset 3*sizeof(float)
-	// Attribute 2: UV       (2 floats) at offset 6*sizeof(float)
-	VAO1.LinkAttrib(VBO1, 0, 3, GL_FLOAT, 8 * sizeof(float), (void *)0);
-	VAO1.LinkAttrib(VBO1, 1, 3, GL_FLOAT, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-	VAO1.LinkAttrib(VBO1, 2, 2, GL_FLOAT, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-
-	// Unbind all to prevent accidentally modifying them
-	VAO1.Unbind();
-	VBO1.Unbind();
-	EBO1.Unbind();
-
-	// Get the uniform location for the "scale" uniform in the shader program
-	// Uniforms must be set on the active program; location is queried once for efficiency
-	GLuint uniID = glGetUniformLocation(shaderProgram.ID, "scale");
+	// Same as the default shader plus a per-instance model transform and tint
+	Shader instancedShader("shaders/instanced.vert", "shaders/instanced.frag");
+
+	// Geometry pool: every mesh with the position/color/UV layout shares one vertex buffer, one
+	// index buffer and one VAO, and is drawn with its own baseVertex / firstIndex. The meshes are
+	// small, so their indices are stored as 16-bit
+	GeometryPool geometry(VertexFormatOf<PositionColorUVVertex>(), 1 << 16, 1 << 18, GL_UNSIGNED_SHORT);
+	MeshHandle pyramidMesh = geometry.Allocate(vertices, indices);
+	MeshHandle wallMesh = occlusionCulling ? geometry.Allocate(wallVertices, wallIndices) : INVALID_MESH;
+
+	// Lays the instances out on a square grid in front of the camera, each one tinted a little differently
+	std::vector<glm::vec3> instancePositions;
+	std::vector<glm::vec4> instanceTints;
+	int gridSide = (int)std::ceil(std::sqrt((float)instanceCount));
+	for (int i = 0; i < instanceCount; i++)
+	{
+		instancePositions.push_back(glm::vec3((i % gridSide - gridSide * 0.5f) * 1.2f, -1.0f, -(float)(i / gridSide) * 1.2f - 1.0f));
+		instanceTints.push_back(glm::vec4(0.6f + 0.4f * (i % 3) / 2.0f, 0.6f + 0.4f * (i % 5) / 4.0f, 0.6f + 0.4f * (i % 7) / 6.0f, 1.0f));
+	}
+
+	// Bounding spheres for frustum culling: the instances spin about their origin, so each sphere is
+	// centered there and reaches the pyramid's farthest vertex
+	float pyramidRadius = 0.0f;
+	for (const PositionColorUVVertex &vertex : vertices)
+		pyramidRadius = std::max(pyramidRadius, glm::length(vertex.position));
+	CullingBounds instanceBounds;
+	instanceBounds.Resize(instanceCount);
+	for (int i = 0; i < instanceCount; i++)
+		instanceBounds.SetSphere(i, instancePositions[i], pyramidRadius);
+	std::vector<uint32_t> visibleInstances(instanceBounds.PaddedSize());
+
+	// Every instance is a node under the grid's root. Only the instances that will be drawn are spun
+	// each frame, so the scene graph recomputes just their world matrices
+	SceneGraph sceneGraph;
+	SceneNode gridNode = sceneGraph.Create();
+	std::vector<SceneNode> instanceNodes;
+	for (int i = 0; i < instanceCount; i++)
+		instanceNodes.push_back(sceneGraph.Create(gridNode, instancePositions[i]));
+	sceneGraph.Update();
+	size_t updatedNodeTotal = 0;
+
+	// The grid never moves, so its BVH is built once; culling skips whole rows behind the far plane
+	// and outside the view, and left clicks pick instances with rays through it
+	BVH instanceBVH;
+	instanceBVH.Build(instanceBounds);
+	bool pickHeld = false;
+
+	// Software depth buffer the wall, the pyramid and an imported .obj / .glb mesh are drawn into every
+	// frame, so that grid instances hidden behind them are dropped before the draw
+	OcclusionBuffer occlusion;
+	size_t occludedInstanceTotal = 0;
+	double occlusionRasterizeMs = 0.0, occlusionTestMs = 0.0;
+	size_t visibleInstanceTotal = 0, culledFrames = 0;
+
+	// The instances spin, so their transforms are rewritten every frame into a ring of persistently
+	// mapped memory (one section per frame in flight)
+	StreamBuffer instanceStream(GL_ARRAY_BUFFER, (GLsizeiptr)std::max(instanceCount, 1) * sizeof(InstanceData));
+
+	// Unbind to prevent accidentally modifying it
+	geometry.vao.Unbind();
+
+	// Imported mesh: a cooked .cmesh is memory-mapped and its sections uploaded as stored, an .obj or
+	// .glb is parsed on worker threads. Either way it is fitted into a unit box behind the pyramid
+	MeshData importedMesh;
+	CookedMesh cookedMesh;
+	glm::vec3 meshMin(0.0f), meshMax(0.0f);
+	if (meshFile && IsCookedMeshPath(meshFile))
+	{
+		if (cookedMesh.Open(meshFile))
+		{
+			meshMin = glm::make_vec3(cookedMesh.Header().boundsMin);
+			meshMax = glm::make_vec3(cookedMesh.Header().boundsMax);
+			std::cout << "Loaded " << meshFile << ": " << cookedMesh.Header().vertexCount << " vertices, " << cookedMesh.Header().indexCount / 3
+					  << " triangles, " << cookedMesh.MeshletCount() << " meshlets" << std::endl;
+		}
+	}
+	else if (meshFile)
+	{
+		ThreadPool importPool;
+		if (LoadMesh(meshFile, importedMesh, &importPool) && !importedMesh.vertices.empty())
+		{
+			meshMin = meshMax = importedMesh.vertices[0].position;
+			for (const MeshVertex &vertex : importedMesh.vertices)
+			{
+				meshMin = glm::min(meshMin, vertex.position);
+				meshMax = glm::max(meshMax, vertex.position);
+			}
+			std::cout << "Loaded " << meshFile << ": " << importedMesh.vertices.size() << " vertices, " << importedMesh.indices.size() / 3 << " triangles" << std::endl;
+		}
+	}
+	bool cookedMeshLoaded = cookedMesh.VertexBytes() > 0;
+	bool quantizedMesh = (cookedMesh.Header().flags & COOKED_MESH_QUANTIZED) != 0;
+	Shader meshShader(quantizedMesh ? "shaders/quantized.vert" : "shaders/mesh.vert", "shaders/default.frag");
+	VAO meshVAO;
+	meshVAO.Bind();
+	VBO meshVBO = cookedMeshLoaded ? VBO(cookedMesh.Vertices(), cookedMesh.VertexBytes()) : VBO(importedMesh.vertices);
+	EBO meshEBO = cookedMeshLoaded ? EBO(cookedMesh.Indices(), (GLsizei)cookedMesh.Header().indexCount, cookedMesh.Header().indexType) : EBO(importedMesh.indices);
+	meshVAO.LinkFormat(cookedMeshLoaded ? cookedMesh.Format() : VertexFormatOf<MeshVertex>(), meshVBO);
+	meshVAO.Unbind();
+
+	glm::vec3 meshExtent = meshMax - meshMin;
+	float meshScale = 1.0f / std::max(std::max(meshExtent.x, meshExtent.y), std::max(meshExtent.z, 1e-6f));
+	meshShader.Activate();
+	glm::mat4 meshModel = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5f, -1.0f)), glm::vec3(meshScale)) *
+						  glm::translate(glm::mat4(1.0f), -(meshMin + meshMax) * 0.5f);
+	meshShader.SetMat4("model"_uniform, meshModel);
+	if (quantizedMesh)
+	{
+		meshShader.SetVec3("positionOffset"_uniform, glm::make_vec3(cookedMesh.Header().positionOffset));
+		meshShader.SetVec3("positionScale"_uniform, glm::make_vec3(cookedMesh.Header().positionScale));
+	}
+	cookedMesh.Close();
 
 	// Texture
-	Texture temptexture("textures/tao.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
-	temptexture.texUnit(shaderProgram, "tex0", 0);
+	// Decoded on worker threads and streamed in over the first frames; a placeholder is bound until then
+	TextureLoader textureLoader;
+	TextureHandle temptexture = textureLoader.Load("textures/tao.png");
+	temptexture->texture.texUnit(shaderProgram, "tex0", 0);
+	temptexture->texture.texUnit(instancedShader, "tex0", 0);
+	temptexture->texture.texUnit(meshShader, "tex0", 0);
 
 	// Enables the Depth Buffer
-	glEnable(GL_DEPTH_TEST);
+	GLState::Get().Enable(GL_DEPTH_TEST);
 
 	// Creates the camera object
 	Camera camera(fbWidth, fbHeight, glm::vec3(0.0f, 0.0f, 2.0f));
+	const float cameraFOV = 45.0f, cameraNear = 0.1f, cameraFar = 100.0f;
 
-	// Main loop
-	while (!glfwWindowShouldClose(window))
-	{
-		// Specify the color of the background
-		glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
-
-		// Cleans the back buffer and depth
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// Collects and sorts the frame's draws
+	RenderQueue renderQueue;
 
-		// Tell OpenGL which Shader Program we want to use
-		shaderProgram.Activate();
+	// Measures how long each frame takes
+	FrameTimer frameTimer;
 
-		camera.Inputs(window);
+	// Start profiling once the GL context exists so GPU zones can be recorded
+	if (traceFile)
+		Profiler::Get().Enable();
 
-		// Updates and exports the camera matrix to the Vertex Shader
-		camera.Matrix(45.0f, 0.1f, 100.0f, shaderProgram, "cameraMatrix");
+	// Main loop (headless mode runs a fixed number of frames)
+	for (int frame = 0; headless ? frame < frameCount : !glfwWindowShouldClose(window); frame++)
+	{
+		frameTimer.Begin();
+		Profiler::Get().BeginFrame();
 
-		// Bind the texture so that OpenGL knows to use it
-		temptexture.Bind();
+		// Streams pending texture uploads (within a per-frame budget)
+		textureLoader.Update();
 
-		// Bind the VAO so that OpenGL knows to use it
-		VAO1.Bind();
+		// Specify the color of the background
+		glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
 
-		// Draw the triangle using the GL_TRIANGLES primitive
-		// Using glDrawElements leverages the EBO to reuse vertices
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / sizeof(int), GL_UNSIGNED_INT, 0);
-		glfwSwapBuffers(window);
+		// Cleans the back buffer and depth
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		// Poll for and process events (if this is not here, the window will freeze and windows will say that its not responding)
-		glfwPollEvents();
+		if (!headless)
+		{
+			camera.Inputs(window);
+
+			// Picks the instance under the cursor on a left click
+			bool pickPressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+			if (pickPressed && !pickHeld)
+			{
+				double cursorX, cursorY;
+				glfwGetCursorPos(window, &cursorX, &cursorY);
+				RayHit hit;
+				glm::vec3 direction = camera.CursorRay(cursorX, cursorY, cameraFOV, cameraNear, cameraFar);
+				if (instanceBVH.Raycast(camera.Position, direction, instanceBounds, cameraFar, hit))
+					std::cout << "Picked instance " << hit.index << " at distance " << hit.distance << std::endl;
+			}
+			pickHeld = pickPressed;
+		}
+
+		// Where the pyramid currently lives in the pool (it may move when the pool grows or compacts)
+		const MeshRange &pyramidRange = geometry.Get(pyramidMesh);
+
+		// Queue the pyramid; the render queue sorts draws by program/texture/VAO so each
+		// piece of state is only bound when it actually changes
+		DrawCommand pyramid = {&shaderProgram, &temptexture->texture, &geometry.vao, pyramidRange.indexCount, geometry.IndexType(),
+							   geometry.IndexOffset(pyramidMesh), 1, pyramidRange.baseVertex};
+		renderQueue.Submit(pyramid);
+
+		if (wallMesh != INVALID_MESH)
+		{
+			const MeshRange &wallRange = geometry.Get(wallMesh);
+			DrawCommand wall = {&shaderProgram, &temptexture->texture, &geometry.vao, wallRange.indexCount, geometry.IndexType(),
+								geometry.IndexOffset(wallMesh), 1, wallRange.baseVertex};
+			renderQueue.Submit(wall);
+		}
+
+		if (meshEBO.count > 0)
+		{
+			DrawCommand imported = {&meshShader, &temptexture->texture, &meshVAO, meshEBO.count, meshEBO.type, 0};
+			renderQueue.Submit(imported);
+		}
+
+		// The whole grid is one draw of the instances that survive frustum culling; their transforms are
+		// written straight into the stream buffer and the pool's VAO reads them as instance attributes
+		// 3-6 (see instanced.vert)
+		size_t visibleCount = 0;
+		if (instanceCount > 0)
+		{
+			Frustum frustum = Frustum::FromMatrix(camera.ViewProjection(cameraFOV, cameraNear, cameraFar));
+			visibleCount = instanceBVH.Cull(frustum, instanceBounds, visibleInstances.data());
+			visibleInstanceTotal += visibleCount;
+			culledFrames++;
+			if (occlusionCulling)
+			{
+				occlusion.Begin(camera.ViewProjection(cameraFOV, cameraNear, cameraFar));
+				occlusion.AddOccluder(&wallVertices[0].position.x, 8, sizeof(PositionColorUVVertex), wallIndices, sizeof(wallIndices) / sizeof(wallIndices[0]));
+				occlusion.AddOccluder(&vertices[0].position.x, sizeof(vertices) / sizeof(vertices[0]), sizeof(PositionColorUVVertex), indices,
+									  sizeof(indices) / sizeof(indices[0]));
+				if (!importedMesh.vertices.empty())
+					occlusion.AddOccluder(&importedMesh.vertices[0].position.x, importedMesh.vertices.size(), sizeof(MeshVertex), importedMesh.indices.data(),
+										  importedMesh.indices.size(), meshModel);
+				occlusion.Rasterize();
+				visibleCount = occlusion.Cull(instanceBounds, visibleInstances.data(), visibleCount, visibleInstances.data());
+				occludedInstanceTotal += occlusion.stats.culled;
+				occlusionRasterizeMs += occlusion.stats.rasterizeMs;
+				occlusionTestMs += occlusion.stats.testMs;
+			}
+		}
+		for (size_t v = 0; v < visibleCount; v++)
+		{
+			uint32_t i = visibleInstances[v];
+			sceneGraph.SetRotation(instanceNodes[i], glm::angleAxis(i * 0.37f + frame * 0.02f, glm::vec3(0.0f, 1.0f, 0.0f)));
+		}
+		sceneGraph.Update();
+		updatedNodeTotal += sceneGraph.stats.updated;
+		if (visibleCount > 0)
+		{
+			instanceStream.BeginFrame();
+			StreamBuffer::Allocation transforms = instanceStream.Allocate(visibleCount * sizeof(InstanceData), sizeof(InstanceData));
+			if (transforms.data)
+			{
+				InstanceData *instances = (InstanceData *)transforms.data;
+				for (size_t v = 0; v < visibleCount; v++)
+				{
+					uint32_t i = visibleInstances[v];
+					instances[v] = InstanceData::Make(sceneGraph.World(instanceNodes[i]), instanceTints[i]);
+				}
+				geometry.vao.Bind();
+				InstanceBuffer::Link(transforms.buffer, transforms.offset);
+				instanceStream.Flush();
+
+				DrawCommand grid = {&instancedShader, &temptexture->texture, &geometry.vao, pyramidRange.indexCount, geometry.IndexType(),
+									geometry.IndexOffset(pyramidMesh), (GLsizei)visibleCount, pyramidRange.baseVertex};
+				renderQueue.Submit(grid);
+			}
+		}
+
+		{
+			PROFILE_ZONE("Draw");
+			PROFILE_GPU_ZONE("Draw");
+
+			// Draws everything queued, exporting the camera matrix to every program the queue binds
+			// (uniform locations come from the table the Shader reflected after linking)
+			renderQueue.Flush([&](Shader &shader)
+							  { camera.Matrix(cameraFOV, cameraNear, cameraFar, shader, "cameraMatrix"_uniform); });
+		}
+
+		// Fences this frame's section of the instance stream
+		if (visibleCount > 0)
+			instanceStream.EndFrame();
+
+		if (headless)
+		{
+			PROFILE_ZONE("SwapBuffers");
+			headlessContext.SwapBuffers();
+		}
+		else
+		{
+			{
+				PROFILE_ZONE("SwapBuffers");
+				glfwSwapBuffers(window);
+			}
+
+			// Poll for and process events (if this is not here, the window will freeze and windows will say that its not responding)
+			glfwPollEvents();
+		}
+
+		Profiler::Get().EndFrame();
+		frameTimer.End();
 	};
 
+	frameTimer.Report(std::cout, headless ? "Headless frame times" : "Frame times");
+	ProgramCache::Get().Report();
+	if (Shader::fallbackLookups > 0)
+		std::cout << "Uniform lookups that missed the reflection table: " << Shader::fallbackLookups << std::endl;
+	std::cout << "GL state cache: " << GLState::Get().stats.skipped << " redundant calls elided, " << GLState::Get().stats.issued << " issued" << std::endl;
+	if (instanceCount > 0)
+		std::cout << "Instance stream: " << instanceStream.stats.allocations << " allocations, " << instanceStream.stats.bytesAllocated / (1024.0 * 1024.0)
+				  << " MB, " << instanceStream.stats.fenceWaits << " fence waits (" << instanceStream.stats.fenceWaitMs << " ms)" << std::endl;
+	if (culledFrames > 0)
+		std::cout << "Frustum culling: " << visibleInstanceTotal / (double)culledFrames << " of " << instanceCount << " instances visible per frame (BVH of "
+				  << instanceBVH.stats.nodes << " nodes, depth " << instanceBVH.stats.depth << ")" << std::endl;
+	if (culledFrames > 0)
+		std::cout << "Scene graph: " << updatedNodeTotal / (double)culledFrames << " of " << sceneGraph.Size() << " world matrices updated per frame" << std::endl;
+	if (occlusionCulling && culledFrames > 0)
+		std::cout << "Occlusion culling: " << occludedInstanceTotal / (double)culledFrames << " frustum-visible instances hidden per frame, "
+				  << occlusionRasterizeMs / culledFrames << " ms rasterizing, " << occlusionTestMs / culledFrames << " ms testing" << std::endl;
+	if (GLState::Get().stats.mismatches > 0)
+		std::cout << "GL state cache mismatches: " << GLState::Get().stats.mismatches << std::endl;
+
+	if (traceFile)
+	{
+		Profiler::Get().WriteChromeTrace(traceFile);
+		Profiler::Get().Disable();
+	}
+
 	// Clean up and exit
 
-	VAO1.Delete();
-	VBO1.Delete();
-	EBO1.Delete();
-	temptexture.Delete();
+	geometry.Delete();
+	meshVAO.Delete();
+	meshVBO.Delete();
+	meshEBO.Delete();
+	meshShader.Delete();
+	instanceStream.Delete();
+	if (temptexture->IsResident())
+		temptexture->texture.Delete();
+	textureLoader.Delete();
 	shaderProgram.Delete();
+	instancedShader.Delete();
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	if (headless)
+	{
+		headlessContext.Delete();
+	}
+	else
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stb/stb_image.h>
+
+#include "BCnEncoder.h"
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "MipChain.h"
+#include "MeshData.h"
+#include "ThreadPool.h"
+#include "VertexQuantization.h"
+
+// Bump when the encoder output changes so every cooked file is rebuilt
+static const uint32_t TEXTURE_COOKER_VERSION = 1;
+static const uint32_t MESH_COOKER_VERSION = 2;
+
+namespace fs = std::filesystem;
+
+struct TextureCookSettings {
+	std::string format = "auto"; // auto, bc1, bc3 or bc7
+	std::string outputDirectory = "cooked";
+	bool force = false;
+};
+
+// Reads a whole file into memory
+static bool readFile(const fs::path& path, std::vector<unsigned char>& contents) {
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		return false;
+	}
+	contents.resize((size_t)in.tellg());
+	in.seekg(0, std::ios::beg);
+	in.read((char*)contents.data(), contents.size());
+	return (bool)in;
+}
+
+// Moves a freshly written temporary file over the output; on failure (output locked or open, read-only
+// directory) the temporary is deleted and false returned
+static bool replaceFile(const fs::path& temporary, const fs::path& output) {
+	std::error_code error;
+	fs::rename(temporary, output, error);
+	if (error) {
+		std::cerr << "Failed to write " << output << ": " << error.message() << std::endl;
+		fs::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+// Expands directories into the images they contain
+static std::vector<fs::path> collectTextures(const std::vector<std::string>& inputs) {
+	std::vector<fs::path> files;
+	for (const std::string& input : inputs) {
+		if (fs::is_directory(input)) {
+			for (const fs::directory_entry& entry : fs::directory_iterator(input)) {
+				std::string extension = entry.path().extension().string();
+				if (extension == ".png" || extension == ".jpg" || extension == ".jpeg") {
+					files.push_back(entry.path());
+				}
+			}
+		}
+		else {
+			files.push_back(input);
+		}
+	}
+	return files;
+}
+
+// Cooked name of an image: the source file name plus .ctex, so a.png and a.jpg don't overwrite each other
+static fs::path cookedTexturePath(const fs::path& source, const TextureCookSettings& settings) {
+	return fs::path(settings.outputDirectory) / (source.filename().string() + ".ctex");
+}
+
+// Cooks one image into a .ctex; returns false on error
+static bool cookTexture(const fs::path& source, const TextureCookSettings& settings, ThreadPool& pool) {
+	fs::path output = cookedTexturePath(source, settings);
+
+	std::vector<unsigned char> contents;
+	if (!readFile(source, contents)) {
+		std::cerr << "Failed to read " << source << std::endl;
+		return false;
+	}
+
+	// The key covers the source bytes and everything that changes the output
+	uint64_t hash = fnv1a64(contents.data(), contents.size());
+	hash = fnv1a64(settings.format.data(), settings.format.size(), hash);
+	hash = fnv1a64(&TEXTURE_COOKER_VERSION, sizeof(TEXTURE_COOKER_VERSION), hash);
+
+	CookedTextureHeader existing;
+	if (!settings.force && ReadCookedTextureHeader(output.string().c_str(), existing) && existing.sourceHash == hash) {
+		std::cout << "  up to date  " << output.string() << std::endl;
+		return true;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// Flip like Texture does so cooked and uncooked textures share UVs
+	int width, height, channels;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* rgba = stbi_load_from_memory(contents.data(), (int)contents.size(), &width, &height, &channels, STBI_rgb_alpha);
+	if (!rgba) {
+		std::cerr << "Failed to decode " << source << std::endl;
+		return false;
+	}
+	MipChain chain = BuildMipChain(rgba, width, height);
+	stbi_image_free(rgba);
+
+	// Opaque images only need BC1 in auto mode
+	BCFormat format = BCFormat::BC3;
+	if (settings.format == "bc1") {
+		format = BCFormat::BC1;
+	}
+	else if (settings.format == "bc7") {
+		format = BCFormat::BC7;
+	}
+	else if (settings.format == "auto") {
+		bool opaque = true;
+		for (size_t i = 3; i < (size_t)width * height * 4 && opaque; i += 4) {
+			opaque = chain.pixels[i] == 255;
+		}
+		format = opaque ? BCFormat::BC1 : BCFormat::BC3;
+	}
+
+	GLenum glFormat = format == BCFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+		: format == BCFormat::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+		: GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+	std::vector<CookedTextureLevel> levels;
+	std::vector<std::vector<unsigned char>> levelData;
+	size_t compressedBytes = 0;
+	for (const MipChain::Level& level : chain.levels) {
+		levelData.emplace_back(BCImageBytes(format, level.width, level.height));
+		EncodeBCImage(format, chain.pixels.data() + level.offset, level.width, level.height, levelData.back().data(), &pool);
+		levels.push_back({ (uint32_t)level.width, (uint32_t)level.height, 0, 0 });
+		compressedBytes += levelData.back().size();
+	}
+
+	// Write next to the final name and rename, so an interrupted cook never leaves a valid-looking file
+	fs::path temporary = output;
+	temporary += ".tmp";
+	if (!WriteCookedTexture(temporary.string().c_str(), glFormat, hash, levels, levelData) || !replaceFile(temporary, output)) {
+		return false;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const char* formatName = format == BCFormat::BC1 ? "BC1" : format == BCFormat::BC3 ? "BC3" : "BC7";
+	std::cout << "  cooked      " << output.string() << "  " << width << "x" << height << " " << formatName
+		<< ", " << levels.size() << " levels, " << compressedBytes / 1024 << " KiB ("
+		<< (double)chain.pixels.size() / compressedBytes << ":1 vs RGBA8), " << seconds * 1000.0 << " ms" << std::endl;
+	return true;
+}
+
+static int cookTextures(int argc, char **argv) {
+	TextureCookSettings settings;
+	std::vector<std::string> inputs;
+	unsigned int threads = 0;
+	for (int i = 0; i < argc; i++) {
+		if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			settings.format = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			settings.outputDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--force") == 0) {
+			settings.force = true;
+		}
+		else {
+			inputs.push_back(argv[i]);
+		}
+	}
+
+	if (settings.format != "auto" && settings.format != "bc1" && settings.format != "bc3" && settings.format != "bc7") {
+		std::cerr << "Unknown texture format: " << settings.format << std::endl;
+		return -1;
+	}
+	if (inputs.empty()) {
+		inputs.push_back("textures");
+	}
+
+	std::error_code error;
+	fs::create_directories(settings.outputDirectory, error);
+
+	ThreadPool pool(threads);
+	int failures = 0;
+	// Images with the same file name in different directories would cook to the same output
+	std::map<fs::path, fs::path> claimed;
+	for (const fs::path& source : collectTextures(inputs)) {
+		fs::path output = cookedTexturePath(source, settings);
+		auto found = claimed.find(output);
+		if (found != claimed.end()) {
+			std::cerr << "Skipping " << source << ": " << found->second << " already cooks to " << output << std::endl;
+			failures++;
+			continue;
+		}
+		claimed[output] = source;
+		failures += !cookTexture(source, settings, pool);
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+struct MeshCookSettings {
+	std::string outputDirectory = "cooked";
+	float overdrawThreshold = 1.05f;
+	bool quantize = false;
+	bool force = false;
+};
+
+// Cooked name of a mesh: the source file name plus .cmesh, so a.obj and a.glb don't overwrite each other
+static fs::path cookedMeshPath(const fs::path& source, const MeshCookSettings& settings) {
+	return fs::path(settings.outputDirectory) / (source.filename().string() + ".cmesh");
+}
+
+// Optimizes one mesh (see MeshOptimizer.h), splits it into meshlets and writes it as a .cmesh
+static bool cookMesh(const fs::path& source, const MeshCookSettings& settings, ThreadPool& pool) {
+	fs::path output = cookedMeshPath(source, settings);
+
+	std::vector<unsigned char> contents;
+	if (!readFile(source, contents)) {
+		std::cerr << "Failed to read " << source << std::endl;
+		return false;
+	}
+
+	// The key covers the source bytes and everything that changes the output
+	uint64_t hash = fnv1a64(contents.data(), contents.size());
+	hash = fnv1a64(&settings.overdrawThreshold, sizeof(settings.overdrawThreshold), hash);
+	hash = fnv1a64(&settings.quantize, sizeof(settings.quantize), hash);
+	hash = fnv1a64(&MESH_COOKER_VERSION, sizeof(MESH_COOKER_VERSION), hash);
+	contents.clear();
+	contents.shrink_to_fit();
+
+	CookedMeshHeader existing;
+	if (!settings.force && ReadCookedMeshHeader(output.string().c_str(), existing) && existing.sourceHash == hash) {
+		std::cout << "  up to date  " << output.string() << std::endl;
+		return true;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	MeshData mesh;
+	if (!LoadMesh(source.string().c_str(), mesh, &pool)) {
+		return false;
+	}
+	if (mesh.indices.empty()) {
+		std::cerr << "No triangles in " << source << std::endl;
+		return false;
+	}
+	MeshOptimizationReport report = OptimizeMesh(mesh, settings.overdrawThreshold);
+	MeshletData meshlets = BuildMeshlets(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position.x, mesh.vertices.size(), sizeof(MeshVertex));
+
+	CookedMeshContents cooked;
+	cooked.vertexCount = (uint32_t)mesh.vertices.size();
+	cooked.indices = mesh.indices.data();
+	cooked.indexCount = (uint32_t)mesh.indices.size();
+	cooked.meshlets = &meshlets;
+	cooked.sourceHash = hash;
+	cooked.boundsMin = cooked.boundsMax = mesh.vertices[0].position;
+	for (const MeshVertex& vertex : mesh.vertices) {
+		cooked.boundsMin = glm::min(cooked.boundsMin, vertex.position);
+		cooked.boundsMax = glm::max(cooked.boundsMax, vertex.position);
+	}
+	QuantizedMesh quantized;
+	if (settings.quantize) {
+		quantized = QuantizeMesh(mesh.vertices);
+		cooked.vertices = quantized.vertices.data();
+		cooked.format = VertexFormatOf<QuantizedVertex>();
+		cooked.flags = COOKED_MESH_QUANTIZED;
+		cooked.positionOffset = quantized.boundsMin;
+		cooked.positionScale = quantized.boundsSize;
+	}
+	else {
+		cooked.vertices = mesh.vertices.data();
+		cooked.format = VertexFormatOf<MeshVertex>();
+	}
+
+	// Write next to the final name and rename, so an interrupted cook never leaves a valid-looking file
+	fs::path temporary = output;
+	temporary += ".tmp";
+	if (!WriteCookedMesh(temporary.string().c_str(), cooked) || !replaceFile(temporary, output)) {
+		return false;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::error_code error;
+	std::uintmax_t bytes = fs::file_size(output, error);
+	std::cout << "  cooked      " << output.string() << "  " << (settings.quantize ? "quantized" : "float") << " vertices, "
+		<< meshlets.meshlets.size() << " meshlets, " << (error ? 0 : bytes) / 1024 << " KiB, " << seconds * 1000.0 << " ms" << std::endl;
+	PrintMeshOptimizationReport(std::cout, source.filename().string().c_str(), report);
+	if (settings.quantize) {
+		PrintQuantizationReport(std::cout, source.filename().string().c_str(), quantized);
+	}
+	return true;
+}
+
+static int cookMeshes(int argc, char **argv) {
+	MeshCookSettings settings;
+	std::vector<std::string> inputs;
+	unsigned int threads = 0;
+	for (int i = 0; i < argc; i++) {
+		if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			settings.outputDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--overdraw-threshold") == 0 && i + 1 < argc) {
+			settings.overdrawThreshold = (float)std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--quantize") == 0) {
+			settings.quantize = true;
+		}
+		else if (std::strcmp(argv[i], "--force") == 0) {
+			settings.force = true;
+		}
+		else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (inputs.empty()) {
+		std::cerr << "No meshes given" << std::endl;
+		return -1;
+	}
+
+	std::error_code error;
+	fs::create_directories(settings.outputDirectory, error);
+
+	std::vector<fs::path> sources;
+	for (const std::string& input : inputs) {
+		if (fs::is_directory(input)) {
+			for (const fs::directory_entry& entry : fs::directory_iterator(input)) {
+				if (entry.path().extension() == ".obj" || entry.path().extension() == ".glb") {
+					sources.push_back(entry.path());
+				}
+			}
+		}
+		else {
+			sources.push_back(input);
+		}
+	}
+
+	ThreadPool pool(threads);
+	int failures = 0;
+	// Meshes with the same file name in different directories would cook to the same output
+	std::map<fs::path, fs::path> claimed;
+	for (const fs::path& source : sources) {
+		fs::path output = cookedMeshPath(source, settings);
+		auto found = claimed.find(output);
+		if (found != claimed.end()) {
+			std::cerr << "Skipping " << source << ": " << found->second << " already cooks to " << output << std::endl;
+			failures++;
+			continue;
+		}
+		claimed[output] = source;
+		failures += !cookMesh(source, settings, pool);
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+// Offline asset cooker
+// Usage: AssetCooker texture [--format auto|bc1|bc3|bc7] [--out DIR] [--threads N] [--force] [FILES or DIRS...]
+//        AssetCooker mesh [--out DIR] [--overdraw-threshold X] [--quantize] [--threads N] [--force] FILES or DIRS...
+int main(int argc, char **argv)
+{
+	if (argc >= 2 && std::strcmp(argv[1], "texture") == 0)
+		return cookTextures(argc - 2, argv + 2);
+	if (argc >= 2 && std::strcmp(argv[1], "mesh") == 0)
+		return cookMeshes(argc - 2, argv + 2);
+
+	std::cerr << "Usage: " << argv[0] << " texture [--format auto|bc1|bc3|bc7] [--out DIR] [--threads N] [--force] [FILES or DIRS...]" << std::endl;
+	std::cerr << "       " << argv[0] << " mesh [--out DIR] [--overdraw-threshold X] [--quantize] [--threads N] [--force] FILES or DIRS..." << std::endl;
+	return -1;
+}